@@ -262,7 +262,11 @@ function build(settings)
 	tools = {}
 	for i,v in ipairs(tools_src) do
 		toolname = PathFilename(PathBase(v))
-		tools[i] = Link(settings, toolname, Compile(settings, v), engine, md5, zlib, pnglite)
+		tool_game = {}
+		if toolname == "collision_bench" or toolname == "core_replay" or toolname == "move_bench" or toolname == "spawn_bench" then
+			tool_game = game_shared
+		end
+		tools[i] = Link(settings, toolname, Compile(settings, v), tool_game, engine, md5, zlib, pnglite)
 	end
 
 	-- build client, server, version server and master server
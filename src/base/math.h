@@ -45,6 +45,10 @@ inline int random_int_range(int min, int max) {
 inline int random_int() { return (((rand() & 0xffff) << 16) | (rand() & 0xffff)) & 0x7FFFFFFF; };
 inline float frandom() { return rand()/(float)(RAND_MAX); }
 
+// seeded pseudo random numbers (24 bits), the same seed gives the same sequence everywhere
+inline unsigned random_next(unsigned *pSeed) { *pSeed = *pSeed*1103515245+12345; return *pSeed>>8; }
+inline float random_next_float(unsigned *pSeed) { return (random_next(pSeed)&0xffff)/65535.0f; }
+
 // float to fixed
 inline int f2fx(float v) { return (int)(v*(float)(1<<10)); }
 inline float fx2f(int v) { return v*(1.0f/(1<<10)); }
@@ -26,6 +26,7 @@
 #include <netinet/in.h>
 #include <pthread.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 
 #include <dirent.h>
@@ -51,6 +52,7 @@
 	#include <fcntl.h>
 	#include <direct.h>
 	#include <errno.h>
+	#include <io.h>
 	#include <process.h>
 	#include <shellapi.h>
 	#include <wincrypt.h>
@@ -268,6 +270,30 @@ typedef struct MEMTAIL
 static struct MEMHEADER *first = 0;
 static const int MEM_GUARD_VAL = 0xbaadc0de;
 
+/* the allocation list and stats are shared by all threads, the lock
+	has to work before any thread is created so it's a simple spinlock */
+static volatile long mem_list_lock = 0;
+
+static void mem_lock(void)
+{
+#if defined(_MSC_VER)
+	while(InterlockedExchange(&mem_list_lock, 1))
+		Sleep(0);
+#else
+	while(__sync_lock_test_and_set(&mem_list_lock, 1))
+		sched_yield();
+#endif
+}
+
+static void mem_unlock(void)
+{
+#if defined(_MSC_VER)
+	InterlockedExchange(&mem_list_lock, 0);
+#else
+	__sync_lock_release(&mem_list_lock);
+#endif
+}
+
 void *mem_alloc_debug(const char *filename, int line, unsigned size, unsigned alignment)
 {
 	/* TODO: fix alignment */
@@ -282,17 +308,19 @@ void *mem_alloc_debug(const char *filename, int line, unsigned size, unsigned al
 	header->filename = filename;
 	header->line = line;
 
+	tail->guard = MEM_GUARD_VAL;
+
+	mem_lock();
 	memory_stats.allocated += header->size;
 	memory_stats.total_allocations++;
 	memory_stats.active_allocations++;
 
-	tail->guard = MEM_GUARD_VAL;
-
 	header->prev = (MEMHEADER *)0;
 	header->next = first;
 	if(first)
 		first->prev = header;
 	first = header;
+	mem_unlock();
 
 	/*dbg_msg("mem", "++ %p", header+1); */
 	return header+1;
@@ -308,6 +336,7 @@ void mem_free(void *p)
 		if(tail->guard != MEM_GUARD_VAL)
 			dbg_msg("mem", "!! %p", p);
 		/* dbg_msg("mem", "-- %p", p); */
+		mem_lock();
 		memory_stats.allocated -= header->size;
 		memory_stats.active_allocations--;
 
@@ -317,6 +346,7 @@ void mem_free(void *p)
 			first = header->next;
 		if(header->next)
 			header->next->prev = header->prev;
+		mem_unlock();
 
 		free(header);
 	}
@@ -325,12 +355,14 @@ void mem_free(void *p)
 void mem_debug_dump(IOHANDLE file)
 {
 	char buf[1024];
-	MEMHEADER *header = first;
+	MEMHEADER *header;
 	if(!file)
 		file = io_open("memory.txt", IOFLAG_WRITE);
 
 	if(file)
 	{
+		mem_lock();
+		header = first;
 		while(header)
 		{
 			str_format(buf, sizeof(buf), "%s(%d): %d", header->filename, header->line, header->size);
@@ -338,6 +370,7 @@ void mem_debug_dump(IOHANDLE file)
 			io_write_newline(file);
 			header = header->next;
 		}
+		mem_unlock();
 
 		io_close(file);
 	}
@@ -435,6 +468,46 @@ unsigned io_write_newline(IOHANDLE io)
 #endif
 }
 
+void *io_map(IOHANDLE io, unsigned *size)
+{
+	long int length = io_length(io);
+	void *data;
+
+	*size = 0;
+	if(length <= 0)
+		return 0;
+
+#if defined(CONF_FAMILY_WINDOWS)
+	{
+		HANDLE mapping = CreateFileMapping((HANDLE)_get_osfhandle(_fileno((FILE*)io)), NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if(!mapping)
+			return 0;
+		data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+		if(!data)
+			return 0;
+	}
+#else
+	data = mmap(0, length, PROT_READ|PROT_WRITE, MAP_PRIVATE, fileno((FILE*)io), 0);
+	if(data == MAP_FAILED)
+		return 0;
+#endif
+
+	*size = length;
+	return data;
+}
+
+void io_unmap(void *data, unsigned size)
+{
+	if(!data)
+		return;
+#if defined(CONF_FAMILY_WINDOWS)
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
 int io_close(IOHANDLE io)
 {
 	return fclose((FILE*)io) != 0;
@@ -810,6 +883,20 @@ void thread_wait(void *thread)
 #endif
 }
 
+int thread_num_cpus(void)
+{
+#if defined(CONF_FAMILY_UNIX)
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	return num > 0 ? (int)num : 1;
+#elif defined(CONF_FAMILY_WINDOWS)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+	#error not implemented
+#endif
+}
+
 void thread_yield(void)
 {
 #if defined(CONF_FAMILY_UNIX)
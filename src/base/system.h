@@ -321,6 +321,35 @@ long int io_tell(IOHANDLE io);
 */
 long int io_length(IOHANDLE io);
 
+/*
+	Function: io_map
+		Maps the whole file into memory.
+
+	Parameters:
+		io - Handle to the file.
+		size - Pointer to receive the size of the mapping.
+
+	Returns:
+		Returns a pointer to the data or 0 if the file couldn't be
+		mapped. The mapping stays valid after the file is closed.
+
+	Remarks:
+		The mapping is private, pages that get written to are copied
+		and the changes never reach the file.
+		The data must be released with <io_unmap>.
+*/
+void *io_map(IOHANDLE io, unsigned *size);
+
+/*
+	Function: io_unmap
+		Releases a mapping created by <io_map>.
+
+	Parameters:
+		data - Pointer returned by <io_map>.
+		size - Size of the mapping.
+*/
+void io_unmap(void *data, unsigned size);
+
 /*
 	Function: io_close
 		Closes a file.
@@ -536,6 +565,13 @@ void *thread_init(void (*threadfunc)(void *), void *user);
 */
 void thread_wait(void *thread);
 
+/*
+	Function: thread_num_cpus
+		Returns the number of processors available to the process,
+		at least 1.
+*/
+int thread_num_cpus(void);
+
 /*
 	Function: thread_yield
 		Yield the current threads execution slice.
@@ -0,0 +1,187 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/tl/threading.h>
+
+#include "graphics_threaded.h"
+
+// graphics backend that goes through the command buffers and checks them
+// without drawing anything. runs on the calling thread, so the client can
+// be measured on machines without a gpu
+class CGraphicsBackend_Null : public IGraphicsBackend
+{
+	enum
+	{
+		MAX_REPORTED_ERRORS=32,
+	};
+
+	struct CTexture
+	{
+		bool m_Used;
+		int m_Width;
+		int m_Height;
+		int m_MemSize;
+	};
+	CTexture m_aTextures[CCommandBuffer::MAX_TEXTURES];
+	int m_TextureMemoryUsage;
+
+	int m_NumFrames;
+	int m_NumCommands;
+	int m_NumPrimitives;
+	int m_NumErrors;
+
+	void Error(const CCommandBuffer::SCommand *pCommand, const char *pReason)
+	{
+		if(m_NumErrors++ < MAX_REPORTED_ERRORS)
+			dbg_msg("gfx", "invalid command %d: %s", pCommand->m_Cmd, pReason);
+	}
+
+	bool ValidTexture(int Slot, bool Used) const
+	{
+		return Slot >= 0 && Slot < CCommandBuffer::MAX_TEXTURES && m_aTextures[Slot].m_Used == Used;
+	}
+
+	void Cmd_Texture_Create(const CCommandBuffer::SCommand_Texture_Create *pCommand)
+	{
+		if(!ValidTexture(pCommand->m_Slot, false))
+			Error(pCommand, "texture slot in use");
+		else if(pCommand->m_Width <= 0 || pCommand->m_Height <= 0 || !pCommand->m_pData)
+			Error(pCommand, "texture without data");
+		else
+		{
+			CTexture *pTexture = &m_aTextures[pCommand->m_Slot];
+			pTexture->m_Used = true;
+			pTexture->m_Width = pCommand->m_Width;
+			pTexture->m_Height = pCommand->m_Height;
+			pTexture->m_MemSize = pCommand->m_Width*pCommand->m_Height*pCommand->m_PixelSize;
+			m_TextureMemoryUsage += pTexture->m_MemSize;
+		}
+		mem_free(pCommand->m_pData);
+	}
+
+	void Cmd_Texture_Update(const CCommandBuffer::SCommand_Texture_Update *pCommand)
+	{
+		if(!ValidTexture(pCommand->m_Slot, true))
+			Error(pCommand, "update of an unknown texture");
+		else
+		{
+			const CTexture *pTexture = &m_aTextures[pCommand->m_Slot];
+			if(pCommand->m_X < 0 || pCommand->m_Y < 0 || pCommand->m_X+pCommand->m_Width > pTexture->m_Width ||
+				pCommand->m_Y+pCommand->m_Height > pTexture->m_Height)
+				Error(pCommand, "texture update out of bounds");
+		}
+		mem_free(pCommand->m_pData);
+	}
+
+	void Cmd_Texture_Destroy(const CCommandBuffer::SCommand_Texture_Destroy *pCommand)
+	{
+		if(!ValidTexture(pCommand->m_Slot, true))
+		{
+			Error(pCommand, "destroy of an unknown texture");
+			return;
+		}
+		m_TextureMemoryUsage -= m_aTextures[pCommand->m_Slot].m_MemSize;
+		mem_zero(&m_aTextures[pCommand->m_Slot], sizeof(CTexture));
+	}
+
+	void Cmd_Render(CCommandBuffer *pBuffer, const CCommandBuffer::SCommand_Render *pCommand)
+	{
+		int NumVertices = 0;
+		if(pCommand->m_PrimType == CCommandBuffer::PRIMTYPE_QUADS)
+			NumVertices = pCommand->m_PrimCount*4;
+		else if(pCommand->m_PrimType == CCommandBuffer::PRIMTYPE_LINES)
+			NumVertices = pCommand->m_PrimCount*2;
+		else
+		{
+			Error(pCommand, "unknown primitive type");
+			return;
+		}
+
+		// the vertices have to be in the data of the same buffer
+		const unsigned char *pVertices = (const unsigned char *)pCommand->m_pVertices;
+		const unsigned char *pData = pBuffer->m_DataBuffer.DataPtr();
+		if(NumVertices == 0 || pVertices < pData || pVertices+NumVertices*sizeof(CCommandBuffer::SVertex) > pData+pBuffer->m_DataBuffer.DataUsed())
+			Error(pCommand, "vertices outside of the command buffer");
+		else if(pCommand->m_State.m_Texture != -1 && !ValidTexture(pCommand->m_State.m_Texture, true))
+			Error(pCommand, "render with an unknown texture");
+		else if(pCommand->m_State.m_BlendMode < CCommandBuffer::BLEND_NONE || pCommand->m_State.m_BlendMode > CCommandBuffer::BLEND_ADDITIVE ||
+			pCommand->m_State.m_WrapMode < CCommandBuffer::WRAP_REPEAT || pCommand->m_State.m_WrapMode > CCommandBuffer::WRAP_CLAMP)
+			Error(pCommand, "invalid render state");
+		else
+			m_NumPrimitives += pCommand->m_PrimCount;
+	}
+
+public:
+	CGraphicsBackend_Null()
+	{
+		mem_zero(m_aTextures, sizeof(m_aTextures));
+		m_TextureMemoryUsage = 0;
+		m_NumFrames = 0;
+		m_NumCommands = 0;
+		m_NumPrimitives = 0;
+		m_NumErrors = 0;
+	}
+
+	virtual int Init(const char *pName, int *pWidth, int *pHeight, int FsaaSamples, int Flags)
+	{
+		// there is no screen to take the resolution from
+		if(*pWidth == 0 || *pHeight == 0)
+		{
+			*pWidth = 1280;
+			*pHeight = 720;
+		}
+		dbg_msg("gfx", "using the null backend, %dx%d", *pWidth, *pHeight);
+		return 0;
+	}
+
+	virtual int Shutdown()
+	{
+		dbg_msg("gfx", "null backend: %d frames, %d commands, %d primitives, %d invalid commands",
+			m_NumFrames, m_NumCommands, m_NumPrimitives, m_NumErrors);
+		return 0;
+	}
+
+	virtual int MemoryUsage() const { return m_TextureMemoryUsage; }
+
+	virtual void Minimize() {}
+	virtual void Maximize() {}
+	virtual int WindowActive() { return 1; }
+	virtual int WindowOpen() { return 1; }
+
+	virtual void RunBuffer(CCommandBuffer *pBuffer)
+	{
+		unsigned CmdIndex = 0;
+		while(1)
+		{
+			const CCommandBuffer::SCommand *pBaseCommand = pBuffer->GetCommand(&CmdIndex);
+			if(pBaseCommand == 0x0)
+				break;
+
+			m_NumCommands++;
+			if(pBaseCommand->m_Size == 0)
+			{
+				Error(pBaseCommand, "command without size");
+				break;
+			}
+
+			switch(pBaseCommand->m_Cmd)
+			{
+			case CCommandBuffer::CMD_NOP: break;
+			case CCommandBuffer::CMD_SIGNAL: static_cast<const CCommandBuffer::SCommand_Signal *>(pBaseCommand)->m_pSemaphore->signal(); break;
+			case CCommandBuffer::CMD_TEXTURE_CREATE: Cmd_Texture_Create(static_cast<const CCommandBuffer::SCommand_Texture_Create *>(pBaseCommand)); break;
+			case CCommandBuffer::CMD_TEXTURE_DESTROY: Cmd_Texture_Destroy(static_cast<const CCommandBuffer::SCommand_Texture_Destroy *>(pBaseCommand)); break;
+			case CCommandBuffer::CMD_TEXTURE_UPDATE: Cmd_Texture_Update(static_cast<const CCommandBuffer::SCommand_Texture_Update *>(pBaseCommand)); break;
+			case CCommandBuffer::CMD_CLEAR: break;
+			case CCommandBuffer::CMD_RENDER: Cmd_Render(pBuffer, static_cast<const CCommandBuffer::SCommand_Render *>(pBaseCommand)); break;
+			case CCommandBuffer::CMD_SWAP: m_NumFrames++; break;
+			case CCommandBuffer::CMD_SCREENSHOT: break; // leaves the image empty, nothing gets saved
+			case CCommandBuffer::CMD_VIDEOMODES: *static_cast<const CCommandBuffer::SCommand_VideoModes *>(pBaseCommand)->m_pNumModes = 0; break;
+			default: Error(pBaseCommand, "unknown command");
+			}
+		}
+	}
+
+	virtual bool IsIdle() const { return true; }
+	virtual void WaitForIdle() {}
+};
+
+IGraphicsBackend *CreateGraphicsBackendNull() { return new CGraphicsBackend_Null; }
@@ -28,6 +28,7 @@
 #include <engine/shared/datafile.h>
 #include <engine/shared/demo.h>
 #include <engine/shared/filecollection.h>
+#include <engine/shared/frameprofile.h>
 #include <engine/shared/mapchecker.h>
 #include <engine/shared/network.h>
 #include <engine/shared/packer.h>
@@ -263,6 +264,7 @@ CClient::CClient() : m_DemoPlayer(&m_SnapshotDelta), m_DemoRecorder(&m_SnapshotD
 	m_SnapCrcErrors = 0;
 	m_AutoScreenshotRecycle = false;
 	m_EditorActive = false;
+	m_Benchmark = false;
 
 	m_AckGameTick = -1;
 	m_CurrentRecvTick = 0;
@@ -668,6 +670,7 @@ void CClient::SnapSetStaticsize(int ItemType, int Size)
 void CClient::DebugRender()
 {
 	static NETSTATS Prev, Current;
+	static CTextLayoutStats PrevText, CurrentText;
 	static int64 LastSnap = 0;
 	static float FrameTimeAvg = 0;
 	int64 Now = time_get();
@@ -686,6 +689,8 @@ void CClient::DebugRender()
 		LastSnap = time_get();
 		Prev = Current;
 		net_stats(&Current);
+		PrevText = CurrentText;
+		Kernel()->RequestInterface<IEngineTextRender>()->GetLayoutStats(&CurrentText);
 	}
 
 	/*
@@ -739,6 +744,14 @@ void CClient::DebugRender()
 	str_format(aBuffer, sizeof(aBuffer), "pred: %d ms",
 		(int)((m_PredictedTime.Get(Now)-m_GameTime.Get(Now))*1000/(float)time_freq()));
 	Graphics()->QuadsText(2, 70, 16, aBuffer);
+
+	{
+		int Hits = CurrentText.m_Hits-PrevText.m_Hits;
+		int Lookups = max(Hits+CurrentText.m_Misses-PrevText.m_Misses, 1);
+		str_format(aBuffer, sizeof(aBuffer), "text layouts: %d/s hit %d%% saved %.2f ms/s",
+			Lookups, Hits*100/Lookups, (CurrentText.m_SavedTime-PrevText.m_SavedTime)*1000.0f/time_freq());
+		Graphics()->QuadsText(2, 84, 16, aBuffer);
+	}
 	Graphics()->QuadsEnd();
 
 	// render graphs
@@ -773,7 +786,10 @@ void CClient::Render()
 	if(g_Config.m_GfxClear)
 		Graphics()->Clear(1,1,0);
 
-	GameClient()->OnRender();
+	{
+		CFrameProfileScope ProfileScope(CFrameProfile::PART_COMPONENTS);
+		GameClient()->OnRender();
+	}
 	DebugRender();
 }
 
@@ -1523,9 +1539,11 @@ void DemoPlayer()->SetPause(int paused)
 
 void CClient::Update()
 {
+	CFrameProfileScope ProfileScope(CFrameProfile::PART_UPDATE);
+
 	if(State() == IClient::STATE_DEMOPLAYBACK)
 	{
-		m_DemoPlayer.Update();
+		m_DemoPlayer.Update(m_Benchmark ? m_BenchmarkStep : 0);
 		if(m_DemoPlayer.IsPlaying())
 		{
 			// update timers
@@ -1735,7 +1753,7 @@ void CClient::Run()
 
 	// init graphics
 	{
-		if(g_Config.m_GfxThreaded)
+		if(g_Config.m_GfxThreaded || g_Config.m_GfxNull)
 			m_pGraphics = CreateEngineGraphicsThreaded();
 		else
 			m_pGraphics = CreateEngineGraphics();
@@ -1907,6 +1925,9 @@ void CClient::Run()
 			else if(m_EditorActive)
 				m_EditorActive = false;
 
+			int64 FrameStart = time_get();
+			CFrameProfile::Reset();
+
 			Update();
 
 			if(!g_Config.m_GfxAsyncRender || m_pGraphics->IsIdle())
@@ -1949,6 +1970,9 @@ void CClient::Run()
 					}
 					m_pGraphics->Swap();
 				}
+
+				if(m_Benchmark)
+					Benchmark_Frame(time_get()-FrameStart);
 			}
 		}
 
@@ -2152,6 +2176,67 @@ void CClient::Con_Play(IConsole::IResult *pResult, void *pUserData)
 	pSelf->DemoPlayer_Play(pResult->GetString(0), IStorage::TYPE_ALL);
 }
 
+void CClient::Con_Benchmark(IConsole::IResult *pResult, void *pUserData)
+{
+	CClient *pSelf = (CClient *)pUserData;
+	int Fps = pResult->NumArguments() > 1 ? clamp(pResult->GetInteger(1), 1, 1000) : 60;
+	const char *pError = pSelf->DemoPlayer_Play(pResult->GetString(0), IStorage::TYPE_ALL);
+	if(pError)
+	{
+		pSelf->m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "benchmark", pError);
+		return;
+	}
+
+	pSelf->m_Benchmark = true;
+	pSelf->m_BenchmarkStep = time_freq()/Fps;
+	pSelf->m_BenchmarkFrames = 0;
+	pSelf->m_BenchmarkFrameTime = 0;
+	pSelf->m_BenchmarkFrameMax = 0;
+	mem_zero(pSelf->m_aBenchmarkTime, sizeof(pSelf->m_aBenchmarkTime));
+	mem_zero(pSelf->m_aBenchmarkMax, sizeof(pSelf->m_aBenchmarkMax));
+	CFrameProfile::ms_Active = true;
+}
+
+void CClient::Benchmark_Frame(int64 FrameTime)
+{
+	m_BenchmarkFrames++;
+	m_BenchmarkFrameTime += FrameTime;
+	m_BenchmarkFrameMax = max(m_BenchmarkFrameMax, FrameTime);
+	for(int i = 0; i < CFrameProfile::NUM_PARTS; i++)
+	{
+		m_aBenchmarkTime[i] += CFrameProfile::ms_aTime[i];
+		m_aBenchmarkMax[i] = max(m_aBenchmarkMax[i], CFrameProfile::ms_aTime[i]);
+	}
+
+	// the demo pauses at its end
+	if(State() != IClient::STATE_DEMOPLAYBACK || m_DemoPlayer.BaseInfo()->m_Paused)
+	{
+		Benchmark_Report();
+		Quit();
+	}
+}
+
+void CClient::Benchmark_Report()
+{
+	m_Benchmark = false;
+	CFrameProfile::ms_Active = false;
+
+	char aBuf[256];
+	int Frames = max(m_BenchmarkFrames, 1);
+	double Scale = 1000.0/time_freq();
+	str_format(aBuf, sizeof(aBuf), "%d frames, %.2f s of demo", m_BenchmarkFrames, m_BenchmarkFrames*(double)m_BenchmarkStep/time_freq());
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "benchmark", aBuf);
+	str_format(aBuf, sizeof(aBuf), "frame: avg %.3f ms, max %.3f ms", m_BenchmarkFrameTime*Scale/Frames, m_BenchmarkFrameMax*Scale);
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "benchmark", aBuf);
+
+	// parts can overlap, text builds command buffers as well
+	for(int i = 0; i < CFrameProfile::NUM_PARTS; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: avg %.3f ms, max %.3f ms", CFrameProfile::PartName(i), m_aBenchmarkTime[i]*Scale/Frames, m_aBenchmarkMax[i]*Scale);
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "benchmark", aBuf);
+	}
+}
+
 void CClient::DemoRecorder_Start(const char *pFilename, bool WithTimestamp)
 {
 	if(State() != IClient::STATE_ONLINE)
@@ -2253,6 +2338,7 @@ void CClient::RegisterCommands()
 	m_pConsole->Register("rcon", "r", CFGFLAG_CLIENT, Con_Rcon, this, "Send specified command to rcon");
 	m_pConsole->Register("rcon_auth", "s", CFGFLAG_CLIENT, Con_RconAuth, this, "Authenticate to rcon");
 	m_pConsole->Register("play", "r", CFGFLAG_CLIENT|CFGFLAG_STORE, Con_Play, this, "Play the file specified");
+	m_pConsole->Register("benchmark", "s?i", CFGFLAG_CLIENT|CFGFLAG_STORE, Con_Benchmark, this, "Play a demo at a fixed fps (default 60), report the frame times and quit");
 	m_pConsole->Register("record", "?s", CFGFLAG_CLIENT, Con_Record, this, "Record to the file");
 	m_pConsole->Register("stoprecord", "", CFGFLAG_CLIENT, Con_StopRecord, this, "Stop recording");
 	m_pConsole->Register("add_demomarker", "", CFGFLAG_CLIENT, Con_AddDemoMarker, this, "Add demo timeline marker");
@@ -117,6 +117,15 @@ class CClient : public IClient, public CDemoPlayer::IListner
 	//
 	char m_aCmdConnect[256];
 
+	// benchmark, plays a demo at a fixed timestep
+	bool m_Benchmark;
+	int64 m_BenchmarkStep;
+	int m_BenchmarkFrames;
+	int64 m_BenchmarkFrameTime;
+	int64 m_BenchmarkFrameMax;
+	int64 m_aBenchmarkTime[CFrameProfile::NUM_PARTS];
+	int64 m_aBenchmarkMax[CFrameProfile::NUM_PARTS];
+
 	// map download
 	char m_aMapdownloadFilename[256];
 	char m_aMapdownloadName[256];
@@ -286,6 +295,7 @@ public:
 	static void Con_AddFavorite(IConsole::IResult *pResult, void *pUserData);
 	static void Con_RemoveFavorite(IConsole::IResult *pResult, void *pUserData);
 	static void Con_Play(IConsole::IResult *pResult, void *pUserData);
+	static void Con_Benchmark(IConsole::IResult *pResult, void *pUserData);
 	static void Con_Record(IConsole::IResult *pResult, void *pUserData);
 	static void Con_StopRecord(IConsole::IResult *pResult, void *pUserData);
 	static void Con_AddDemoMarker(IConsole::IResult *pResult, void *pUserData);
@@ -294,6 +304,8 @@ public:
 	void RegisterCommands();
 
 	const char *DemoPlayer_Play(const char *pFilename, int StorageType);
+	void Benchmark_Frame(int64 FrameTime);
+	void Benchmark_Report();
 	void DemoRecorder_Start(const char *pFilename, bool WithTimestamp);
 	void DemoRecorder_HandleAutoStart();
 	void DemoRecorder_Stop();
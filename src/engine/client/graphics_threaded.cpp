@@ -9,6 +9,7 @@
 #include <engine/external/pnglite/pnglite.h>
 
 #include <engine/shared/config.h>
+#include <engine/shared/frameprofile.h>
 #include <engine/graphics.h>
 #include <engine/storage.h>
 #include <engine/keys.h>
@@ -47,6 +48,7 @@ void CGraphics_Threaded::FlushVertices()
 	if(m_NumVertices == 0)
 		return;
 
+	CFrameProfileScope ProfileScope(CFrameProfile::PART_CMDBUFFER);
 	int NumVerts = m_NumVertices;
 	m_NumVertices = 0;
 
@@ -438,7 +440,10 @@ int CGraphics_Threaded::LoadPNG(CImageInfo *pImg, const char *pFilename, int Sto
 
 void CGraphics_Threaded::KickCommandBuffer()
 {
-	m_pBackend->RunBuffer(m_pCommandBuffer);
+	{
+		CFrameProfileScope ProfileScope(CFrameProfile::PART_BACKEND);
+		m_pBackend->RunBuffer(m_pCommandBuffer);
+	}
 
 	// swap buffer
 	m_CurrentCommandBuffer ^= 1;
@@ -745,7 +750,7 @@ int CGraphics_Threaded::Init()
 		m_aTextureIndices[i] = i+1;
 	m_aTextureIndices[MAX_TEXTURES-1] = -1;
 
-	m_pBackend = CreateGraphicsBackend();
+	m_pBackend = g_Config.m_GfxNull ? CreateGraphicsBackendNull() : CreateGraphicsBackend();
 	if(InitWindow() != 0)
 		return -1;
 
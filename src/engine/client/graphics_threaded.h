@@ -442,3 +442,4 @@ public:
 };
 
 extern IGraphicsBackend *CreateGraphicsBackend();
+extern IGraphicsBackend *CreateGraphicsBackendNull();
@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <algorithm> // sort  TODO: remove this
+#include <ctype.h>
 
 #include <base/math.h>
 #include <base/system.h>
@@ -26,14 +27,24 @@ class SortWrap
 	CServerBrowser *m_pThis;
 public:
 	SortWrap(CServerBrowser *t, SortFunc f) : m_pfnSort(f), m_pThis(t) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
+	bool operator()(int a, int b) { return (m_pThis->*m_pfnSort)(a, b); }
 };
 
+// same as the comparisons of str_find_nocase
+static void StrLower(char *pDst, const char *pSrc, int DstSize)
+{
+	int i = 0;
+	for(; i < DstSize-1 && pSrc[i]; i++)
+		pDst[i] = tolower(pSrc[i]);
+	pDst[i] = 0;
+}
+
 CServerBrowser::CServerBrowser()
 {
 	m_pMasterServer = 0;
 	m_ppServerlist = 0;
 	m_pSortedServerlist = 0;
+	m_pOrderedServerlist = 0;
 
 	m_NumFavoriteServers = 0;
 
@@ -46,11 +57,11 @@ CServerBrowser::CServerBrowser()
 	m_NeedRefresh = 0;
 
 	m_NumSortedServers = 0;
-	m_NumSortedServersCapacity = 0;
 	m_NumServers = 0;
 	m_NumServerCapacity = 0;
 
 	m_Sorthash = 0;
+	m_Orderhash = -1;
 	m_aFilterString[0] = 0;
 	m_aFilterGametypeString[0] = 0;
 
@@ -72,6 +83,8 @@ void CServerBrowser::SetBaseInfo(class CNetClient *pClient, const char *pNetVers
 	IConfig *pConfig = Kernel()->RequestInterface<IConfig>();
 	if(pConfig)
 		pConfig->RegisterCallback(ConfigSaveCallback, this);
+
+	m_pConsole->Register("br_benchmark", "?i", CFGFLAG_CLIENT, ConBenchmark, this, "Replace the server list with made up servers (default 5000) and time sorting and filtering them");
 }
 
 const CServerInfo *CServerBrowser::SortedGet(int Index) const
@@ -126,139 +139,138 @@ bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
 	return a->m_Info.m_NumClients < b->m_Info.m_NumClients;
 }
 
-void CServerBrowser::Filter()
+bool CServerBrowser::FilterEntry(CServerEntry *pEntry)
 {
-	int i = 0, p = 0;
-	m_NumSortedServers = 0;
-
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
+	int p = 0;
+	int Filtered = 0;
+
+	if(g_Config.m_BrFilterEmpty && ((g_Config.m_BrFilterSpectators && pEntry->m_Info.m_NumPlayers == 0) || pEntry->m_Info.m_NumClients == 0))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterFull && ((g_Config.m_BrFilterSpectators && pEntry->m_Info.m_NumPlayers == pEntry->m_Info.m_MaxPlayers) ||
+			pEntry->m_Info.m_NumClients == pEntry->m_Info.m_MaxClients))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPw && pEntry->m_Info.m_Flags&SERVER_FLAG_PASSWORD)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPure &&
+		(str_comp(pEntry->m_Info.m_aGameType, "DM") != 0 &&
+		str_comp(pEntry->m_Info.m_aGameType, "TDM") != 0 &&
+		str_comp(pEntry->m_Info.m_aGameType, "CTF") != 0))
 	{
-		if(m_pSortedServerlist)
-			mem_free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)mem_alloc(m_NumSortedServersCapacity*sizeof(int), 1);
+		Filtered = 1;
 	}
-
-	// filter the servers
-	for(i = 0; i < m_NumServers; i++)
+	else if(g_Config.m_BrFilterPureMap &&
+		!(str_comp(pEntry->m_Info.m_aMap, "dm1") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "dm2") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "dm6") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "dm7") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "dm8") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "dm9") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf1") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf2") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf3") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf4") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf5") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf6") == 0 ||
+		str_comp(pEntry->m_Info.m_aMap, "ctf7") == 0)
+	)
 	{
-		int Filtered = 0;
-
-		if(g_Config.m_BrFilterEmpty && ((g_Config.m_BrFilterSpectators && m_ppServerlist[i]->m_Info.m_NumPlayers == 0) || m_ppServerlist[i]->m_Info.m_NumClients == 0))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterFull && ((g_Config.m_BrFilterSpectators && m_ppServerlist[i]->m_Info.m_NumPlayers == m_ppServerlist[i]->m_Info.m_MaxPlayers) ||
-				m_ppServerlist[i]->m_Info.m_NumClients == m_ppServerlist[i]->m_Info.m_MaxClients))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPw && m_ppServerlist[i]->m_Info.m_Flags&SERVER_FLAG_PASSWORD)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPure &&
-			(str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "DM") != 0 &&
-			str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "TDM") != 0 &&
-			str_comp(m_ppServerlist[i]->m_Info.m_aGameType, "CTF") != 0))
-		{
-			Filtered = 1;
-		}
-		else if(g_Config.m_BrFilterPureMap &&
-			!(str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm1") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm2") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm6") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm7") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm8") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "dm9") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf1") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf2") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf3") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf4") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf5") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf6") == 0 ||
-			str_comp(m_ppServerlist[i]->m_Info.m_aMap, "ctf7") == 0)
-		)
+		Filtered = 1;
+	}
+	else if(g_Config.m_BrFilterPing < pEntry->m_Info.m_Latency)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterCompatversion && str_comp_num(pEntry->m_Info.m_aVersion, m_aNetVersion, 3) != 0)
+		Filtered = 1;
+	else if((g_Config.m_BrFilterUptodate && str_comp_num(pEntry->m_Info.m_aVersion, m_aGameVersion, 5) != 0)
+		&& !(str_comp_num(pEntry->m_Info.m_aVersion, m_aGameVersion, 4) == 0 
+		&& pEntry->m_Info.m_aVersion[4] >= m_aGameVersion[4] && pEntry->m_Info.m_aVersion[4] <= '9'))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(pEntry->m_Info.m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(pEntry->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = 1;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find_nocase(pEntry->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = 1;
+	else
+	{
+		if(g_Config.m_BrFilterCountry)
 		{
 			Filtered = 1;
-		}
-		else if(g_Config.m_BrFilterPing < m_ppServerlist[i]->m_Info.m_Latency)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterCompatversion && str_comp_num(m_ppServerlist[i]->m_Info.m_aVersion, m_aNetVersion, 3) != 0)
-			Filtered = 1;
-		else if((g_Config.m_BrFilterUptodate && str_comp_num(m_ppServerlist[i]->m_Info.m_aVersion, m_aGameVersion, 5) != 0)
-			&& !(str_comp_num(m_ppServerlist[i]->m_Info.m_aVersion, m_aGameVersion, 4) == 0 
-			&& m_ppServerlist[i]->m_Info.m_aVersion[4] >= m_aGameVersion[4] && m_ppServerlist[i]->m_Info.m_aVersion[4] <= '9'))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else
-		{
-			if(g_Config.m_BrFilterCountry)
+			// match against player country
+			for(p = 0; p < pEntry->m_Info.m_NumClients; p++)
 			{
-				Filtered = 1;
-				// match against player country
-				for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
+				if(pEntry->m_Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 				{
-					if(m_ppServerlist[i]->m_Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = 0;
-						break;
-					}
+					Filtered = 0;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != 0)
-			{
-				int MatchFound = 0;
-
-				m_ppServerlist[i]->m_Info.m_QuickSearchHit = 0;
-
-				// match against server name
-				if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aName, g_Config.m_BrFilterString))
-				{
-					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-				}
+		if(!Filtered && m_aFilterString[0] != 0)
+		{
+			int MatchFound = 0;
 
-				// match against players
-				for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
-				{
-					if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName, g_Config.m_BrFilterString) ||
-						str_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan, g_Config.m_BrFilterString))
-					{
-						MatchFound = 1;
-						m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-						break;
-					}
-				}
+			pEntry->m_Info.m_QuickSearchHit = 0;
 
-				// match against map
-				if(str_find_nocase(m_ppServerlist[i]->m_Info.m_aMap, g_Config.m_BrFilterString))
-				{
-					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
-				}
+			// match against server name
+			if(str_find(pEntry->m_aSearchName, m_aFilterString))
+			{
+				MatchFound = 1;
+				pEntry->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+			}
 
-				if(!MatchFound)
-					Filtered = 1;
+			// match against players
+			if(str_find(pEntry->m_aSearchPlayers, m_aFilterString))
+			{
+				MatchFound = 1;
+				pEntry->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
 			}
-		}
 
-		if(Filtered == 0)
-		{
-			// check for friend
-			m_ppServerlist[i]->m_Info.m_FriendState = IFriends::FRIEND_NO;
-			for(p = 0; p < m_ppServerlist[i]->m_Info.m_NumClients; p++)
+			// match against map
+			if(str_find(pEntry->m_aSearchMap, m_aFilterString))
 			{
-				m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName,
-					m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan);
-				m_ppServerlist[i]->m_Info.m_FriendState = max(m_ppServerlist[i]->m_Info.m_FriendState, m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState);
+				MatchFound = 1;
+				pEntry->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
 			}
 
-			if(!g_Config.m_BrFilterFriends || m_ppServerlist[i]->m_Info.m_FriendState != IFriends::FRIEND_NO)
-				m_pSortedServerlist[m_NumSortedServers++] = i;
+			if(!MatchFound)
+				Filtered = 1;
 		}
 	}
+
+	if(Filtered)
+		return false;
+
+	// check for friend
+	pEntry->m_Info.m_FriendState = IFriends::FRIEND_NO;
+	for(p = 0; p < pEntry->m_Info.m_NumClients; p++)
+	{
+		pEntry->m_Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(pEntry->m_Info.m_aClients[p].m_aName,
+			pEntry->m_Info.m_aClients[p].m_aClan);
+		pEntry->m_Info.m_FriendState = max(pEntry->m_Info.m_FriendState, pEntry->m_Info.m_aClients[p].m_FriendState);
+	}
+
+	return !g_Config.m_BrFilterFriends || pEntry->m_Info.m_FriendState != IFriends::FRIEND_NO;
+}
+
+void CServerBrowser::Filter()
+{
+	// the quick search compares against the lowercase keys
+	StrLower(m_aFilterString, g_Config.m_BrFilterString, sizeof(m_aFilterString));
+
+	// filter the servers, they keep their order
+	m_NumSortedServers = 0;
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		CServerEntry *pEntry = m_ppServerlist[m_pOrderedServerlist[i]];
+		if(FilterEntry(pEntry))
+		{
+			pEntry->m_Info.m_SortedIndex = m_NumSortedServers;
+			m_pSortedServerlist[m_NumSortedServers++] = m_pOrderedServerlist[i];
+		}
+		else
+			pEntry->m_Info.m_SortedIndex = -1;
+	}
 }
 
 int CServerBrowser::SortHash() const
@@ -280,35 +292,115 @@ int CServerBrowser::SortHash() const
 	return i;
 }
 
-void CServerBrowser::Sort()
+int CServerBrowser::OrderHash() const
 {
-	int i;
-
-	// create filtered list
-	Filter();
+	return (g_Config.m_BrSort&0xf) | g_Config.m_BrSortOrder<<4 | g_Config.m_BrFilterSpectators<<5;
+}
 
-	// sort
+bool CServerBrowser::SortCompare(int Index1, int Index2) const
+{
+	bool (CServerBrowser::*pfnSort)(int, int) const = 0;
 	if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareName));
+		pfnSort = &CServerBrowser::SortCompareName;
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortComparePing));
+		pfnSort = &CServerBrowser::SortComparePing;
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareMap));
+		pfnSort = &CServerBrowser::SortCompareMap;
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this,
-					g_Config.m_BrFilterSpectators ? &CServerBrowser::SortCompareNumPlayers : &CServerBrowser::SortCompareNumClients));
+		pfnSort = g_Config.m_BrFilterSpectators ? &CServerBrowser::SortCompareNumPlayers : &CServerBrowser::SortCompareNumClients;
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist+m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareGametype));
+		pfnSort = &CServerBrowser::SortCompareGametype;
 
-	// set indexes
-	for(i = 0; i < m_NumSortedServers; i++)
-		m_ppServerlist[m_pSortedServerlist[i]]->m_Info.m_SortedIndex = i;
+	if(pfnSort)
+	{
+		int a = g_Config.m_BrSortOrder ? Index2 : Index1;
+		int b = g_Config.m_BrSortOrder ? Index1 : Index2;
+		if((this->*pfnSort)(a, b))
+			return true;
+		if((this->*pfnSort)(b, a))
+			return false;
+	}
+
+	// equal servers stay in the order they were added. that makes the order
+	// strict, so a single server can be put where a full sort would put it
+	return Index1 < Index2;
+}
+
+int CServerBrowser::SortedPosition(const int *pList, int Num, int Index) const
+{
+	int Low = 0, High = Num;
+	while(Low < High)
+	{
+		int Mid = (Low+High)/2;
+		if(SortCompare(pList[Mid], Index))
+			Low = Mid+1;
+		else
+			High = Mid;
+	}
+	return Low;
+}
+
+void CServerBrowser::Sort()
+{
+	// the order of all servers only has to be rebuilt when the sorting
+	// changes, server updates keep it sorted
+	if(m_Orderhash != OrderHash())
+	{
+		std::sort(m_pOrderedServerlist, m_pOrderedServerlist+m_NumServers, SortWrap(this, &CServerBrowser::SortCompare));
+		for(int i = 0; i < m_NumServers; i++)
+			m_ppServerlist[m_pOrderedServerlist[i]]->m_OrderIndex = i;
+		m_Orderhash = OrderHash();
+	}
+
+	// create filtered list
+	Filter();
 
 	str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype, sizeof(m_aFilterGametypeString));
-	str_copy(m_aFilterString, g_Config.m_BrFilterString, sizeof(m_aFilterString));
 	m_Sorthash = SortHash();
 }
 
+void CServerBrowser::Resort(CServerEntry *pEntry)
+{
+	if(m_Orderhash != OrderHash() || m_Sorthash != SortHash())
+	{
+		Sort();
+		return;
+	}
+
+	int Index = pEntry->m_Info.m_ServerIndex;
+
+	// move it to its new place among all servers
+	int OldPos = pEntry->m_OrderIndex;
+	mem_move(&m_pOrderedServerlist[OldPos], &m_pOrderedServerlist[OldPos+1], (m_NumServers-OldPos-1)*sizeof(int));
+	int NewPos = SortedPosition(m_pOrderedServerlist, m_NumServers-1, Index);
+	mem_move(&m_pOrderedServerlist[NewPos+1], &m_pOrderedServerlist[NewPos], (m_NumServers-1-NewPos)*sizeof(int));
+	m_pOrderedServerlist[NewPos] = Index;
+	for(int i = min(OldPos, NewPos); i <= max(OldPos, NewPos); i++)
+		m_ppServerlist[m_pOrderedServerlist[i]]->m_OrderIndex = i;
+
+	// same for the filtered list, in case it's still in there
+	int First = m_NumSortedServers;
+	if(pEntry->m_Info.m_SortedIndex >= 0)
+	{
+		First = pEntry->m_Info.m_SortedIndex;
+		mem_move(&m_pSortedServerlist[First], &m_pSortedServerlist[First+1], (m_NumSortedServers-First-1)*sizeof(int));
+		m_NumSortedServers--;
+	}
+	pEntry->m_Info.m_SortedIndex = -1;
+	if(FilterEntry(pEntry))
+	{
+		int Pos = SortedPosition(m_pSortedServerlist, m_NumSortedServers, Index);
+		mem_move(&m_pSortedServerlist[Pos+1], &m_pSortedServerlist[Pos], (m_NumSortedServers-Pos)*sizeof(int));
+		m_pSortedServerlist[Pos] = Index;
+		m_NumSortedServers++;
+		First = min(First, Pos);
+	}
+
+	// set indexes
+	for(int i = First; i < m_NumSortedServers; i++)
+		m_ppServerlist[m_pSortedServerlist[i]]->m_Info.m_SortedIndex = i;
+}
+
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
 {
 	if(pEntry->m_pPrevReq || pEntry->m_pNextReq || m_pFirstReqServer == pEntry)
@@ -357,8 +449,12 @@ void CServerBrowser::QueueRequest(CServerEntry *pEntry)
 void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
 	int Fav = pEntry->m_Info.m_Favorite;
+	int ServerIndex = pEntry->m_Info.m_ServerIndex;
+	int SortedIndex = pEntry->m_Info.m_SortedIndex;
 	pEntry->m_Info = Info;
 	pEntry->m_Info.m_Favorite = Fav;
+	pEntry->m_Info.m_ServerIndex = ServerIndex;
+	pEntry->m_Info.m_SortedIndex = SortedIndex;
 	pEntry->m_Info.m_NetAddr = pEntry->m_Addr;
 
 	// all these are just for nice compability
@@ -375,9 +471,32 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 		RemoveRequest(pEntry);
 	}*/
 
+	SetSearchKeys(pEntry);
 	pEntry->m_InfoState = CServerEntry::STATE_READY;
 }
 
+void CServerBrowser::SetSearchKeys(CServerEntry *pEntry)
+{
+	StrLower(pEntry->m_aSearchName, pEntry->m_Info.m_aName, sizeof(pEntry->m_aSearchName));
+	StrLower(pEntry->m_aSearchMap, pEntry->m_Info.m_aMap, sizeof(pEntry->m_aSearchMap));
+
+	// a newline can't be in names or searched for, so matches don't run from one into the next
+	char *pDst = pEntry->m_aSearchPlayers;
+	char *pEnd = pEntry->m_aSearchPlayers + sizeof(pEntry->m_aSearchPlayers) - 1;
+	for(int p = 0; p < pEntry->m_Info.m_NumClients; p++)
+	{
+		StrLower(pDst, pEntry->m_Info.m_aClients[p].m_aName, min((int)MAX_NAME_LENGTH, (int)(pEnd-pDst)));
+		pDst += str_length(pDst);
+		if(pDst < pEnd)
+			*pDst++ = '\n';
+		StrLower(pDst, pEntry->m_Info.m_aClients[p].m_aClan, min((int)MAX_CLAN_LENGTH, (int)(pEnd-pDst)));
+		pDst += str_length(pDst);
+		if(pDst < pEnd)
+			*pDst++ = '\n';
+	}
+	*pDst = 0;
+}
+
 CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 {
 	int Hash = Addr.ip[0];
@@ -395,6 +514,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 	pEntry->m_Info.m_Latency = 999;
 	net_addr_str(&Addr, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aAddress), true);
 	str_copy(pEntry->m_Info.m_aName, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aName));
+	SetSearchKeys(pEntry);
 
 	// check if it's a favorite
 	for(int i = 0; i < m_NumFavoriteServers; i++)
@@ -415,11 +535,24 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 		mem_copy(ppNewlist, m_ppServerlist, m_NumServers*sizeof(CServerEntry*));
 		mem_free(m_ppServerlist);
 		m_ppServerlist = ppNewlist;
+
+		int *pNewSorted = (int *)mem_alloc(m_NumServerCapacity*sizeof(int), 1);
+		mem_copy(pNewSorted, m_pSortedServerlist, m_NumSortedServers*sizeof(int));
+		mem_free(m_pSortedServerlist);
+		m_pSortedServerlist = pNewSorted;
+
+		int *pNewOrdered = (int *)mem_alloc(m_NumServerCapacity*sizeof(int), 1);
+		mem_copy(pNewOrdered, m_pOrderedServerlist, m_NumServers*sizeof(int));
+		mem_free(m_pOrderedServerlist);
+		m_pOrderedServerlist = pNewOrdered;
 	}
 
-	// add to list
+	// add to list, at the end of the order until it gets sorted in
 	m_ppServerlist[m_NumServers] = pEntry;
 	pEntry->m_Info.m_ServerIndex = m_NumServers;
+	pEntry->m_Info.m_SortedIndex = -1;
+	m_pOrderedServerlist[m_NumServers] = m_NumServers;
+	pEntry->m_OrderIndex = m_NumServers;
 	m_NumServers++;
 
 	return pEntry;
@@ -467,14 +600,16 @@ void CServerBrowser::Set(const NETADDR &Addr, int Type, int Token, const CServer
 				pEntry->m_Info.m_Latency = min(static_cast<int>((time_get()-pEntry->m_RequestTime)*1000/time_freq()), 999);
 			RemoveRequest(pEntry);
 		}
+		else
+			pEntry = 0;
 	}
 
-	Sort();
+	if(pEntry)
+		Resort(pEntry);
 }
 
-void CServerBrowser::Refresh(int Type)
+void CServerBrowser::Clear()
 {
-	// clear out everything
 	m_ServerlistHeap.Reset();
 	m_NumServers = 0;
 	m_NumSortedServers = 0;
@@ -482,6 +617,12 @@ void CServerBrowser::Refresh(int Type)
 	m_pFirstReqServer = 0;
 	m_pLastReqServer = 0;
 	m_NumRequests = 0;
+}
+
+void CServerBrowser::Refresh(int Type)
+{
+	// clear out everything
+	Clear();
 
 	// next token
 	m_CurrentLanToken = (m_CurrentLanToken+1)&0xff;
@@ -727,6 +868,120 @@ int CServerBrowser::LoadingProgression() const
 }
 
 
+static unsigned s_BenchmarkSeed;
+
+static int BenchmarkRandom(int Max)
+{
+	return random_next(&s_BenchmarkSeed)%Max;
+}
+
+static void BenchmarkString(char *pDst, int Length)
+{
+	for(int i = 0; i < Length; i++)
+		pDst[i] = BenchmarkRandom(4) ? 'a'+BenchmarkRandom(26) : 'A'+BenchmarkRandom(26);
+	pDst[Length] = 0;
+}
+
+static void BenchmarkInfo(CServerInfo *pInfo)
+{
+	static const char *s_apGameTypes[] = {"DM", "TDM", "CTF", "DDRace", "iCTF", "zCatch"};
+	static const char *s_apMaps[] = {"dm1", "dm2", "dm6", "ctf1", "ctf2", "ctf5", "ctf7", "run_blue"};
+
+	mem_zero(pInfo, sizeof(*pInfo));
+	BenchmarkString(pInfo->m_aName, 8+BenchmarkRandom(40));
+	str_copy(pInfo->m_aGameType, s_apGameTypes[BenchmarkRandom(sizeof(s_apGameTypes)/sizeof(s_apGameTypes[0]))], sizeof(pInfo->m_aGameType));
+	str_copy(pInfo->m_aMap, s_apMaps[BenchmarkRandom(sizeof(s_apMaps)/sizeof(s_apMaps[0]))], sizeof(pInfo->m_aMap));
+	str_copy(pInfo->m_aVersion, "0.6 626fce9a778df4d4", sizeof(pInfo->m_aVersion));
+	pInfo->m_MaxClients = pInfo->m_MaxPlayers = 16;
+	pInfo->m_NumClients = BenchmarkRandom(17);
+	pInfo->m_NumPlayers = pInfo->m_NumClients ? pInfo->m_NumClients-BenchmarkRandom(pInfo->m_NumClients) : 0;
+	pInfo->m_Latency = 20+BenchmarkRandom(400);
+	for(int p = 0; p < pInfo->m_NumClients; p++)
+	{
+		BenchmarkString(pInfo->m_aClients[p].m_aName, 3+BenchmarkRandom(MAX_NAME_LENGTH-4));
+		BenchmarkString(pInfo->m_aClients[p].m_aClan, BenchmarkRandom(MAX_CLAN_LENGTH-1));
+		pInfo->m_aClients[p].m_Player = p < pInfo->m_NumPlayers;
+	}
+}
+
+void CServerBrowser::Benchmark(int NumServers)
+{
+	enum
+	{
+		NUM_UPDATES=1000,
+	};
+
+	// the made up servers stay in the list until the next refresh
+	Clear();
+	m_ServerlistType = IServerBrowser::TYPE_INTERNET;
+	s_BenchmarkSeed = 1;
+
+	// servers coming in from the masters and answering one by one
+	CServerInfo Info;
+	int64 Start = time_get();
+	for(int i = 0; i < NumServers; i++)
+	{
+		NETADDR Addr;
+		mem_zero(&Addr, sizeof(Addr));
+		Addr.type = NETTYPE_IPV4;
+		Addr.ip[0] = 10;
+		Addr.ip[1] = (i>>16)&0xff;
+		Addr.ip[2] = (i>>8)&0xff;
+		Addr.ip[3] = i&0xff;
+		Addr.port = 8303;
+		CServerEntry *pEntry = Add(Addr);
+		Resort(pEntry);
+		BenchmarkInfo(&Info);
+		SetInfo(pEntry, Info);
+		Resort(pEntry);
+	}
+	int64 FillTime = time_get()-Start;
+
+	// a full sort, this used to run for every server info
+	Start = time_get();
+	m_Orderhash = -1;
+	Sort();
+	int64 SortTime = time_get()-Start;
+
+	// new infos for servers that are already in the list
+	Start = time_get();
+	for(int i = 0; i < NUM_UPDATES; i++)
+	{
+		CServerEntry *pEntry = m_ppServerlist[BenchmarkRandom(m_NumServers)];
+		BenchmarkInfo(&Info);
+		SetInfo(pEntry, Info);
+		Resort(pEntry);
+	}
+	int64 UpdateTime = time_get()-Start;
+
+	// typing into the quick search and deleting it again
+	char aOldFilter[sizeof(g_Config.m_BrFilterString)];
+	str_copy(aOldFilter, g_Config.m_BrFilterString, sizeof(aOldFilter));
+	static const char *s_apFilters[] = {"a", "ab", "abc", "ab", "a", ""};
+	int NumFilters = sizeof(s_apFilters)/sizeof(s_apFilters[0]);
+	Start = time_get();
+	for(int i = 0; i < NumFilters; i++)
+	{
+		str_copy(g_Config.m_BrFilterString, s_apFilters[i], sizeof(g_Config.m_BrFilterString));
+		Sort();
+	}
+	int64 FilterTime = time_get()-Start;
+	str_copy(g_Config.m_BrFilterString, aOldFilter, sizeof(g_Config.m_BrFilterString));
+	Sort();
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%d servers, %d shown: filling %.2f ms, full sort %.3f ms, update %.3f ms, quick search %.3f ms",
+		m_NumServers, m_NumSortedServers, FillTime*1000.0/time_freq(), SortTime*1000.0/time_freq(),
+		UpdateTime*1000.0/time_freq()/NUM_UPDATES, FilterTime*1000.0/time_freq()/NumFilters);
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "client_srvbrowse", aBuf);
+}
+
+void CServerBrowser::ConBenchmark(IConsole::IResult *pResult, void *pUserData)
+{
+	CServerBrowser *pSelf = (CServerBrowser *)pUserData;
+	pSelf->Benchmark(pResult->NumArguments() ? clamp(pResult->GetInteger(0), 1, 0xffffff) : 5000);
+}
+
 void CServerBrowser::ConfigSaveCallback(IConfig *pConfig, void *pUserData)
 {
 	CServerBrowser *pSelf = (CServerBrowser *)pUserData;
@@ -3,6 +3,7 @@
 #ifndef ENGINE_CLIENT_SERVERBROWSER_H
 #define ENGINE_CLIENT_SERVERBROWSER_H
 
+#include <engine/console.h>
 #include <engine/serverbrowser.h>
 
 class CServerBrowser : public IServerBrowser
@@ -25,6 +26,13 @@ public:
 		int m_CurrentToken;	// the token is to keep server refresh separated from each other
 		CServerInfo m_Info;
 
+		int m_OrderIndex; // position in the sorted list of all servers
+
+		// lowercase copies for the quick search, players and clans are separated by newlines
+		char m_aSearchName[64];
+		char m_aSearchMap[32];
+		char m_aSearchPlayers[MAX_CLIENTS*(MAX_NAME_LENGTH+MAX_CLAN_LENGTH)+1];
+
 		CServerEntry *m_pNextIp; // ip hashed list
 
 		CServerEntry *m_pPrevReq; // request list
@@ -70,7 +78,8 @@ private:
 
 	CHeap m_ServerlistHeap;
 	CServerEntry **m_ppServerlist;
-	int *m_pSortedServerlist;
+	int *m_pSortedServerlist; // the filtered servers, in the same order as m_pOrderedServerlist
+	int *m_pOrderedServerlist; // all servers, sorted
 
 	NETADDR m_aFavoriteServers[MAX_FAVORITES];
 	int m_NumFavoriteServers;
@@ -84,11 +93,11 @@ private:
 	int m_NeedRefresh;
 
 	int m_NumSortedServers;
-	int m_NumSortedServersCapacity;
 	int m_NumServers;
 	int m_NumServerCapacity;
 
 	int m_Sorthash;
+	int m_Orderhash;
 	char m_aFilterString[64];
 	char m_aFilterGametypeString[128];
 
@@ -105,11 +114,18 @@ private:
 	bool SortCompareGametype(int Index1, int Index2) const;
 	bool SortCompareNumPlayers(int Index1, int Index2) const;
 	bool SortCompareNumClients(int Index1, int Index2) const;
+	bool SortCompare(int Index1, int Index2) const;
+	int SortedPosition(const int *pList, int Num, int Index) const;
 
 	//
+	bool FilterEntry(CServerEntry *pEntry);
 	void Filter();
 	void Sort();
+	void Resort(CServerEntry *pEntry);
 	int SortHash() const;
+	int OrderHash() const;
+
+	void Clear();
 
 	CServerEntry *Find(const NETADDR &Addr);
 	CServerEntry *Add(const NETADDR &Addr);
@@ -120,8 +136,12 @@ private:
 	void RequestImpl(const NETADDR &Addr, CServerEntry *pEntry) const;
 
 	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info);
+	void SetSearchKeys(CServerEntry *pEntry);
+
+	void Benchmark(int NumServers);
 
 	static void ConfigSaveCallback(IConfig *pConfig, void *pUserData);
+	static void ConBenchmark(IConsole::IResult *pResult, void *pUserData);
 };
 
 #endif
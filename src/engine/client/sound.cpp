@@ -7,6 +7,7 @@
 #include <engine/storage.h>
 
 #include <engine/shared/config.h>
+#include <engine/shared/soundmix.h>
 
 #include "SDL.h"
 
@@ -50,6 +51,7 @@ struct CVoice
 	int m_Vol; // 0 - 255
 	int m_Flags;
 	int m_X, m_Y;
+	int m_LVol, m_RVol; // set by the game thread, the mixer only reads them
 } ;
 
 static CSample m_aSamples[NUM_SAMPLES] = { {0} };
@@ -70,16 +72,6 @@ static unsigned m_MaxFrames = 0;
 
 static IOHANDLE s_File;
 
-// TODO: there should be a faster way todo this
-static short Int2Short(int i)
-{
-	if(i > 0x7fff)
-		return 0x7fff;
-	else if(i < -0x7fff)
-		return -0x7fff;
-	return i;
-}
-
 static int IntAbs(int i)
 {
 	if(i<0)
@@ -87,11 +79,70 @@ static int IntAbs(int i)
 	return i;
 }
 
+// volume calculation, done on the game thread so the mixer doesn't have to
+static void VoiceVolume(const CChannel *pChannel, int Flags, int x, int y, int *pLVol, int *pRVol)
+{
+	int Rvol = pChannel->m_Vol;
+	int Lvol = pChannel->m_Vol;
+
+	if(Flags&ISound::FLAG_POS && pChannel->m_Pan)
+	{
+		// TODO: we should respect the channel panning value
+		const int Range = 1500; // magic value, remove
+		int dx = x - m_CenterX;
+		int dy = y - m_CenterY;
+		int Dist = (int)sqrtf((float)dx*dx+dy*dy); // float here. nasty
+		int p = IntAbs(dx);
+		if(Dist >= 0 && Dist < Range)
+		{
+			// panning
+			if(dx > 0)
+				Lvol = ((Range-p)*Lvol)/Range;
+			else
+				Rvol = ((Range-p)*Rvol)/Range;
+
+			// falloff
+			Lvol = (Lvol*(Range-Dist))/Range;
+			Rvol = (Rvol*(Range-Dist))/Range;
+		}
+		else
+		{
+			Lvol = 0;
+			Rvol = 0;
+		}
+	}
+
+	*pLVol = Lvol;
+	*pRVol = Rvol;
+}
+
+static void UpdateVoiceVolumes()
+{
+	// only the game thread changes what goes into the volumes, so they can be
+	// calculated without holding up the mixer and stored in one go
+	int aLVol[NUM_VOICES], aRVol[NUM_VOICES];
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		if(m_aVoices[i].m_pChannel)
+			VoiceVolume(m_aVoices[i].m_pChannel, m_aVoices[i].m_Flags, m_aVoices[i].m_X, m_aVoices[i].m_Y, &aLVol[i], &aRVol[i]);
+		else
+			aLVol[i] = aRVol[i] = 0;
+	}
+
+	lock_wait(m_SoundLock);
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		m_aVoices[i].m_LVol = aLVol[i];
+		m_aVoices[i].m_RVol = aRVol[i];
+	}
+	lock_unlock(m_SoundLock);
+}
+
 static void Mix(short *pFinalOut, unsigned Frames)
 {
 	int MasterVol;
-	mem_zero(m_pMixBuffer, m_MaxFrames*2*sizeof(int));
 	Frames = min(Frames, m_MaxFrames);
+	mem_zero(m_pMixBuffer, Frames*2*sizeof(int));
 
 	// aquire lock while we are mixing
 	lock_wait(m_SoundLock);
@@ -104,65 +155,26 @@ static void Mix(short *pFinalOut, unsigned Frames)
 		{
 			// mix voice
 			CVoice *v = &m_aVoices[i];
-			int *pOut = m_pMixBuffer;
-
-			int Step = v->m_pSample->m_Channels; // setup input sources
-			short *pInL = &v->m_pSample->m_pData[v->m_Tick*Step];
-			short *pInR = &v->m_pSample->m_pData[v->m_Tick*Step+1];
-
-			unsigned End = v->m_pSample->m_NumFrames-v->m_Tick;
-
-			int Rvol = v->m_pChannel->m_Vol;
-			int Lvol = v->m_pChannel->m_Vol;
+			CSample *pSample = v->m_pSample;
+			const short *pIn = &pSample->m_pData[v->m_Tick*pSample->m_Channels];
 
 			// make sure that we don't go outside the sound data
+			unsigned End = pSample->m_NumFrames-v->m_Tick;
 			if(Frames < End)
 				End = Frames;
 
-			// check if we have a mono sound
-			if(v->m_pSample->m_Channels == 1)
-				pInR = pInL;
-
-			// volume calculation
-			if(v->m_Flags&ISound::FLAG_POS && v->m_pChannel->m_Pan)
+			// silent voices only move on
+			if(v->m_LVol || v->m_RVol)
 			{
-				// TODO: we should respect the channel panning value
-				const int Range = 1500; // magic value, remove
-				int dx = v->m_X - m_CenterX;
-				int dy = v->m_Y - m_CenterY;
-				int Dist = (int)sqrtf((float)dx*dx+dy*dy); // float here. nasty
-				int p = IntAbs(dx);
-				if(Dist >= 0 && Dist < Range)
-				{
-					// panning
-					if(dx > 0)
-						Lvol = ((Range-p)*Lvol)/Range;
-					else
-						Rvol = ((Range-p)*Rvol)/Range;
-
-					// falloff
-					Lvol = (Lvol*(Range-Dist))/Range;
-					Rvol = (Rvol*(Range-Dist))/Range;
-				}
+				if(pSample->m_Channels == 1)
+					CSoundMix::MixMono(m_pMixBuffer, pIn, End, v->m_LVol, v->m_RVol);
 				else
-				{
-					Lvol = 0;
-					Rvol = 0;
-				}
-			}
-
-			// process all frames
-			for(unsigned s = 0; s < End; s++)
-			{
-				*pOut++ += (*pInL)*Lvol;
-				*pOut++ += (*pInR)*Rvol;
-				pInL += Step;
-				pInR += Step;
-				v->m_Tick++;
+					CSoundMix::MixStereo(m_pMixBuffer, pIn, End, v->m_LVol, v->m_RVol);
 			}
+			v->m_Tick += End;
 
 			// free voice if not used any more
-			if(v->m_Tick == v->m_pSample->m_NumFrames)
+			if(v->m_Tick == pSample->m_NumFrames)
 			{
 				if(v->m_Flags&ISound::FLAG_LOOP)
 					v->m_Tick = 0;
@@ -172,23 +184,11 @@ static void Mix(short *pFinalOut, unsigned Frames)
 		}
 	}
 
-
 	// release the lock
 	lock_unlock(m_SoundLock);
 
-	{
-		// clamp accumulated values
-		// TODO: this seams slow
-		for(unsigned i = 0; i < Frames; i++)
-		{
-			int j = i<<1;
-			int vl = ((m_pMixBuffer[j]*MasterVol)/101)>>8;
-			int vr = ((m_pMixBuffer[j+1]*MasterVol)/101)>>8;
-
-			pFinalOut[j] = Int2Short(vl);
-			pFinalOut[j+1] = Int2Short(vr);
-		}
-	}
+	// clamp accumulated values
+	CSoundMix::Finish(pFinalOut, m_pMixBuffer, Frames, MasterVol);
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
 	swap_endian(pFinalOut, sizeof(short), Frames * 2);
@@ -258,12 +258,8 @@ int CSound::Update()
 	if(!m_pGraphics->WindowActive() && g_Config.m_SndNonactiveMute)
 		WantedVolume = 0;
 
-	if(WantedVolume != m_SoundVolume)
-	{
-		lock_wait(m_SoundLock);
-		m_SoundVolume = WantedVolume;
-		lock_unlock(m_SoundLock);
-	}
+	// the mixer reads it once per callback, no need to lock
+	m_SoundVolume = WantedVolume;
 
 	return 0;
 }
@@ -478,6 +474,7 @@ void CSound::SetListenerPos(float x, float y)
 {
 	m_CenterX = (int)x;
 	m_CenterY = (int)y;
+	UpdateVoiceVolumes();
 }
 
 
@@ -485,6 +482,7 @@ void CSound::SetChannel(int ChannelID, float Vol, float Pan)
 {
 	m_aChannels[ChannelID].m_Vol = (int)(Vol*255.0f);
 	m_aChannels[ChannelID].m_Pan = (int)(Pan*255.0f); // TODO: this is only on and off right now
+	UpdateVoiceVolumes();
 }
 
 int CSound::Play(int ChannelID, int SampleID, int Flags, float x, float y)
@@ -492,6 +490,9 @@ int CSound::Play(int ChannelID, int SampleID, int Flags, float x, float y)
 	int VoiceID = -1;
 	int i;
 
+	int LVol, RVol;
+	VoiceVolume(&m_aChannels[ChannelID], Flags, (int)x, (int)y, &LVol, &RVol);
+
 	lock_wait(m_SoundLock);
 
 	// search for voice
@@ -519,6 +520,8 @@ int CSound::Play(int ChannelID, int SampleID, int Flags, float x, float y)
 		m_aVoices[VoiceID].m_Flags = Flags;
 		m_aVoices[VoiceID].m_X = (int)x;
 		m_aVoices[VoiceID].m_Y = (int)y;
+		m_aVoices[VoiceID].m_LVol = LVol;
+		m_aVoices[VoiceID].m_RVol = RVol;
 	}
 
 	lock_unlock(m_SoundLock);
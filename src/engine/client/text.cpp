@@ -4,6 +4,7 @@
 #include <base/math.h>
 #include <engine/graphics.h>
 #include <engine/textrender.h>
+#include <engine/shared/frameprofile.h>
 
 #ifdef CONF_FAMILY_WINDOWS
 	#include <windows.h>
@@ -17,6 +18,10 @@
 enum
 {
 	MAX_CHARACTERS = 64,
+
+	MAX_LAYOUTS = 1024,
+	MAX_LAYOUT_LENGTH = 128,
+	LAYOUT_HASH_SIZE = 2048,
 };
 
 
@@ -57,6 +62,9 @@ struct CFontSizeData
 	CFontChar m_aCharacters[MAX_CHARACTERS*MAX_CHARACTERS];
 
 	int m_CurrentCharacter;
+
+	// changes whenever a glyph loses its slot in the texture
+	int m_Generation;
 };
 
 class CFont
@@ -67,6 +75,29 @@ public:
 	CFontSizeData m_aSizes[NUM_FONT_SIZES];
 };
 
+// a single line of text laid out from the origin. it stays valid as long as
+// its glyphs keep their slots in the font texture
+struct CTextLayout
+{
+	unsigned m_Hash;
+	CFont *m_pFont;
+	int m_FontSize;
+	float m_Size;
+	int m_Length;
+	char m_aText[MAX_LAYOUT_LENGTH];
+
+	int m_Generation;
+	int m_NumGlyphs;
+	short m_aSlots[MAX_LAYOUT_LENGTH];
+	float m_aX[MAX_LAYOUT_LENGTH];
+	float m_Width;
+	int64 m_BuildTime;
+
+	int m_NextInBucket;
+	int m_Prev; // more recently used
+	int m_Next; // less recently used
+};
+
 
 class CTextRender : public IEngineTextRender
 {
@@ -103,6 +134,13 @@ class CTextRender : public IEngineTextRender
 
 	FT_Library m_FTLibrary;
 
+	CTextLayout m_aLayouts[MAX_LAYOUTS];
+	int m_aLayoutBuckets[LAYOUT_HASH_SIZE];
+	int m_NumLayouts;
+	int m_FirstLayout;
+	int m_LastLayout;
+	CTextLayoutStats m_LayoutStats;
+
 	int GetFontSizeIndex(int Pixelsize)
 	{
 		for(unsigned i = 0; i < NUM_FONT_SIZES; i++)
@@ -166,6 +204,7 @@ class CTextRender : public IEngineTextRender
 		pSizeData->m_TextureWidth = Width;
 		pSizeData->m_TextureHeight = Height;
 		pSizeData->m_CurrentCharacter = 0;
+		pSizeData->m_Generation++;
 		
 		dbg_msg("", "pFont memory usage: %d", FontMemoryUsage);
 
@@ -286,6 +325,7 @@ class CTextRender : public IEngineTextRender
 				return GetSlot(pSizeData);
 			}
 
+			pSizeData->m_Generation++;
 			return Oldest;
 		}
 	}
@@ -432,6 +472,187 @@ class CTextRender : public IEngineTextRender
 		return (Kerning.x>>6);
 	}
 
+	static bool HasNewLine(const char *pText, int Length)
+	{
+		for(int i = 0; i < Length; i++)
+			if(pText[i] == '\n')
+				return true;
+		return false;
+	}
+
+	void ClearLayouts()
+	{
+		for(int i = 0; i < LAYOUT_HASH_SIZE; i++)
+			m_aLayoutBuckets[i] = -1;
+		m_NumLayouts = 0;
+		m_FirstLayout = -1;
+		m_LastLayout = -1;
+	}
+
+	void UnlinkLayout(int Index)
+	{
+		CTextLayout *pLayout = &m_aLayouts[Index];
+		if(pLayout->m_Prev != -1)
+			m_aLayouts[pLayout->m_Prev].m_Next = pLayout->m_Next;
+		else
+			m_FirstLayout = pLayout->m_Next;
+		if(pLayout->m_Next != -1)
+			m_aLayouts[pLayout->m_Next].m_Prev = pLayout->m_Prev;
+		else
+			m_LastLayout = pLayout->m_Prev;
+	}
+
+	void LinkLayoutFirst(int Index)
+	{
+		CTextLayout *pLayout = &m_aLayouts[Index];
+		pLayout->m_Prev = -1;
+		pLayout->m_Next = m_FirstLayout;
+		if(m_FirstLayout != -1)
+			m_aLayouts[m_FirstLayout].m_Prev = Index;
+		else
+			m_LastLayout = Index;
+		m_FirstLayout = Index;
+	}
+
+	// takes a free layout or the least recently used one
+	int NewLayout(int Bucket)
+	{
+		int Index;
+		if(m_NumLayouts < MAX_LAYOUTS)
+			Index = m_NumLayouts++;
+		else
+		{
+			Index = m_LastLayout;
+			UnlinkLayout(Index);
+
+			int *pLink = &m_aLayoutBuckets[m_aLayouts[Index].m_Hash%LAYOUT_HASH_SIZE];
+			while(*pLink != Index)
+				pLink = &m_aLayouts[*pLink].m_NextInBucket;
+			*pLink = m_aLayouts[Index].m_NextInBucket;
+		}
+
+		m_aLayouts[Index].m_NextInBucket = m_aLayoutBuckets[Bucket];
+		m_aLayoutBuckets[Bucket] = Index;
+		LinkLayoutFirst(Index);
+		return Index;
+	}
+
+	// returns the layout of a line or null if it can't be laid out right now
+	CTextLayout *GetLayout(CFont *pFont, CFontSizeData *pSizeData, int FontSize, float Size, float Scale, const char *pText, int Length)
+	{
+		unsigned Hash = 2166136261u;
+		for(int i = 0; i < Length; i++)
+			Hash = (Hash^(unsigned char)pText[i])*16777619u;
+		Hash = (Hash^FontSize)*16777619u;
+		int Bucket = Hash%LAYOUT_HASH_SIZE;
+
+		int Index = m_aLayoutBuckets[Bucket];
+		for(; Index != -1; Index = m_aLayouts[Index].m_NextInBucket)
+		{
+			CTextLayout *pLayout = &m_aLayouts[Index];
+			if(pLayout->m_Hash == Hash && pLayout->m_pFont == pFont && pLayout->m_FontSize == FontSize && pLayout->m_Size == Size &&
+				pLayout->m_Length == Length && mem_comp(pLayout->m_aText, pText, Length) == 0)
+				break;
+		}
+
+		CTextLayout *pLayout;
+		if(Index != -1)
+		{
+			UnlinkLayout(Index);
+			LinkLayoutFirst(Index);
+			pLayout = &m_aLayouts[Index];
+
+			if(pLayout->m_Generation == pSizeData->m_Generation)
+			{
+				// keep the glyphs from getting kicked out of the texture
+				int64 Now = time_get();
+				for(int i = 0; i < pLayout->m_NumGlyphs; i++)
+					pSizeData->m_aCharacters[pLayout->m_aSlots[i]].m_TouchTime = Now;
+
+				m_LayoutStats.m_Hits++;
+				m_LayoutStats.m_SavedTime += pLayout->m_BuildTime;
+				return pLayout;
+			}
+		}
+		else
+		{
+			pLayout = &m_aLayouts[NewLayout(Bucket)];
+			pLayout->m_Hash = Hash;
+			pLayout->m_pFont = pFont;
+			pLayout->m_FontSize = FontSize;
+			pLayout->m_Size = Size;
+			pLayout->m_Length = Length;
+			mem_copy(pLayout->m_aText, pText, Length);
+		}
+
+		// lay it out the same way TextEx does
+		m_LayoutStats.m_Misses++;
+		int64 BuildStart = time_get();
+		int Generation = pSizeData->m_Generation;
+		float DrawX = 0.0f;
+		pLayout->m_NumGlyphs = 0;
+
+		const char *pCurrent = pText;
+		const char *pEnd = pText+Length;
+		const char *pTmp = pCurrent;
+		int NextCharacter = str_utf8_decode(&pTmp);
+		while(pCurrent < pEnd)
+		{
+			int Character = NextCharacter;
+			pCurrent = pTmp;
+			NextCharacter = str_utf8_decode(&pTmp);
+
+			CFontChar *pChr = GetChar(pFont, pSizeData, Character);
+			if(pChr)
+			{
+				pLayout->m_aSlots[pLayout->m_NumGlyphs] = pChr-pSizeData->m_aCharacters;
+				pLayout->m_aX[pLayout->m_NumGlyphs] = DrawX;
+				pLayout->m_NumGlyphs++;
+				// no kerning into what follows, the layout only depends on its own text
+				int Next = pCurrent < pEnd ? NextCharacter : 0;
+				DrawX += (pChr->m_AdvanceX + Kerning(pFont, Character, Next)*Scale)*Size;
+			}
+		}
+		pLayout->m_Width = DrawX;
+		pLayout->m_BuildTime = time_get()-BuildStart;
+
+		// glyphs that got new slots while laying out may have pushed out earlier ones
+		pLayout->m_Generation = Generation == pSizeData->m_Generation ? Generation : -1;
+		return pLayout->m_Generation == -1 ? 0 : pLayout;
+	}
+
+	void RenderLayout(CTextCursor *pCursor, CFontSizeData *pSizeData, const CTextLayout *pLayout, float CursorX, float CursorY, float Size)
+	{
+		if(pCursor->m_Flags&TEXTFLAG_RENDER)
+		{
+			// outline first, like TextEx
+			for(int i = 0; i < 2; i++)
+			{
+				Graphics()->TextureSet(pSizeData->m_aTextures[i == 0 ? 1 : 0]);
+				Graphics()->QuadsBegin();
+				if(i == 0)
+					Graphics()->SetColor(m_TextOutlineR, m_TextOutlineG, m_TextOutlineB, m_TextOutlineA*m_TextA);
+				else
+					Graphics()->SetColor(m_TextR, m_TextG, m_TextB, m_TextA);
+
+				for(int g = 0; g < pLayout->m_NumGlyphs; g++)
+				{
+					const CFontChar *pChr = &pSizeData->m_aCharacters[pLayout->m_aSlots[g]];
+					Graphics()->QuadsSetSubset(pChr->m_aUvs[0], pChr->m_aUvs[1], pChr->m_aUvs[2], pChr->m_aUvs[3]);
+					IGraphics::CQuadItem QuadItem(CursorX+pLayout->m_aX[g]+pChr->m_OffsetX*Size, CursorY+pChr->m_OffsetY*Size, pChr->m_Width*Size, pChr->m_Height*Size);
+					Graphics()->QuadsDrawTL(&QuadItem, 1);
+				}
+				Graphics()->QuadsEnd();
+			}
+
+			// both passes count the characters
+			pCursor->m_CharCount += pLayout->m_NumGlyphs;
+		}
+
+		pCursor->m_CharCount += pLayout->m_NumGlyphs;
+		pCursor->m_X = CursorX+pLayout->m_Width;
+	}
+
 
 public:
 	CTextRender()
@@ -449,6 +670,9 @@ public:
 
 		m_pDefaultFont = 0;
 
+		ClearLayouts();
+		mem_zero(&m_LayoutStats, sizeof(m_LayoutStats));
+
 		// GL_LUMINANCE can be good for debugging
 		//m_FontTextureFormat = GL_ALPHA;
 	}
@@ -482,6 +706,8 @@ public:
 
 	virtual void DestroyFont(CFont *pFont)
 	{
+		// a new font could get the same address
+		ClearLayouts();
 		mem_free(pFont);
 	}
 
@@ -548,8 +774,14 @@ public:
 		m_TextOutlineA = a;
 	}
 
+	virtual void GetLayoutStats(CTextLayoutStats *pStats)
+	{
+		*pStats = m_LayoutStats;
+	}
+
 	virtual void TextEx(CTextCursor *pCursor, const char *pText, int Length)
 	{
+		CFrameProfileScope ProfileScope(CFrameProfile::PART_TEXT);
 		CFont *pFont = pCursor->m_pFont;
 		CFontSizeData *pSizeData = NULL;
 
@@ -599,6 +831,18 @@ public:
 		if(Length < 0)
 			Length = str_length(pText);
 
+		// lines without wrapping come from the layout cache
+		if(Length > 0 && Length < MAX_LAYOUT_LENGTH && pCursor->m_LineWidth <= 0 && pCursor->m_MaxLines < 1 &&
+			!(pCursor->m_Flags&TEXTFLAG_STOP_AT_END) && !HasNewLine(pText, Length))
+		{
+			CTextLayout *pLayout = GetLayout(pFont, pSizeData, ActualSize, Size, Scale, pText, Length);
+			if(pLayout)
+			{
+				RenderLayout(pCursor, pSizeData, pLayout, CursorX, CursorY, Size);
+				return;
+			}
+		}
+
 		// if we don't want to render, we can just skip the first outline pass
 		i = 1;
 		if(pCursor->m_Flags&TEXTFLAG_RENDER)
@@ -1,24 +1,233 @@
+#include <base/math.h>
+
 #include "name_ban.h"
 
-CNameBan *IsNameBanned(const char *pName, CNameBan *pNameBans, int NumNameBans)
+// edit distance that gives up as soon as it exceeds Max, returns Max+1 in that case
+static int BoundedDistance(const int *a, int a_len, const int *b, int b_len, int Max, int *pBuf)
+{
+	if(absolute(a_len - b_len) > Max)
+		return Max + 1;
+	if(a_len > b_len)
+	{
+		int Tmp = a_len;
+		const int *pTmp = a;
+		a_len = b_len;
+		a = b;
+		b_len = Tmp;
+		b = pTmp;
+	}
+#define B(i, j) pBuf[((j)&1) * (a_len + 1) + (i)]
+	for(int i = 0; i <= a_len; i++)
+		B(i, 0) = i;
+	for(int j = 1; j <= b_len; j++)
+	{
+		B(0, j) = j;
+		int RowMin = j;
+		for(int i = 1; i <= a_len; i++)
+		{
+			int Subst = (a[i - 1] != b[j - 1]);
+			B(i, j) = min(min(B(i - 1, j) + 1, B(i, j - 1) + 1), B(i - 1, j - 1) + Subst);
+			RowMin = min(RowMin, B(i, j));
+		}
+		// the distance can't get smaller than the minimum of a row
+		if(RowMin > Max)
+			return Max + 1;
+	}
+	return min(B(a_len, b_len), Max + 1);
+#undef B
+}
+
+unsigned CNameBanIndex::EdgeHash(int Node, int Code)
+{
+	return (unsigned)Node * 2654435761u ^ (unsigned)Code * 40503u;
+}
+
+int CNameBanIndex::Child(int Node, int Code) const
+{
+	if(!m_aEdgeHash.size())
+		return -1;
+	unsigned Mask = m_aEdgeHash.size() - 1;
+	for(unsigned i = EdgeHash(Node, Code) & Mask; m_aEdgeHash[i] != -1; i = (i + 1) & Mask)
+	{
+		const CEdge *pEdge = &m_aEdges[m_aEdgeHash[i]];
+		if(pEdge->m_Node == Node && pEdge->m_Code == Code)
+			return pEdge->m_Child;
+	}
+	return -1;
+}
+
+void CNameBanIndex::AddEdge(int Node, int Code, int Child)
 {
-	char aTrimmed[MAX_NAME_LENGTH];
-	str_copy(aTrimmed, str_utf8_skip_whitespaces(pName), sizeof(aTrimmed));
-	str_utf8_trim_right(aTrimmed);
+	// keep the hash table at most half full
+	if((m_aEdges.size() + 1) * 2 > m_aEdgeHash.size())
+	{
+		int NewSize = max(64, m_aEdgeHash.size() * 2);
+		m_aEdgeHash.set_size(NewSize);
+		for(int i = 0; i < NewSize; i++)
+			m_aEdgeHash[i] = -1;
+		for(int e = 0; e < m_aEdges.size(); e++)
+		{
+			unsigned i = EdgeHash(m_aEdges[e].m_Node, m_aEdges[e].m_Code) & (NewSize - 1);
+			while(m_aEdgeHash[i] != -1)
+				i = (i + 1) & (NewSize - 1);
+			m_aEdgeHash[i] = e;
+		}
+	}
+
+	CEdge Edge;
+	Edge.m_Node = Node;
+	Edge.m_Code = Code;
+	Edge.m_Child = Child;
+	int Index = m_aEdges.add(Edge);
 
-	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
-	int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, sizeof(aSkeleton) / sizeof(aSkeleton[0]));
-	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	unsigned Mask = m_aEdgeHash.size() - 1;
+	unsigned i = EdgeHash(Node, Code) & Mask;
+	while(m_aEdgeHash[i] != -1)
+		i = (i + 1) & Mask;
+	m_aEdgeHash[i] = Index;
+}
+
+void CNameBanIndex::AddSubstring(const char *pName, int BanIndex)
+{
+	// same case folding as str_utf8_find_nocase
+	int Node = 0;
+	while(*pName)
+	{
+		int Code = str_utf8_tolower(str_utf8_decode(&pName));
+		int Next = Child(Node, Code);
+		if(Next == -1)
+		{
+			CNode NewNode;
+			NewNode.m_Fail = 0;
+			NewNode.m_Depth = m_aNodes[Node].m_Depth + 1;
+			NewNode.m_Best = -1;
+			Next = m_aNodes.add(NewNode);
+			AddEdge(Node, Code, Next);
+			m_MaxDepth = max(m_MaxDepth, NewNode.m_Depth);
+		}
+		Node = Next;
+	}
+	m_aNodes[Node].m_Best = max(m_aNodes[Node].m_Best, BanIndex);
+}
+
+void CNameBanIndex::BuildFailLinks()
+{
+	// breadth first, so the fail target of a node is always finished before the node itself
+	for(int Depth = 1; Depth <= m_MaxDepth; Depth++)
+	{
+		for(int e = 0; e < m_aEdges.size(); e++)
+		{
+			const CEdge *pEdge = &m_aEdges[e];
+			CNode *pChild = &m_aNodes[pEdge->m_Child];
+			if(pChild->m_Depth != Depth)
+				continue;
+
+			int Fail = 0;
+			if(pEdge->m_Node != 0)
+			{
+				int Node = m_aNodes[pEdge->m_Node].m_Fail;
+				while(1)
+				{
+					int Next = Child(Node, pEdge->m_Code);
+					if(Next != -1)
+					{
+						Fail = Next;
+						break;
+					}
+					if(Node == 0)
+						break;
+					Node = m_aNodes[Node].m_Fail;
+				}
+			}
+			pChild->m_Fail = Fail;
+			pChild->m_Best = max(pChild->m_Best, m_aNodes[Fail].m_Best);
+		}
+	}
+}
+
+void CNameBanIndex::Build(const CNameBan *pNameBans, int NumNameBans)
+{
+	for(int i = 0; i <= MAX_NAME_SKELETON_LENGTH; i++)
+		m_aaLengthBuckets[i].clear();
+	m_MaxDistance = -1;
+
+	m_aNodes.clear();
+	m_aEdges.clear();
+	m_aEdgeHash.clear();
+	m_MaxDepth = 0;
+
+	CNode Root;
+	Root.m_Fail = 0;
+	Root.m_Depth = 0;
+	Root.m_Best = -1;
+	m_aNodes.add(Root);
 
-	CNameBan *pResult = 0;
 	for(int i = 0; i < NumNameBans; i++)
 	{
-		CNameBan *pBan = &pNameBans[i];
-		int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, pBan->m_aSkeleton, pBan->m_SkeletonLength, aBuffer, sizeof(aBuffer) / sizeof(aBuffer[0]));
-		if(Distance <= pBan->m_Distance || (pBan->m_IsSubstring == 1 && str_utf8_find_nocase(pName, pBan->m_aName)))
+		const CNameBan *pBan = &pNameBans[i];
+		if(pBan->m_Distance >= 0)
 		{
-			pResult = pBan;
+			m_aaLengthBuckets[clamp(pBan->m_SkeletonLength, 0, (int)MAX_NAME_SKELETON_LENGTH)].add(i);
+			m_MaxDistance = max(m_MaxDistance, pBan->m_Distance);
 		}
+		if(pBan->m_IsSubstring == 1)
+			AddSubstring(pBan->m_aName, i);
 	}
-	return pResult;
+	BuildFailLinks();
+
+	m_Dirty = false;
+}
+
+CNameBan *CNameBanIndex::IsBanned(const char *pName, CNameBan *pNameBans, int NumNameBans)
+{
+	if(m_Dirty)
+		Build(pNameBans, NumNameBans);
+
+	// substring bans, matched against the untrimmed name
+	int Best = -1;
+	int Node = 0;
+	const char *pStr = pName;
+	while(*pStr)
+	{
+		int Code = str_utf8_tolower(str_utf8_decode(&pStr));
+		int Next;
+		while((Next = Child(Node, Code)) == -1 && Node != 0)
+			Node = m_aNodes[Node].m_Fail;
+		Node = Next == -1 ? 0 : Next;
+		Best = max(Best, m_aNodes[Node].m_Best);
+	}
+
+	// distance bans, matched against the skeleton of the trimmed name
+	if(m_MaxDistance >= 0)
+	{
+		char aTrimmed[MAX_NAME_LENGTH];
+		str_copy(aTrimmed, str_utf8_skip_whitespaces(pName), sizeof(aTrimmed));
+		str_utf8_trim_right(aTrimmed);
+
+		int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+		int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, sizeof(aSkeleton) / sizeof(aSkeleton[0]));
+		int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+
+		// the edit distance is at least the difference of the lengths
+		int Range = min(m_MaxDistance, (int)MAX_NAME_SKELETON_LENGTH);
+		int MinLength = max(0, SkeletonLength - Range);
+		int MaxLength = min((int)MAX_NAME_SKELETON_LENGTH, SkeletonLength + Range);
+		for(int Length = MinLength; Length <= MaxLength; Length++)
+		{
+			const array<int> &Bucket = m_aaLengthBuckets[Length];
+			// only bans later in the list than the current match can change the result
+			for(int i = Bucket.size() - 1; i >= 0 && Bucket[i] > Best; i--)
+			{
+				const CNameBan *pBan = &pNameBans[Bucket[i]];
+				int MaxDistance = min(pBan->m_Distance, (int)MAX_NAME_SKELETON_LENGTH);
+				if(BoundedDistance(aSkeleton, SkeletonLength, pBan->m_aSkeleton, pBan->m_SkeletonLength, MaxDistance, aBuffer) <= MaxDistance)
+				{
+					Best = Bucket[i];
+					break;
+				}
+			}
+		}
+	}
+
+	return Best == -1 ? 0 : &pNameBans[Best];
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define ENGINE_SERVER_NAME_BAN_H
 
 #include <base/system.h>
+#include <base/tl/array.h>
 #include <engine/shared/protocol.h>
 
 enum
@@ -29,6 +30,61 @@ public:
 	int m_IsSubstring;
 };
 
-CNameBan *IsNameBanned(const char *pName, CNameBan *pNameBans, int NumNameBans);
+/*
+	Class: CNameBanIndex
+		Index over a list of name bans. Distance bans are bucketed by
+		skeleton length and checked with an edit distance that stops as
+		soon as the ban's distance is exceeded, substring bans are matched
+		in a single pass by an Aho-Corasick automaton.
+
+		The index has to be invalidated whenever the ban list changes, it
+		is rebuilt on the next lookup.
+*/
+class CNameBanIndex
+{
+	struct CNode
+	{
+		int m_Fail;
+		int m_Depth;
+		int m_Best; // highest ban index matching when this node is reached
+	};
+
+	struct CEdge
+	{
+		int m_Node;
+		int m_Code;
+		int m_Child;
+	};
+
+	array<int> m_aaLengthBuckets[MAX_NAME_SKELETON_LENGTH+1];
+	int m_MaxDistance;
+
+	array<CNode> m_aNodes;
+	array<CEdge> m_aEdges;
+	array<int> m_aEdgeHash;
+	int m_MaxDepth;
+
+	bool m_Dirty;
+
+	static unsigned EdgeHash(int Node, int Code);
+	int Child(int Node, int Code) const;
+	void AddEdge(int Node, int Code, int Child);
+	void AddSubstring(const char *pName, int BanIndex);
+	void BuildFailLinks();
+
+	void Build(const CNameBan *pNameBans, int NumNameBans);
+
+public:
+	CNameBanIndex() : m_Dirty(true) {}
+
+	void Invalidate() { m_Dirty = true; }
+
+	/*
+		Function: IsBanned
+			Returns the last ban of the list that matches the name or
+			null if the name isn't banned.
+	*/
+	CNameBan *IsBanned(const char *pName, CNameBan *pNameBans, int NumNameBans);
+};
 
 #endif // ENGINE_SERVER_NAME_BAN_H
\ No newline at end of file
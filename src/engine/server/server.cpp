@@ -159,7 +159,7 @@ template<class T>
 int CServerBan::BanExt(T *pBanPool, const typename T::CDataType *pData, int Seconds, const char *pReason)
 {
 	// validate address
-	if(Server()->m_RconClientID >= 0 && Server()->m_RconClientID < MAX_CLIENTS &&
+	if(Server()->m_RconClientID >= 0 && Server()->m_RconClientID < Server()->MaxClients() &&
 		Server()->m_aClients[Server()->m_RconClientID].m_State != CServer::CClient::STATE_EMPTY)
 	{
 		if(NetMatch(pData, Server()->m_NetServer.ClientAddr(Server()->m_RconClientID)))
@@ -168,7 +168,7 @@ int CServerBan::BanExt(T *pBanPool, const typename T::CDataType *pData, int Seco
 			return -1;
 		}
 
-		for(int i = 0; i < MAX_CLIENTS; ++i)
+		for(int i = 0; i < Server()->MaxClients(); ++i)
 		{
 			if(i == Server()->m_RconClientID || Server()->m_aClients[i].m_State == CServer::CClient::STATE_EMPTY)
 				continue;
@@ -182,7 +182,7 @@ int CServerBan::BanExt(T *pBanPool, const typename T::CDataType *pData, int Seco
 	}
 	else if(Server()->m_RconClientID == IServer::RCON_CID_VOTE)
 	{
-		for(int i = 0; i < MAX_CLIENTS; ++i)
+		for(int i = 0; i < Server()->MaxClients(); ++i)
 		{
 			if(Server()->m_aClients[i].m_State == CServer::CClient::STATE_EMPTY)
 				continue;
@@ -201,7 +201,7 @@ int CServerBan::BanExt(T *pBanPool, const typename T::CDataType *pData, int Seco
 
 	// drop banned clients
 	typename T::CDataType Data = *pData;
-	for(int i = 0; i < MAX_CLIENTS; ++i)
+	for(int i = 0; i < Server()->MaxClients(); ++i)
 	{
 		if(Server()->m_aClients[i].m_State == CServer::CClient::STATE_EMPTY)
 			continue;
@@ -243,9 +243,9 @@ void CServerBan::ConBanExt(IConsole::IResult *pResult, void *pUser)
 	if(StrAllnum(pStr))
 	{
 		int ClientID = str_toint(pStr);
-		if(ClientID < 0 || ClientID >= MAX_CLIENTS || pThis->Server()->m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
+		if(ClientID < 0 || ClientID >= pThis->Server()->MaxClients() || pThis->Server()->m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
 			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban error (invalid client id)");
-		else if(ClientID >= 0 && ClientID < MAX_CLIENTS && pThis->Server()->m_aClients[ClientID].m_IsBot)
+		else if(ClientID >= 0 && ClientID < pThis->Server()->MaxClients() && pThis->Server()->m_aClients[ClientID].m_IsBot)
 			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban error (command denied)");
 		else
 			pThis->BanAddr(pThis->Server()->m_NetServer.ClientAddr(ClientID), Minutes*60, pReason);
@@ -287,9 +287,15 @@ CServer::CServer() : m_DemoRecorder(&m_SnapshotDelta)
 	m_RconClientID = IServer::RCON_CID_SERV;
 	m_RconAuthLevel = AUTHED_ADMIN;
 
+	m_aClients = 0;
 	Init();
 }
 
+CServer::~CServer()
+{
+	delete[] m_aClients;
+}
+
 
 int CServer::TrySetClientName(int ClientID, const char *pName)
 {
@@ -309,7 +315,7 @@ int CServer::TrySetClientName(int ClientID, const char *pName)
 		return -1;
 
 	// make sure that two clients don't have the same name
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < MaxClients(); i++)
 	{
 		if(i != ClientID && m_aClients[i].m_State >= CClient::STATE_READY)
 		{
@@ -330,13 +336,13 @@ int CServer::TrySetClientName(int ClientID, const char *pName)
 
 void CServer::SetClientName(int ClientID, const char *pName)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 
 	if(!pName)
 		return;
 
-	CNameBan *pBanned = IsNameBanned(pName, m_aNameBans.base_ptr(), m_aNameBans.size());
+	CNameBan *pBanned = m_NameBanIndex.IsBanned(pName, m_aNameBans.base_ptr(), m_aNameBans.size());
 	if(pBanned)
 	{
 		if(m_aClients[ClientID].m_State == CClient::STATE_READY)
@@ -371,7 +377,7 @@ void CServer::SetClientName(int ClientID, const char *pName)
 
 void CServer::SetClientClan(int ClientID, const char *pClan)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY || !pClan)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State < CClient::STATE_READY || !pClan)
 		return;
 
 	str_copy(m_aClients[ClientID].m_aClan, pClan, MAX_CLAN_LENGTH);
@@ -379,7 +385,7 @@ void CServer::SetClientClan(int ClientID, const char *pClan)
 
 void CServer::SetClientCountry(int ClientID, int Country)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 
 	m_aClients[ClientID].m_Country = Country;
@@ -387,14 +393,14 @@ void CServer::SetClientCountry(int ClientID, int Country)
 
 void CServer::SetClientScore(int ClientID, int Score)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 	m_aClients[ClientID].m_Score = Score;
 }
 
 void CServer::Kick(int ClientID, const char *pReason)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == CClient::STATE_EMPTY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State == CClient::STATE_EMPTY)
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "invalid client id to kick");
 		return;
@@ -435,7 +441,7 @@ int64 CServer::TickStartTime(int Tick)
 
 int CServer::Init()
 {
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < MaxClients(); i++)
 	{
 		m_aClients[i].m_State = CClient::STATE_EMPTY;
 		m_aClients[i].m_aName[0] = 0;
@@ -450,6 +456,14 @@ int CServer::Init()
 	return 0;
 }
 
+void CServer::AllocClients()
+{
+	// the slots stay for the lifetime of the server, changing
+	// sv_max_clients later on has no effect
+	m_aClients = new CClient[MaxClients()];
+	Init();
+}
+
 void CServer::SetRconCID(int ClientID)
 {
 	m_RconClientID = ClientID;
@@ -462,7 +476,7 @@ int CServer::IsAuthed(int ClientID)
 
 int CServer::GetClientInfo(int ClientID, CClientInfo *pInfo)
 {
-	dbg_assert(ClientID >= 0 && ClientID < MAX_CLIENTS, "client_id is not valid");
+	dbg_assert(ClientID >= 0 && ClientID < MaxClients(), "client_id is not valid");
 	dbg_assert(pInfo != 0, "info can not be null");
 
 	if(m_aClients[ClientID].m_State == CClient::STATE_INGAME)
@@ -476,14 +490,25 @@ int CServer::GetClientInfo(int ClientID, CClientInfo *pInfo)
 
 void CServer::GetClientAddr(int ClientID, char *pAddrStr, int Size)
 {
-	if(ClientID >= 0 && ClientID < MAX_CLIENTS && m_aClients[ClientID].m_State == CClient::STATE_INGAME)
+	if(ClientID >= 0 && ClientID < MaxClients() && m_aClients[ClientID].m_State == CClient::STATE_INGAME)
 		net_addr_str(m_NetServer.ClientAddr(ClientID), pAddrStr, Size, false);
 }
 
+bool CServer::GetClientAddr(int ClientID, NETADDR *pAddr)
+{
+	if(ClientID >= 0 && ClientID < MaxClients() && m_aClients[ClientID].m_State == CClient::STATE_INGAME)
+	{
+		*pAddr = *m_NetServer.ClientAddr(ClientID);
+		pAddr->port = 0;
+		return true;
+	}
+	return false;
+}
+
 
 const char *CServer::ClientName(int ClientID)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
 		return "(invalid)";
 	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME)
 		return m_aClients[ClientID].m_aName;
@@ -494,7 +519,7 @@ const char *CServer::ClientName(int ClientID)
 
 const char *CServer::ClientClan(int ClientID)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
 		return "";
 	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME)
 		return m_aClients[ClientID].m_aClan;
@@ -504,7 +529,7 @@ const char *CServer::ClientClan(int ClientID)
 
 int CServer::ClientCountry(int ClientID)
 {
-	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
+	if(ClientID < 0 || ClientID >= MaxClients() || m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
 		return -1;
 	if(m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME)
 		return m_aClients[ClientID].m_Country;
@@ -514,7 +539,7 @@ int CServer::ClientCountry(int ClientID)
 
 bool CServer::ClientIngame(int ClientID)
 {
-	return ClientID >= 0 && ClientID < MAX_CLIENTS && m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME;
+	return ClientID >= 0 && ClientID < MaxClients() && m_aClients[ClientID].m_State == CServer::CClient::STATE_INGAME;
 }
 
 int CServer::MaxClients() const
@@ -559,7 +584,7 @@ int CServer::SendMsgEx(CMsgPacker *pMsg, int Flags, int ClientID, bool System)
 		{
 			// broadcast
 			int i;
-			for(i = 0; i < MAX_CLIENTS; i++)
+			for(i = 0; i < MaxClients(); i++)
 				if(m_aClients[i].m_State == CClient::STATE_INGAME && !m_aClients[i].m_IsBot)
 				{
 					Packet.m_ClientID = i;
@@ -592,7 +617,7 @@ void CServer::DoSnapshot()
 	}
 
 	// create snapshots for all clients
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < MaxClients(); i++)
 	{
 		// client must be ingame to receive snapshots
 		if(m_aClients[i].m_State != CClient::STATE_INGAME)
@@ -822,7 +847,7 @@ void CServer::SendRconLineAuthed(const char *pLine, void *pUser)
 	if(ReentryGuard) return;
 	ReentryGuard++;
 
-	for(i = 0; i < MAX_CLIENTS; i++)
+	for(i = 0; i < pThis->MaxClients(); i++)
 	{
 		if(pThis->m_aClients[i].m_State != CClient::STATE_EMPTY && pThis->m_aClients[i].m_Authed >= pThis->m_RconAuthLevel)
 			pThis->SendRconLine(i, pLine);
@@ -849,7 +874,7 @@ void CServer::SendRconCmdRem(const IConsole::CCommandInfo *pCommandInfo, int Cli
 
 void CServer::UpdateClientRconCommands()
 {
-	int ClientID = Tick() % MAX_CLIENTS;
+	int ClientID = Tick() % MaxClients();
 
 	if(m_aClients[ClientID].m_State != CClient::STATE_EMPTY && m_aClients[ClientID].m_Authed)
 	{
@@ -1148,7 +1173,7 @@ void CServer::SendServerInfo(const NETADDR *pAddr, int Token)
 
 	// count the players
 	int PlayerCount = 0, ClientCount = 0;
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < MaxClients(); i++)
 	{
 		if(m_aClients[i].m_State != CClient::STATE_EMPTY && !m_aClients[i].m_IsBot)
 		{
@@ -1179,15 +1204,23 @@ void CServer::SendServerInfo(const NETADDR *pAddr, int Token)
 	str_format(aBuf, sizeof(aBuf), "%d", i);
 	p.AddString(aBuf, 2);
 
+	// the browsers can't take more than VANILLA_MAX_CLIENTS entries
+	int MaxPlayers = min(m_NetServer.MaxClients()-g_Config.m_SvSpectatorSlots, (int)VANILLA_MAX_CLIENTS);
+	int MaxClients = min(m_NetServer.MaxClients(), (int)VANILLA_MAX_CLIENTS);
+	PlayerCount = min(PlayerCount, MaxPlayers);
+	ClientCount = min(ClientCount, MaxClients);
+
 	str_format(aBuf, sizeof(aBuf), "%d", PlayerCount); p.AddString(aBuf, 3); // num players
-	str_format(aBuf, sizeof(aBuf), "%d", m_NetServer.MaxClients()-g_Config.m_SvSpectatorSlots); p.AddString(aBuf, 3); // max players
+	str_format(aBuf, sizeof(aBuf), "%d", MaxPlayers); p.AddString(aBuf, 3); // max players
 	str_format(aBuf, sizeof(aBuf), "%d", ClientCount); p.AddString(aBuf, 3); // num clients
-	str_format(aBuf, sizeof(aBuf), "%d", m_NetServer.MaxClients()); p.AddString(aBuf, 3); // max clients
+	str_format(aBuf, sizeof(aBuf), "%d", MaxClients); p.AddString(aBuf, 3); // max clients
 
-	for(i = 0; i < MAX_CLIENTS; i++)
+	int Listed = 0;
+	for(i = 0; i < m_NetServer.MaxClients() && Listed < ClientCount; i++)
 	{
 		if(m_aClients[i].m_State != CClient::STATE_EMPTY && !m_aClients[i].m_IsBot)
 		{
+			Listed++;
 			p.AddString(ClientName(i), MAX_NAME_LENGTH); // client name
 			p.AddString(ClientClan(i), MAX_CLAN_LENGTH); // client clan
 			str_format(aBuf, sizeof(aBuf), "%d", m_aClients[i].m_Country); p.AddString(aBuf, 6); // client country
@@ -1206,7 +1239,7 @@ void CServer::SendServerInfo(const NETADDR *pAddr, int Token)
 
 void CServer::UpdateServerInfo()
 {
-	for(int i = 0; i < MAX_CLIENTS; ++i)
+	for(int i = 0; i < MaxClients(); ++i)
 	{
 		if(m_aClients[i].m_State != CClient::STATE_EMPTY && ! m_aClients[i].m_IsBot)
 			SendServerInfo(m_NetServer.ClientAddr(i), -1);
@@ -1342,6 +1375,7 @@ int CServer::Run()
 	}
 
 	m_NetServer.SetCallbacks(NewClientCallback, DelClientCallback, this);
+	AllocClients();
 
 	m_Econ.Init(Console(), &m_ServerBan);
 
@@ -1386,7 +1420,7 @@ int CServer::Run()
 					// new map loaded
 					GameServer()->OnShutdown();
 
-					for(int c = 0; c < MAX_CLIENTS; c++)
+					for(int c = 0; c < MaxClients(); c++)
 					{
 						if(m_aClients[c].m_State <= CClient::STATE_AUTH)
 							continue;
@@ -1416,7 +1450,7 @@ int CServer::Run()
 				NewTicks++;
 
 				// apply new input
-				for(int c = 0; c < MAX_CLIENTS; c++)
+				for(int c = 0; c < MaxClients(); c++)
 				{
 					if(m_aClients[c].m_State == CClient::STATE_EMPTY)
 						continue;
@@ -1478,7 +1512,7 @@ int CServer::Run()
 		}
 	}
 	// disconnect all clients on shutdown
-	for(int i = 0; i < MAX_CLIENTS; ++i)
+	for(int i = 0; i < MaxClients(); ++i)
 	{
 		if(m_aClients[i].m_State != CClient::STATE_EMPTY && ! m_aClients[i].m_IsBot)
 			m_NetServer.Drop(i, "Server shutdown");
@@ -1512,7 +1546,7 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 	char aAddrStr[NETADDR_MAXSTRSIZE];
 	CServer* pThis = static_cast<CServer *>(pUser);
 
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < pThis->MaxClients(); i++)
 	{
 		if(pThis->m_aClients[i].m_State != CClient::STATE_EMPTY && ! pThis->m_aClients[i].m_IsBot)
 		{
@@ -1590,7 +1624,7 @@ void CServer::ConLogout(IConsole::IResult *pResult, void *pUser)
 {
 	CServer *pServer = (CServer *)pUser;
 
-	if(pServer->m_RconClientID >= 0 && pServer->m_RconClientID < MAX_CLIENTS &&
+	if(pServer->m_RconClientID >= 0 && pServer->m_RconClientID < pServer->MaxClients() &&
 		pServer->m_aClients[pServer->m_RconClientID].m_State != CServer::CClient::STATE_EMPTY)
 	{
 		CMsgPacker Msg(NETMSG_RCON_AUTH_STATUS);
@@ -1634,7 +1668,7 @@ void CServer::ConchainModCommandUpdate(IConsole::IResult *pResult, void *pUserDa
 		pfnCallback(pResult, pCallbackUserData);
 		if(pInfo && OldAccessLevel != pInfo->GetAccessLevel())
 		{
-			for(int i = 0; i < MAX_CLIENTS; ++i)
+			for(int i = 0; i < pThis->MaxClients(); ++i)
 			{
 				if(pThis->m_aClients[i].m_State == CServer::CClient::STATE_EMPTY || pThis->m_aClients[i].m_Authed != CServer::AUTHED_MOD ||
 					(pThis->m_aClients[i].m_pRconCmdToSend && str_comp(pResult->GetString(0), pThis->m_aClients[i].m_pRconCmdToSend->m_pName) >= 0))
@@ -1665,7 +1699,7 @@ void CServer::ConWhois(IConsole::IResult *pResult, void *pUser)
 {
 	CServer* pServer = (CServer *)pUser;
 	char aBuf[128];
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	for(int i = 0; i < pServer->MaxClients(); i++)
 	{
 		if(pServer->m_aClients[i].m_State == CServer::CClient::STATE_EMPTY || pServer->m_aClients[i].m_Authed == CServer::AUTHED_NO)
 			continue;
@@ -1676,6 +1710,68 @@ void CServer::ConWhois(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConNameBan(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	char aBuf[256];
+	const char *pName = pResult->GetString(0);
+	int Distance = pResult->NumArguments() > 1 ? pResult->GetInteger(1) : str_length(pName) / 3;
+	int IsSubstring = pResult->NumArguments() > 2 ? pResult->GetInteger(2) : 0;
+	const char *pReason = pResult->NumArguments() > 3 ? pResult->GetString(3) : "";
+
+	pThis->m_NameBanIndex.Invalidate();
+	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	{
+		CNameBan *pBan = &pThis->m_aNameBans[i];
+		if(str_comp(pBan->m_aName, pName) == 0)
+		{
+			str_format(aBuf, sizeof(aBuf), "changed name='%s' distance=%d old_distance=%d is_substring=%d old_is_substring=%d reason='%s' old_reason='%s'", pName, Distance, pBan->m_Distance, IsSubstring, pBan->m_IsSubstring, pReason, pBan->m_aReason);
+			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+			pBan->m_Distance = Distance;
+			pBan->m_IsSubstring = IsSubstring;
+			str_copy(pBan->m_aReason, pReason, sizeof(pBan->m_aReason));
+			return;
+		}
+	}
+
+	pThis->m_aNameBans.add(CNameBan(pName, Distance, IsSubstring, pReason));
+	str_format(aBuf, sizeof(aBuf), "added name='%s' distance=%d is_substring=%d reason='%s'", pName, Distance, IsSubstring, pReason);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+}
+
+void CServer::ConNameUnban(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	char aBuf[256];
+	const char *pName = pResult->GetString(0);
+
+	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	{
+		CNameBan *pBan = &pThis->m_aNameBans[i];
+		if(str_comp(pBan->m_aName, pName) == 0)
+		{
+			str_format(aBuf, sizeof(aBuf), "removed name='%s' distance=%d is_substring=%d reason='%s'", pBan->m_aName, pBan->m_Distance, pBan->m_IsSubstring, pBan->m_aReason);
+			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+			pThis->m_aNameBans.remove_index(i);
+			pThis->m_NameBanIndex.Invalidate();
+			return;
+		}
+	}
+}
+
+void CServer::ConNameBans(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	char aBuf[256];
+
+	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	{
+		CNameBan *pBan = &pThis->m_aNameBans[i];
+		str_format(aBuf, sizeof(aBuf), "name='%s' distance=%d is_substring=%d reason='%s'", pBan->m_aName, pBan->m_Distance, pBan->m_IsSubstring, pBan->m_aReason);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+	}
+}
+
 void CServer::RegisterCommands()
 {
 	m_pConsole = Kernel()->RequestInterface<IConsole>();
@@ -1695,6 +1791,10 @@ void CServer::RegisterCommands()
 	Console()->Register("reload", "", CFGFLAG_SERVER, ConMapReload, this, "Reload the map");
 	Console()->Register("whois", "", CFGFLAG_SERVER, ConWhois, this, "Show which player is authed");
 
+	Console()->Register("name_ban", "s?iir", CFGFLAG_SERVER, ConNameBan, this, "Ban a certain nickname");
+	Console()->Register("name_unban", "s", CFGFLAG_SERVER, ConNameUnban, this, "Unban a certain nickname");
+	Console()->Register("name_bans", "", CFGFLAG_SERVER, ConNameBans, this, "List all name bans");
+
 	Console()->Chain("sv_name", ConchainSpecialInfoupdate, this);
 	Console()->Chain("password", ConchainSpecialInfoupdate, this);
 
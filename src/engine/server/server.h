@@ -132,7 +132,8 @@ public:
 		void Reset();
 	};
 
-	CClient m_aClients[MAX_CLIENTS];
+	// sv_max_clients entries, allocated when the server starts
+	CClient *m_aClients;
 
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
@@ -164,8 +165,10 @@ public:
 	CMapChecker m_MapChecker;
 
 	array<CNameBan> m_aNameBans;
+	CNameBanIndex m_NameBanIndex;
 
 	CServer();
+	~CServer();
 
 	int TrySetClientName(int ClientID, const char *pName);
 
@@ -184,11 +187,13 @@ public:
 	//int TickSpeed()
 
 	int Init();
+	void AllocClients();
 
 	void SetRconCID(int ClientID);
 	int IsAuthed(int ClientID);
 	int GetClientInfo(int ClientID, CClientInfo *pInfo);
 	void GetClientAddr(int ClientID, char *pAddrStr, int Size);
+	bool GetClientAddr(int ClientID, NETADDR *pAddr);
 	const char *ClientName(int ClientID);
 	const char *ClientClan(int ClientID);
 	int ClientCountry(int ClientID);
@@ -241,6 +246,9 @@ public:
 	static void ConchainConsoleOutputLevelUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	//
 	static void ConWhois(IConsole::IResult *pResult, void *pUser);
+	static void ConNameBan(IConsole::IResult *pResult, void *pUser);
+	static void ConNameUnban(IConsole::IResult *pResult, void *pUser);
+	static void ConNameBans(IConsole::IResult *pResult, void *pUser);
 
 	void RegisterCommands();
 
@@ -60,12 +60,47 @@ const unsigned char *CVariableInt::Unpack(const unsigned char *pSrc, int *pInOut
 }
 
 
+// both work on 8 values at once while they fit into a single byte each, which
+// is the common case for snapshot deltas. The output is the same as packing
+// and unpacking the values one by one
 long CVariableInt::Decompress(const void *pSrc_, int SrcSize, void *pDst_, int DstSize)
 {
 	const unsigned char *pSrc = (unsigned char *)pSrc_;
 	const unsigned char *pEnd = pSrc + SrcSize;
 	int *pDst = (int *)pDst_;
 	int *pDstEnd = pDst + DstSize/4;
+
+	while(pEnd - pSrc >= 8 && pDstEnd - pDst >= 8)
+	{
+		uint64 Word = (uint64)pSrc[0] | ((uint64)pSrc[1]<<8) | ((uint64)pSrc[2]<<16) | ((uint64)pSrc[3]<<24) |
+			((uint64)pSrc[4]<<32) | ((uint64)pSrc[5]<<40) | ((uint64)pSrc[6]<<48) | ((uint64)pSrc[7]<<56);
+
+		// decode all bytes as single byte values, the ones after a long value get overwritten later
+		uint64 Signs = (Word>>6)&0x0101010101010101ull;
+		uint64 Values = (Word&0x3F3F3F3F3F3F3F3Full) ^ (Signs*0x3F);
+		pDst[0] = (int)(Values&0xFF) - (int)(Signs&1)*64;
+		pDst[1] = (int)((Values>>8)&0xFF) - (int)((Signs>>8)&1)*64;
+		pDst[2] = (int)((Values>>16)&0xFF) - (int)((Signs>>16)&1)*64;
+		pDst[3] = (int)((Values>>24)&0xFF) - (int)((Signs>>24)&1)*64;
+		pDst[4] = (int)((Values>>32)&0xFF) - (int)((Signs>>32)&1)*64;
+		pDst[5] = (int)((Values>>40)&0xFF) - (int)((Signs>>40)&1)*64;
+		pDst[6] = (int)((Values>>48)&0xFF) - (int)((Signs>>48)&1)*64;
+		pDst[7] = (int)((Values>>56)&0xFF) - (int)((Signs>>56)&1)*64;
+
+		uint64 Extended = Word&0x8080808080808080ull;
+		if(!Extended)
+		{
+			pSrc += 8;
+			pDst += 8;
+			continue;
+		}
+
+		// number of single byte values in front of the first long one, which starts inside of the 8 bytes
+		int Singles = (int)((((Extended&(~Extended+1))>>7)*0x0001020304050607ull)>>56);
+		pSrc = CVariableInt::Unpack(pSrc + Singles, pDst + Singles);
+		pDst += Singles + 1;
+	}
+
 	while(pSrc < pEnd)
 	{
 		if(pDst >= pDstEnd)
@@ -82,6 +117,25 @@ long CVariableInt::Compress(const void *pSrc_, int SrcSize, void *pDst_, int Dst
 	unsigned char *pDst = (unsigned char *)pDst_;
 	unsigned char *pDstEnd = pDst + DstSize;
 	SrcSize /= 4;
+
+	// every value checks for 6 free bytes, so 8 single byte values need 13
+	while(SrcSize >= 8 && pDstEnd - pDst >= 13)
+	{
+		int i = 0;
+		for(; i < 8 && (unsigned)pSrc[i]+64 < 128; i++)
+			pDst[i] = ((pSrc[i]>>25)&0x40) | ((pSrc[i]^(pSrc[i]>>31))&0x3F);
+		pDst += i;
+		pSrc += i;
+		SrcSize -= i;
+
+		if(i < 8)
+		{
+			pDst = CVariableInt::Pack(pDst, *pSrc);
+			SrcSize--;
+			pSrc++;
+		}
+	}
+
 	while(SrcSize)
 	{
 		if(pDstEnd - pDst < 6)
@@ -92,4 +146,3 @@ long CVariableInt::Compress(const void *pSrc_, int SrcSize, void *pDst_, int Dst
 	}
 	return (long)(pDst-(unsigned char *)pDst_);
 }
-
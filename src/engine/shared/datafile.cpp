@@ -4,6 +4,7 @@
 #include <base/system.h>
 #include <engine/storage.h>
 #include "datafile.h"
+#include "jobs.h"
 #include <zlib.h>
 
 static const int DEBUG=0;
@@ -58,15 +59,32 @@ struct CDatafileInfo
 struct CDatafile
 {
 	IOHANDLE m_File;
+	unsigned char *m_pFileData; // the whole file if it could be mapped
+	unsigned m_FileSize;
 	unsigned m_Crc;
 	CDatafileInfo m_Info;
 	CDatafileHeader m_Header;
 	int m_DataStartOffset;
 	char **m_ppDataPtrs;
+	char *m_pDataFlags;
 	char *m_pData;
 };
 
-bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType)
+enum
+{
+	DATAFLAG_OWNED=1, // allocated, otherwise it points into the mapped file
+	DATAFLAG_SWAPPED=2,
+	DATAFLAG_QUEUED=4,
+};
+
+struct CDataFileReader::CLoadJob
+{
+	CJob m_Job;
+	CDataFileReader *m_pReader;
+	int m_Index;
+};
+
+bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType, CJobPool *pJobPool)
 {
 	dbg_msg("datafile", "loading. filename='%s'", pFilename);
 
@@ -77,9 +95,15 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		return false;
 	}
 
+	// map the file if possible, the data can then be used without reading it
+	unsigned FileSize = 0;
+	unsigned char *pFileData = (unsigned char *)io_map(File, &FileSize);
 
 	// take the CRC of the file and store it
 	unsigned Crc = 0;
+	if(pFileData)
+		Crc = crc32(Crc, pFileData, FileSize); // ignore_convention
+	else
 	{
 		enum
 		{
@@ -102,12 +126,20 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 
 	// TODO: change this header
 	CDatafileHeader Header;
-	io_read(File, &Header, sizeof(Header));
+	if(pFileData)
+	{
+		mem_zero(&Header, sizeof(Header));
+		mem_copy(&Header, pFileData, min((unsigned)sizeof(Header), FileSize));
+	}
+	else
+		io_read(File, &Header, sizeof(Header));
 	if(Header.m_aID[0] != 'A' || Header.m_aID[1] != 'T' || Header.m_aID[2] != 'A' || Header.m_aID[3] != 'D')
 	{
 		if(Header.m_aID[0] != 'D' || Header.m_aID[1] != 'A' || Header.m_aID[2] != 'T' || Header.m_aID[3] != 'A')
 		{
 			dbg_msg("datafile", "wrong signature. %x %x %x %x", Header.m_aID[0], Header.m_aID[1], Header.m_aID[2], Header.m_aID[3]);
+			io_unmap(pFileData, FileSize);
+			io_close(File);
 			return 0;
 		}
 	}
@@ -118,6 +150,8 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	if(Header.m_Version != 3 && Header.m_Version != 4)
 	{
 		dbg_msg("datafile", "wrong version. version=%x", Header.m_Version);
+		io_unmap(pFileData, FileSize);
+		io_close(File);
 		return 0;
 	}
 
@@ -132,22 +166,36 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	unsigned AllocSize = Size;
 	AllocSize += sizeof(CDatafile); // add space for info structure
 	AllocSize += Header.m_NumRawData*sizeof(void*); // add space for data pointers
+	AllocSize += Header.m_NumRawData; // add space for data flags
 
 	CDatafile *pTmpDataFile = (CDatafile*)mem_alloc(AllocSize, 1);
 	pTmpDataFile->m_Header = Header;
 	pTmpDataFile->m_DataStartOffset = sizeof(CDatafileHeader) + Size;
 	pTmpDataFile->m_ppDataPtrs = (char**)(pTmpDataFile+1);
 	pTmpDataFile->m_pData = (char *)(pTmpDataFile+1)+Header.m_NumRawData*sizeof(char *);
+	pTmpDataFile->m_pDataFlags = pTmpDataFile->m_pData+Size;
 	pTmpDataFile->m_File = File;
+	pTmpDataFile->m_pFileData = pFileData;
+	pTmpDataFile->m_FileSize = FileSize;
 	pTmpDataFile->m_Crc = Crc;
 
 	// clear the data pointers
 	mem_zero(pTmpDataFile->m_ppDataPtrs, Header.m_NumRawData*sizeof(void*));
+	mem_zero(pTmpDataFile->m_pDataFlags, Header.m_NumRawData);
 
 	// read types, offsets, sizes and item data
-	unsigned ReadSize = io_read(File, pTmpDataFile->m_pData, Size);
+	unsigned ReadSize = 0;
+	if(pFileData)
+	{
+		if(FileSize >= sizeof(CDatafileHeader) && Size <= FileSize-sizeof(CDatafileHeader))
+			ReadSize = Size;
+		mem_copy(pTmpDataFile->m_pData, pFileData+sizeof(CDatafileHeader), ReadSize);
+	}
+	else
+		ReadSize = io_read(File, pTmpDataFile->m_pData, Size);
 	if(ReadSize != Size)
 	{
+		io_unmap(pTmpDataFile->m_pFileData, pTmpDataFile->m_FileSize);
 		io_close(pTmpDataFile->m_File);
 		mem_free(pTmpDataFile);
 		pTmpDataFile = 0;
@@ -155,8 +203,16 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		return false;
 	}
 
+	// the mapping stays valid without the file
+	if(pFileData)
+	{
+		io_close(File);
+		pTmpDataFile->m_File = 0;
+	}
+
 	Close();
 	m_pDataFile = pTmpDataFile;
+	m_pJobPool = pJobPool;
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
 	swap_endian(m_pDataFile->m_pData, sizeof(int), min(static_cast<unsigned>(Header.m_Swaplen), Size) / sizeof(int));
@@ -181,7 +237,17 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		m_pDataFile->m_Info.m_pItemStart = (char *)&m_pDataFile->m_Info.m_pDataOffsets[m_pDataFile->m_Header.m_NumRawData];
 	m_pDataFile->m_Info.m_pDataStart = m_pDataFile->m_Info.m_pItemStart + m_pDataFile->m_Header.m_ItemSize;
 
-	dbg_msg("datafile", "loading done. datafile='%s'", pFilename);
+	dbg_msg("datafile", "loading done. datafile='%s' mapped=%d", pFilename, m_pDataFile->m_pFileData != 0);
+
+	// decompress everything in parallel right away
+	if(m_pJobPool && m_pDataFile->m_Header.m_NumRawData)
+	{
+		int *pIndices = (int *)mem_alloc(m_pDataFile->m_Header.m_NumRawData*sizeof(int), 1);
+		for(int i = 0; i < m_pDataFile->m_Header.m_NumRawData; i++)
+			pIndices[i] = i;
+		Prefetch(pIndices, m_pDataFile->m_Header.m_NumRawData);
+		mem_free(pIndices);
+	}
 
 	if(DEBUG)
 	{
@@ -264,57 +330,139 @@ int CDataFileReader::GetDataSize(int Index)
 	return m_pDataFile->m_Info.m_pDataOffsets[Index+1]-m_pDataFile->m_Info.m_pDataOffsets[Index];
 }
 
-void *CDataFileReader::GetDataImpl(int Index, int Swap)
+void CDataFileReader::LoadData(int Index)
 {
-	if(!m_pDataFile) { return 0; }
+	// fetch the data size
+	int DataSize = GetDataSize(Index);
 
-	// load it if needed
-	if(!m_pDataFile->m_ppDataPtrs[Index])
+	// find the data in the mapped file
+	const unsigned char *pSource = 0;
+	if(m_pDataFile->m_pFileData)
 	{
-		// fetch the data size
-		int DataSize = GetDataSize(Index);
-#if defined(CONF_ARCH_ENDIAN_BIG)
-		int SwapSize = DataSize;
-#endif
-
-		if(m_pDataFile->m_Header.m_Version == 4)
+		unsigned Offset = m_pDataFile->m_DataStartOffset+m_pDataFile->m_Info.m_pDataOffsets[Index];
+		if(DataSize < 0 || Offset > m_pDataFile->m_FileSize || (unsigned)DataSize > m_pDataFile->m_FileSize-Offset)
 		{
-			// v4 has compressed data
-			void *pTemp = (char *)mem_alloc(DataSize, 1);
-			unsigned long UncompressedSize = m_pDataFile->m_Info.m_pDataSizes[Index];
-			unsigned long s;
+			dbg_msg("datafile", "data out of bounds. index=%d", Index);
+			return;
+		}
+		pSource = m_pDataFile->m_pFileData+Offset;
+	}
 
-			dbg_msg("datafile", "loading data index=%d size=%d uncompressed=%ld", Index, DataSize, UncompressedSize);
-			m_pDataFile->m_ppDataPtrs[Index] = (char *)mem_alloc(UncompressedSize, 1);
+	if(m_pDataFile->m_Header.m_Version == 4)
+	{
+		// v4 has compressed data
+		void *pTemp = 0;
+		unsigned long UncompressedSize = m_pDataFile->m_Info.m_pDataSizes[Index];
+		unsigned long s;
 
-			// read the compressed data
+		dbg_msg("datafile", "loading data index=%d size=%d uncompressed=%ld", Index, DataSize, UncompressedSize);
+		char *pData = (char *)mem_alloc(UncompressedSize, 1);
+
+		// read the compressed data
+		if(!pSource)
+		{
+			pTemp = mem_alloc(DataSize, 1);
 			io_seek(m_pDataFile->m_File, m_pDataFile->m_DataStartOffset+m_pDataFile->m_Info.m_pDataOffsets[Index], IOSEEK_START);
 			io_read(m_pDataFile->m_File, pTemp, DataSize);
+			pSource = (const unsigned char *)pTemp;
+		}
 
-			// decompress the data, TODO: check for errors
-			s = UncompressedSize;
-			uncompress((Bytef*)m_pDataFile->m_ppDataPtrs[Index], &s, (Bytef*)pTemp, DataSize); // ignore_convention
-#if defined(CONF_ARCH_ENDIAN_BIG)
-			SwapSize = s;
-#endif
+		// decompress the data, TODO: check for errors
+		s = UncompressedSize;
+		uncompress((Bytef*)pData, &s, (const Bytef*)pSource, DataSize); // ignore_convention
 
-			// clean up the temporary buffers
-			mem_free(pTemp);
-		}
-		else
+		// clean up the temporary buffers
+		mem_free(pTemp);
+
+		m_pDataFile->m_pDataFlags[Index] |= DATAFLAG_OWNED;
+		m_pDataFile->m_ppDataPtrs[Index] = pData;
+	}
+	else if(pSource)
+	{
+		// uncompressed data is used right from the mapped file
+		m_pDataFile->m_ppDataPtrs[Index] = (char *)pSource;
+	}
+	else
+	{
+		// load the data
+		dbg_msg("datafile", "loading data index=%d size=%d", Index, DataSize);
+		m_pDataFile->m_pDataFlags[Index] |= DATAFLAG_OWNED;
+		m_pDataFile->m_ppDataPtrs[Index] = (char *)mem_alloc(DataSize, 1);
+		io_seek(m_pDataFile->m_File, m_pDataFile->m_DataStartOffset+m_pDataFile->m_Info.m_pDataOffsets[Index], IOSEEK_START);
+		io_read(m_pDataFile->m_File, m_pDataFile->m_ppDataPtrs[Index], DataSize);
+	}
+}
+
+int CDataFileReader::LoadJob(void *pUser)
+{
+	CLoadJob *pJob = static_cast<CLoadJob *>(pUser);
+	pJob->m_pReader->LoadData(pJob->m_Index);
+	return 0;
+}
+
+void CDataFileReader::Prefetch(const int *pIndices, int Num)
+{
+	if(!m_pDataFile) { return; }
+
+	// the file handle can't be shared between jobs and uncompressed
+	// data doesn't need any work, so only decompress in parallel
+	bool Parallel = m_pJobPool && m_pDataFile->m_pFileData && m_pDataFile->m_Header.m_Version == 4;
+
+	CLoadJob *pJobs = Parallel ? new CLoadJob[Num] : 0;
+	CJobGroup Group;
+	for(int i = 0; i < Num; i++)
+	{
+		int Index = pIndices[i];
+		if(Index < 0 || Index >= m_pDataFile->m_Header.m_NumRawData || m_pDataFile->m_ppDataPtrs[Index] ||
+			(m_pDataFile->m_pDataFlags[Index]&DATAFLAG_QUEUED))
+			continue;
+
+		if(Parallel)
 		{
-			// load the data
-			dbg_msg("datafile", "loading data index=%d size=%d", Index, DataSize);
-			m_pDataFile->m_ppDataPtrs[Index] = (char *)mem_alloc(DataSize, 1);
-			io_seek(m_pDataFile->m_File, m_pDataFile->m_DataStartOffset+m_pDataFile->m_Info.m_pDataOffsets[Index], IOSEEK_START);
-			io_read(m_pDataFile->m_File, m_pDataFile->m_ppDataPtrs[Index], DataSize);
+			m_pDataFile->m_pDataFlags[Index] |= DATAFLAG_QUEUED;
+			pJobs[i].m_pReader = this;
+			pJobs[i].m_Index = Index;
+			m_pJobPool->Add(&pJobs[i].m_Job, LoadJob, &pJobs[i], &Group);
 		}
+		else
+			LoadData(Index);
+	}
+
+	if(Parallel)
+	{
+		m_pJobPool->Wait(&Group);
+		for(int i = 0; i < Num; i++)
+			if(pIndices[i] >= 0 && pIndices[i] < m_pDataFile->m_Header.m_NumRawData)
+				m_pDataFile->m_pDataFlags[pIndices[i]] &= ~DATAFLAG_QUEUED;
+		delete[] pJobs;
+	}
+}
+
+int CDataFileReader::GetUncompressedDataSize(int Index)
+{
+	if(!m_pDataFile) { return 0; }
+
+	if(m_pDataFile->m_Header.m_Version == 4)
+		return m_pDataFile->m_Info.m_pDataSizes[Index];
+	return GetDataSize(Index);
+}
+
+void *CDataFileReader::GetDataImpl(int Index, int Swap)
+{
+	if(!m_pDataFile) { return 0; }
+
+	// load it if needed
+	if(!m_pDataFile->m_ppDataPtrs[Index])
+		LoadData(Index);
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
-		if(Swap && SwapSize)
-			swap_endian(m_pDataFile->m_ppDataPtrs[Index], sizeof(int), SwapSize/sizeof(int));
-#endif
+	if(Swap && m_pDataFile->m_ppDataPtrs[Index] && !(m_pDataFile->m_pDataFlags[Index]&DATAFLAG_SWAPPED))
+	{
+		int SwapSize = m_pDataFile->m_Header.m_Version == 4 ? m_pDataFile->m_Info.m_pDataSizes[Index] : GetDataSize(Index);
+		swap_endian(m_pDataFile->m_ppDataPtrs[Index], sizeof(int), SwapSize/sizeof(int));
+		m_pDataFile->m_pDataFlags[Index] |= DATAFLAG_SWAPPED;
 	}
+#endif
 
 	return m_pDataFile->m_ppDataPtrs[Index];
 }
@@ -335,8 +483,10 @@ void CDataFileReader::UnloadData(int Index)
 		return;
 
 	//
-	mem_free(m_pDataFile->m_ppDataPtrs[Index]);
+	if(m_pDataFile->m_pDataFlags[Index]&DATAFLAG_OWNED)
+		mem_free(m_pDataFile->m_ppDataPtrs[Index]);
 	m_pDataFile->m_ppDataPtrs[Index] = 0x0;
+	m_pDataFile->m_pDataFlags[Index] = 0;
 }
 
 int CDataFileReader::GetItemSize(int Index)
@@ -408,9 +558,14 @@ bool CDataFileReader::Close()
 	// free the data that is loaded
 	int i;
 	for(i = 0; i < m_pDataFile->m_Header.m_NumRawData; i++)
-		mem_free(m_pDataFile->m_ppDataPtrs[i]);
+	{
+		if(m_pDataFile->m_pDataFlags[i]&DATAFLAG_OWNED)
+			mem_free(m_pDataFile->m_ppDataPtrs[i]);
+	}
 
-	io_close(m_pDataFile->m_File);
+	io_unmap(m_pDataFile->m_pFileData, m_pDataFile->m_FileSize);
+	if(m_pDataFile->m_File)
+		io_close(m_pDataFile->m_File);
 	mem_free(m_pDataFile);
 	m_pDataFile = 0;
 	return true;
@@ -426,6 +581,8 @@ unsigned CDataFileReader::Crc()
 CDataFileWriter::CDataFileWriter()
 {
 	m_File = 0;
+	m_Compression = COMPRESSION_DEFAULT;
+	m_pJobPool = 0;
 	m_pItemTypes = static_cast<CItemTypeInfo *>(mem_alloc(sizeof(CItemTypeInfo) * MAX_ITEM_TYPES, 1));
 	m_pItems = static_cast<CItemInfo *>(mem_alloc(sizeof(CItemInfo) * MAX_ITEMS, 1));
 	m_pDatas = static_cast<CDataInfo *>(mem_alloc(sizeof(CDataInfo) * MAX_DATAS, 1));
@@ -433,6 +590,24 @@ CDataFileWriter::CDataFileWriter()
 
 CDataFileWriter::~CDataFileWriter()
 {
+	// the jobs still use the data infos
+	if(m_pJobPool)
+		m_pJobPool->Wait(&m_CompressGroup);
+
+	// Finish frees the buffers and closes the file, without it they are still here
+	if(m_File)
+	{
+		for(int i = 0; i < m_NumItems; i++)
+			mem_free(m_pItems[i].m_pData);
+		for(int i = 0; i < m_NumDatas; i++)
+		{
+			mem_free(m_pDatas[i].m_pUncompressedData);
+			mem_free(m_pDatas[i].m_pCompressedData);
+		}
+		io_close(m_File);
+		m_File = 0;
+	}
+
 	mem_free(m_pItemTypes);
 	m_pItemTypes = 0;
 	mem_free(m_pItems);
@@ -441,13 +616,17 @@ CDataFileWriter::~CDataFileWriter()
 	m_pDatas = 0;
 }
 
-bool CDataFileWriter::Open(class IStorage *pStorage, const char *pFilename)
+bool CDataFileWriter::Open(class IStorage *pStorage, const char *pFilename, int Compression, CJobPool *pJobPool)
 {
 	dbg_assert(!m_File, "a file already exists");
+	dbg_assert(Compression >= COMPRESSION_STORE && Compression <= COMPRESSION_BEST, "incorrect compression level");
 	m_File = pStorage->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
 	if(!m_File)
 		return false;
 
+	m_Compression = Compression;
+	m_pJobPool = Compression == COMPRESSION_STORE ? 0 : pJobPool;
+
 	m_NumItems = 0;
 	m_NumDatas = 0;
 	m_NumItemTypes = 0;
@@ -498,6 +677,24 @@ int CDataFileWriter::AddItem(int Type, int ID, int Size, void *pData)
 	return m_NumItems-1;
 }
 
+int CDataFileWriter::CompressJob(void *pUser)
+{
+	CDataInfo *pInfo = static_cast<CDataInfo *>(pUser);
+	unsigned long s = compressBound(pInfo->m_UncompressedSize);
+	void *pCompData = mem_alloc(s, 1);
+
+	int Result = compress2((Bytef*)pCompData, &s, (Bytef*)pInfo->m_pUncompressedData, pInfo->m_UncompressedSize, pInfo->m_Level); // ignore_convention
+	if(Result != Z_OK)
+	{
+		dbg_msg("datafile", "compression error %d", Result);
+		dbg_assert(0, "zlib error");
+	}
+
+	pInfo->m_CompressedSize = (int)s;
+	pInfo->m_pCompressedData = pCompData;
+	return 0;
+}
+
 int CDataFileWriter::AddData(int Size, void *pData)
 {
 	if(!m_File) return 0;
@@ -505,21 +702,30 @@ int CDataFileWriter::AddData(int Size, void *pData)
 	dbg_assert(m_NumDatas < 1024, "too much data");
 
 	CDataInfo *pInfo = &m_pDatas[m_NumDatas];
-	unsigned long s = compressBound(Size);
-	void *pCompData = mem_alloc(s, 1); // temporary buffer that we use during compression
+	pInfo->m_UncompressedSize = Size;
+	pInfo->m_Level = m_Compression;
 
-	int Result = compress((Bytef*)pCompData, &s, (Bytef*)pData, Size); // ignore_convention
-	if(Result != Z_OK)
+	if(m_Compression == COMPRESSION_STORE)
 	{
-		dbg_msg("datafile", "compression error %d", Result);
-		dbg_assert(0, "zlib error");
+		// stored as it is
+		pInfo->m_pUncompressedData = 0;
+		pInfo->m_CompressedSize = Size;
+		pInfo->m_pCompressedData = mem_alloc(Size, 1);
+		mem_copy(pInfo->m_pCompressedData, pData, Size);
+	}
+	else if(m_pJobPool)
+	{
+		// the caller may free the data right away, so compress a copy
+		pInfo->m_pUncompressedData = mem_alloc(Size, 1);
+		mem_copy(pInfo->m_pUncompressedData, pData, Size);
+		m_pJobPool->Add(&pInfo->m_Job, CompressJob, pInfo, &m_CompressGroup);
+	}
+	else
+	{
+		pInfo->m_pUncompressedData = pData;
+		CompressJob(pInfo);
+		pInfo->m_pUncompressedData = 0;
 	}
-
-	pInfo->m_UncompressedSize = Size;
-	pInfo->m_CompressedSize = (int)s;
-	pInfo->m_pCompressedData = mem_alloc(pInfo->m_CompressedSize, 1);
-	mem_copy(pInfo->m_pCompressedData, pCompData, pInfo->m_CompressedSize);
-	mem_free(pCompData);
 
 	m_NumDatas++;
 	return m_NumDatas-1;
@@ -551,6 +757,17 @@ int CDataFileWriter::Finish()
 	int DataSize = 0;
 	CDatafileHeader Header;
 
+	// wait for the data that is still being compressed
+	if(m_pJobPool)
+	{
+		m_pJobPool->Wait(&m_CompressGroup);
+		for(int i = 0; i < m_NumDatas; i++)
+		{
+			mem_free(m_pDatas[i].m_pUncompressedData);
+			m_pDatas[i].m_pUncompressedData = 0;
+		}
+	}
+
 	// we should now write this file!
 	if(DEBUG)
 		dbg_msg("datafile", "writing");
@@ -570,7 +787,9 @@ int CDataFileWriter::Finish()
 	// calculate the complete size
 	TypesSize = m_NumItemTypes*sizeof(CDatafileItemType);
 	HeaderSize = sizeof(CDatafileHeader);
-	OffsetSize = (m_NumItems + m_NumDatas + m_NumDatas) * sizeof(int); // ItemOffsets, DataOffsets, DataUncompressedSizes
+	OffsetSize = (m_NumItems + m_NumDatas) * sizeof(int); // ItemOffsets, DataOffsets
+	if(m_Compression != COMPRESSION_STORE)
+		OffsetSize += m_NumDatas * sizeof(int); // DataUncompressedSizes, version 3 doesn't have them
 	FileSize = HeaderSize + TypesSize + OffsetSize + ItemSize + DataSize;
 	SwapSize = FileSize - DataSize;
 
@@ -585,7 +804,7 @@ int CDataFileWriter::Finish()
 		Header.m_aID[1] = 'A';
 		Header.m_aID[2] = 'T';
 		Header.m_aID[3] = 'A';
-		Header.m_Version = 4;
+		Header.m_Version = m_Compression == COMPRESSION_STORE ? 3 : 4;
 		Header.m_Size = FileSize - 16;
 		Header.m_Swaplen = SwapSize - 16;
 		Header.m_NumItemTypes = m_NumItemTypes;
@@ -661,7 +880,7 @@ int CDataFileWriter::Finish()
 	}
 
 	// write data uncompressed sizes
-	for(int i = 0; i < m_NumDatas; i++)
+	for(int i = 0; i < m_NumDatas && m_Compression != COMPRESSION_STORE; i++)
 	{
 		if(DEBUG)
 			dbg_msg("datafile", "writing data uncompressed size num=%d size=%d", i, m_pDatas[i].m_UncompressedSize);
@@ -3,25 +3,38 @@
 #ifndef ENGINE_SHARED_DATAFILE_H
 #define ENGINE_SHARED_DATAFILE_H
 
+#include "jobs.h"
+
 // raw datafile access
 class CDataFileReader
 {
+	struct CLoadJob;
+
 	struct CDatafile *m_pDataFile;
+	class CJobPool *m_pJobPool;
+	void LoadData(int Index);
+	static int LoadJob(void *pUser);
 	void *GetDataImpl(int Index, int Swap);
 public:
-	CDataFileReader() : m_pDataFile(0) {}
+	CDataFileReader() : m_pDataFile(0), m_pJobPool(0) {}
 	~CDataFileReader() { Close(); }
 
 	bool IsOpen() const { return m_pDataFile != 0; }
 
-	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType);
+	// the file is memory mapped when possible. with a job pool all
+	// compressed data gets decompressed in parallel while opening
+	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType, class CJobPool *pJobPool = 0);
 	bool Close();
 
+	// loads the given data, in parallel when a job pool is set
+	void Prefetch(const int *pIndices, int Num);
+
 	static bool GetCrcSize(class IStorage *pStorage, const char *pFilename, int StorageType, unsigned *pCrc, unsigned *pSize);
 
 	void *GetData(int Index);
 	void *GetDataSwapped(int Index); // makes sure that the data is 32bit LE ints when saved
 	int GetDataSize(int Index);
+	int GetUncompressedDataSize(int Index);
 	void UnloadData(int Index);
 	void *GetItem(int Index, int *pType, int *pID);
 	int GetItemSize(int Index);
@@ -42,6 +55,11 @@ class CDataFileWriter
 		int m_UncompressedSize;
 		int m_CompressedSize;
 		void *m_pCompressedData;
+
+		// only used while it is compressed on the job pool
+		void *m_pUncompressedData;
+		int m_Level;
+		CJob m_Job;
 	};
 
 	struct CItemInfo
@@ -76,10 +94,26 @@ class CDataFileWriter
 	CItemInfo *m_pItems;
 	CDataInfo *m_pDatas;
 
+	int m_Compression;
+	CJobPool *m_pJobPool;
+	CJobGroup m_CompressGroup;
+
+	static int CompressJob(void *pUser);
+
 public:
+	enum
+	{
+		COMPRESSION_STORE=-2, // no compression, writes a version 3 file the reader can map
+		COMPRESSION_DEFAULT=-1,
+		COMPRESSION_FASTEST=1,
+		COMPRESSION_BEST=9,
+	};
+
 	CDataFileWriter();
 	~CDataFileWriter();
-	bool Open(class IStorage *pStorage, const char *Filename);
+
+	// with a job pool the data gets compressed in parallel until Finish
+	bool Open(class IStorage *pStorage, const char *Filename, int Compression = COMPRESSION_DEFAULT, CJobPool *pJobPool = 0);
 	int AddData(int Size, void *pData);
 	int AddDataSwapped(int Size, void *pData);
 	int AddItem(int Type, int ID, int Size, void *pData);
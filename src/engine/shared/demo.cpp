@@ -7,6 +7,7 @@
 #include <engine/storage.h>
 
 #include "compression.h"
+#include "config.h"
 #include "demo.h"
 #include "memheap.h"
 #include "network.h"
@@ -18,6 +19,34 @@ static const unsigned char gs_OldVersion = 3;
 static const int gs_LengthOffset = 152;
 static const int gs_NumMarkersOffset = 176;
 
+/*
+	Keyframe index, written when the recording is stopped
+
+	It is stored in chunks of the otherwise unused type 0 at the end of
+	the demo, which older versions skip. Each chunk starts with an empty
+	huffman stream so it decompresses without errors, followed by the
+	raw keyframes (file position and tick). The last chunk ends with the
+	footer: marker, position of the first index chunk, number of
+	keyframes, first tick and last tick.
+*/
+static const unsigned char gs_aIndexMarker[8] = {'T', 'W', 'D', 'I', 'N', 'D', 'E', 'X'};
+static const int gs_IndexFooterSize = 24;
+static const int gs_IndexEntrySize = 8;
+static const int gs_MaxIndexChunkEntries = 4096;
+
+static void IndexPackInt(unsigned char *pDst, int Value)
+{
+	pDst[0] = (Value>>24)&0xff;
+	pDst[1] = (Value>>16)&0xff;
+	pDst[2] = (Value>>8)&0xff;
+	pDst[3] = (Value)&0xff;
+}
+
+static int IndexUnpackInt(const unsigned char *pSrc)
+{
+	return (pSrc[0]<<24) | (pSrc[1]<<16) | (pSrc[2]<<8) | pSrc[3];
+}
+
 
 CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta)
 {
@@ -107,9 +136,11 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	io_close(MapFile);
 
 	m_LastKeyFrame = -1;
+	m_KeyFrameInterval = g_Config.m_DemoKeyframeInterval*SERVER_TICK_SPEED;
 	m_LastTickMarker = -1;
 	m_FirstTick = -1;
 	m_NumTimelineMarkers = 0;
+	m_aKeyFrames.clear();
 
 	char aBuf[256];
 	str_format(aBuf, sizeof(aBuf), "Recording to '%s'", pFilename);
@@ -140,6 +171,7 @@ enum
 	CHUNKMASK_TYPE = 0x60,
 	CHUNKMASK_SIZE = 0x1f,
 
+	CHUNKTYPE_INDEX = 0,
 	CHUNKTYPE_SNAPSHOT = 1,
 	CHUNKTYPE_MESSAGE = 2,
 	CHUNKTYPE_DELTA = 3,
@@ -159,8 +191,15 @@ void CDemoRecorder::WriteTickMarker(int Tick, int Keyframe)
 		aChunk[4] = (Tick)&0xff;
 
 		if(Keyframe)
+		{
 			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
 
+			CKeyFrame KeyFrame;
+			KeyFrame.m_Filepos = io_tell(m_File);
+			KeyFrame.m_Tick = Tick;
+			m_aKeyFrames.add(KeyFrame);
+		}
+
 		io_write(m_File, aChunk, sizeof(aChunk));
 	}
 	else
@@ -230,7 +269,7 @@ void CDemoRecorder::Write(int Type, const void *pData, int Size)
 
 void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 {
-	if(m_LastKeyFrame == -1 || (Tick-m_LastKeyFrame) > SERVER_TICK_SPEED*5)
+	if(m_LastKeyFrame == -1 || (Tick-m_LastKeyFrame) > m_KeyFrameInterval)
 	{
 		// write full tickmarker
 		WriteTickMarker(Tick, 1);
@@ -265,11 +304,60 @@ void CDemoRecorder::RecordMessage(const void *pData, int Size)
 	Write(CHUNKTYPE_MESSAGE, pData, Size);
 }
 
+void CDemoRecorder::WriteIndex()
+{
+	unsigned char aEmpty[8];
+	int EmptySize = CNetBase::Compress(0, 0, aEmpty, sizeof(aEmpty));
+	if(EmptySize < 0)
+		return;
+
+	long IndexStart = io_tell(m_File);
+	int NumKeyFrames = m_aKeyFrames.size();
+	int First = 0;
+	do
+	{
+		int Num = min(NumKeyFrames-First, gs_MaxIndexChunkEntries);
+		bool Last = First+Num == NumKeyFrames;
+		int Size = EmptySize + Num*gs_IndexEntrySize + (Last ? gs_IndexFooterSize : 0);
+
+		unsigned char aChunk[3];
+		aChunk[0] = ((CHUNKTYPE_INDEX&0x3)<<5) | 31;
+		aChunk[1] = Size&0xff;
+		aChunk[2] = Size>>8;
+		io_write(m_File, aChunk, sizeof(aChunk));
+		io_write(m_File, aEmpty, EmptySize);
+
+		for(int i = First; i < First+Num; i++)
+		{
+			unsigned char aEntry[gs_IndexEntrySize];
+			IndexPackInt(aEntry, m_aKeyFrames[i].m_Filepos);
+			IndexPackInt(aEntry+4, m_aKeyFrames[i].m_Tick);
+			io_write(m_File, aEntry, sizeof(aEntry));
+		}
+
+		if(Last)
+		{
+			unsigned char aFooter[gs_IndexFooterSize];
+			mem_copy(aFooter, gs_aIndexMarker, sizeof(gs_aIndexMarker));
+			IndexPackInt(aFooter+8, IndexStart);
+			IndexPackInt(aFooter+12, NumKeyFrames);
+			IndexPackInt(aFooter+16, m_FirstTick);
+			IndexPackInt(aFooter+20, m_LastTickMarker);
+			io_write(m_File, aFooter, sizeof(aFooter));
+		}
+
+		First += Num;
+	}
+	while(First < NumKeyFrames);
+}
+
 int CDemoRecorder::Stop()
 {
 	if(!m_File)
 		return -1;
 
+	WriteIndex();
+
 	// add the demo length to the header
 	io_seek(m_File, gs_LengthOffset, IOSEEK_START);
 	int DemoLength = Length();
@@ -328,7 +416,11 @@ void CDemoRecorder::AddDemoMarker()
 
 CDemoPlayer::CDemoPlayer(class CSnapshotDelta *pSnapshotDelta)
 {
-	m_File = 0;
+	m_pFileData = 0;
+	m_FileSize = 0;
+	m_FilePos = 0;
+	m_FileMapped = false;
+	m_SaveMap = true;
 	m_pKeyFrames = 0;
 
 	m_pSnapshotDelta = pSnapshotDelta;
@@ -343,13 +435,12 @@ void CDemoPlayer::SetListner(IListner *pListner)
 
 int CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
 {
-	unsigned char Chunk = 0;
-
 	*pSize = 0;
 	*pType = 0;
 
-	if(io_read(m_File, &Chunk, sizeof(Chunk)) != sizeof(Chunk))
+	if(m_FilePos >= m_FileSize)
 		return -1;
+	unsigned char Chunk = m_pFileData[m_FilePos++];
 
 	if(Chunk&CHUNKTYPEFLAG_TICKMARKER)
 	{
@@ -359,10 +450,11 @@ int CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
 
 		if(Tickdelta == 0)
 		{
-			unsigned char aTickdata[4];
-			if(io_read(m_File, aTickdata, sizeof(aTickdata)) != sizeof(aTickdata))
+			if(m_FileSize-m_FilePos < 4)
 				return -1;
-			*pTick = (aTickdata[0]<<24) | (aTickdata[1]<<16) | (aTickdata[2]<<8) | aTickdata[3];
+			const unsigned char *pTickdata = m_pFileData+m_FilePos;
+			*pTick = (pTickdata[0]<<24) | (pTickdata[1]<<16) | (pTickdata[2]<<8) | pTickdata[3];
+			m_FilePos += 4;
 		}
 		else
 		{
@@ -378,27 +470,91 @@ int CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
 
 		if(*pSize == 30)
 		{
-			unsigned char aSizedata[1];
-			if(io_read(m_File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
+			if(m_FileSize-m_FilePos < 1)
 				return -1;
-			*pSize = aSizedata[0];
-
+			*pSize = m_pFileData[m_FilePos];
+			m_FilePos += 1;
 		}
 		else if(*pSize == 31)
 		{
-			unsigned char aSizedata[2];
-			if(io_read(m_File, aSizedata, sizeof(aSizedata)) != sizeof(aSizedata))
+			if(m_FileSize-m_FilePos < 2)
 				return -1;
-			*pSize = (aSizedata[1]<<8) | aSizedata[0];
+			*pSize = (m_pFileData[m_FilePos+1]<<8) | m_pFileData[m_FilePos];
+			m_FilePos += 2;
 		}
 	}
 
 	return 0;
 }
 
+bool CDemoPlayer::ReadIndex()
+{
+	if(m_FileSize-m_DataStart < (unsigned)gs_IndexFooterSize)
+		return false;
+
+	const unsigned char *pFooter = m_pFileData+m_FileSize-gs_IndexFooterSize;
+	if(mem_comp(pFooter, gs_aIndexMarker, sizeof(gs_aIndexMarker)) != 0)
+		return false;
+
+	unsigned IndexStart = IndexUnpackInt(pFooter+8);
+	int NumKeyFrames = IndexUnpackInt(pFooter+12);
+	if(IndexStart < m_DataStart || IndexStart > m_FileSize-gs_IndexFooterSize ||
+		NumKeyFrames < 0 || NumKeyFrames > (int)((m_FileSize-IndexStart)/gs_IndexEntrySize))
+		return false;
+
+	unsigned char aEmpty[8];
+	int EmptySize = CNetBase::Compress(0, 0, aEmpty, sizeof(aEmpty));
+
+	CKeyFrame *pKeyFrames = (CKeyFrame*)mem_alloc(max(NumKeyFrames, 1)*sizeof(CKeyFrame), 1);
+	int NumRead = 0;
+	bool Valid = EmptySize >= 0;
+	m_FilePos = IndexStart;
+	while(Valid && NumRead < NumKeyFrames)
+	{
+		int ChunkType, ChunkSize, ChunkTick = 0;
+		if(ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick) || ChunkType != CHUNKTYPE_INDEX ||
+			ChunkSize <= EmptySize || (unsigned)ChunkSize > m_FileSize-m_FilePos)
+		{
+			Valid = false;
+			break;
+		}
+
+		const unsigned char *pEntry = m_pFileData+m_FilePos+EmptySize;
+		int Num = min((ChunkSize-EmptySize)/gs_IndexEntrySize, NumKeyFrames-NumRead);
+		for(int i = 0; i < Num; i++, pEntry += gs_IndexEntrySize)
+		{
+			pKeyFrames[NumRead+i].m_Filepos = IndexUnpackInt(pEntry);
+			pKeyFrames[NumRead+i].m_Tick = IndexUnpackInt(pEntry+4);
+		}
+		Valid = Num > 0;
+		NumRead += Num;
+		m_FilePos += ChunkSize;
+	}
+
+	// the keyframes have to point into the demo data in order
+	for(int i = 0; Valid && i < NumKeyFrames; i++)
+	{
+		if(pKeyFrames[i].m_Filepos < (long)m_DataStart || pKeyFrames[i].m_Filepos >= (long)IndexStart ||
+			(i > 0 && pKeyFrames[i].m_Tick < pKeyFrames[i-1].m_Tick))
+			Valid = false;
+	}
+
+	m_FilePos = m_DataStart;
+	if(!Valid)
+	{
+		mem_free(pKeyFrames);
+		return false;
+	}
+
+	m_pKeyFrames = pKeyFrames;
+	m_Info.m_SeekablePoints = NumKeyFrames;
+	m_Info.m_Info.m_FirstTick = IndexUnpackInt(pFooter+16);
+	m_Info.m_Info.m_LastTick = IndexUnpackInt(pFooter+20);
+	return true;
+}
+
 void CDemoPlayer::ScanFile()
 {
-	long StartPos;
 	CHeap Heap;
 	CKeyFrameSearch *pFirstKey = 0;
 	CKeyFrameSearch *pCurrentKey = 0;
@@ -406,12 +562,12 @@ void CDemoPlayer::ScanFile()
 	int ChunkSize, ChunkType, ChunkTick = 0;
 	int i;
 
-	StartPos = io_tell(m_File);
+	unsigned StartPos = m_FilePos;
 	m_Info.m_SeekablePoints = 0;
 
 	while(1)
 	{
-		long CurrentPos = io_tell(m_File);
+		long CurrentPos = m_FilePos;
 
 		if(ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick))
 			break;
@@ -441,7 +597,11 @@ void CDemoPlayer::ScanFile()
 			m_Info.m_Info.m_LastTick = ChunkTick;
 		}
 		else if(ChunkSize)
-			io_skip(m_File, ChunkSize);
+		{
+			if((unsigned)ChunkSize > m_FileSize-m_FilePos)
+				break;
+			m_FilePos += ChunkSize;
+		}
 
 	}
 
@@ -451,14 +611,11 @@ void CDemoPlayer::ScanFile()
 		m_pKeyFrames[i] = pCurrentKey->m_Frame;
 
 	// destroy the temporary heap and seek back to the start
-	io_seek(m_File, StartPos, IOSEEK_START);
+	m_FilePos = StartPos;
 }
 
 void CDemoPlayer::DoTick()
 {
-	static char aCompresseddata[CSnapshot::MAX_SIZE];
-	static char aDecompressed[CSnapshot::MAX_SIZE];
-	static char aData[CSnapshot::MAX_SIZE];
 	int ChunkType, ChunkTick, ChunkSize;
 	int DataSize = 0;
 	int GotSnapshot = 0;
@@ -487,15 +644,21 @@ void CDemoPlayer::DoTick()
 		// read the chunk
 		if(ChunkSize)
 		{
-			if(io_read(m_File, aCompresseddata, ChunkSize) != (unsigned)ChunkSize)
+			if((unsigned)ChunkSize > m_FileSize-m_FilePos)
 			{
 				// stop on error or eof
 				m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "demo_player", "error reading chunk");
 				Stop();
 				break;
 			}
+			const unsigned char *pChunkData = m_pFileData+m_FilePos;
+			m_FilePos += ChunkSize;
+
+			// the keyframe index is only needed when loading
+			if(ChunkType == CHUNKTYPE_INDEX)
+				continue;
 
-			DataSize = CNetBase::Decompress(aCompresseddata, ChunkSize, aDecompressed, sizeof(aDecompressed));
+			DataSize = CNetBase::Decompress(pChunkData, ChunkSize, m_aDecompressedData, sizeof(m_aDecompressedData));
 			if(DataSize < 0)
 			{
 				// stop on error or eof
@@ -504,7 +667,7 @@ void CDemoPlayer::DoTick()
 				break;
 			}
 
-			DataSize = CVariableInt::Decompress(aDecompressed, DataSize, aData, sizeof(aData));
+			DataSize = CVariableInt::Decompress(m_aDecompressedData, DataSize, m_aChunkData, sizeof(m_aChunkData));
 
 			if(DataSize < 0)
 			{
@@ -517,19 +680,17 @@ void CDemoPlayer::DoTick()
 		if(ChunkType == CHUNKTYPE_DELTA)
 		{
 			// process delta snapshot
-			static char aNewsnap[CSnapshot::MAX_SIZE];
-
 			GotSnapshot = 1;
 
-			DataSize = m_pSnapshotDelta->UnpackDelta((CSnapshot*)m_aLastSnapshotData, (CSnapshot*)aNewsnap, aData, DataSize);
+			DataSize = m_pSnapshotDelta->UnpackDelta((CSnapshot*)m_aLastSnapshotData, (CSnapshot*)m_aNewSnapshotData, m_aChunkData, DataSize);
 
 			if(DataSize >= 0)
 			{
 				if(m_pListner)
-					m_pListner->OnDemoPlayerSnapshot(aNewsnap, DataSize);
+					m_pListner->OnDemoPlayerSnapshot(m_aNewSnapshotData, DataSize);
 
 				m_LastSnapshotDataSize = DataSize;
-				mem_copy(m_aLastSnapshotData, aNewsnap, DataSize);
+				mem_copy(m_aLastSnapshotData, m_aNewSnapshotData, DataSize);
 			}
 			else
 			{
@@ -544,9 +705,9 @@ void CDemoPlayer::DoTick()
 			GotSnapshot = 1;
 
 			m_LastSnapshotDataSize = DataSize;
-			mem_copy(m_aLastSnapshotData, aData, DataSize);
+			mem_copy(m_aLastSnapshotData, m_aChunkData, DataSize);
 			if(m_pListner)
-				m_pListner->OnDemoPlayerSnapshot(aData, DataSize);
+				m_pListner->OnDemoPlayerSnapshot(m_aChunkData, DataSize);
 		}
 		else
 		{
@@ -566,7 +727,7 @@ void CDemoPlayer::DoTick()
 			else if(ChunkType == CHUNKTYPE_MESSAGE)
 			{
 				if(m_pListner)
-					m_pListner->OnDemoPlayerMessage(aData, DataSize);
+					m_pListner->OnDemoPlayerMessage(m_aChunkData, DataSize);
 			}
 		}
 	}
@@ -590,8 +751,8 @@ void CDemoPlayer::Unpause()
 int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType)
 {
 	m_pConsole = pConsole;
-	m_File = pStorage->OpenFile(pFilename, IOFLAG_READ, StorageType);
-	if(!m_File)
+	IOHANDLE File = pStorage->OpenFile(pFilename, IOFLAG_READ, StorageType);
+	if(!File)
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "could not open '%s'", pFilename);
@@ -599,6 +760,20 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 		return -1;
 	}
 
+	// map the whole file, read it into memory if that isn't possible
+	m_pFileData = (const unsigned char *)io_map(File, &m_FileSize);
+	m_FileMapped = m_pFileData != 0;
+	if(!m_FileMapped)
+	{
+		long Length = io_length(File);
+		m_FileSize = Length > 0 ? Length : 0;
+		unsigned char *pData = (unsigned char *)mem_alloc(max(m_FileSize, 1u), 1);
+		m_FileSize = io_read(File, pData, m_FileSize);
+		m_pFileData = pData;
+	}
+	io_close(File);
+	m_FilePos = 0;
+
 	// store the filename
 	str_copy(m_aFilename, pFilename, sizeof(m_aFilename));
 
@@ -614,28 +789,32 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 	m_LastSnapshotDataSize = -1;
 
 	// read the header
-	io_read(m_File, &m_Info.m_Header, sizeof(m_Info.m_Header));
-	if(mem_comp(m_Info.m_Header.m_aMarker, gs_aHeaderMarker, sizeof(gs_aHeaderMarker)) != 0)
+	if(m_FileSize < sizeof(m_Info.m_Header) ||
+		mem_comp(m_pFileData, gs_aHeaderMarker, sizeof(gs_aHeaderMarker)) != 0)
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "'%s' is not a demo file", pFilename);
 		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_player", aBuf);
-		io_close(m_File);
-		m_File = 0;
+		ReleaseFile();
 		return -1;
 	}
+	mem_copy(&m_Info.m_Header, m_pFileData, sizeof(m_Info.m_Header));
+	m_FilePos = sizeof(m_Info.m_Header);
 
 	if(m_Info.m_Header.m_Version < gs_OldVersion)
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "demo version %d is not supported", m_Info.m_Header.m_Version);
 		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_player", aBuf);
-		io_close(m_File);
-		m_File = 0;
+		ReleaseFile();
 		return -1;
 	}
 	else if(m_Info.m_Header.m_Version > gs_OldVersion)
-		io_read(m_File, &m_Info.m_TimelineMarkers, sizeof(m_Info.m_TimelineMarkers));
+	{
+		if(m_FileSize-m_FilePos >= sizeof(m_Info.m_TimelineMarkers))
+			mem_copy(&m_Info.m_TimelineMarkers, m_pFileData+m_FilePos, sizeof(m_Info.m_TimelineMarkers));
+		m_FilePos = min(m_FilePos+(unsigned)sizeof(m_Info.m_TimelineMarkers), m_FileSize);
+	}
 
 	// get demo type
 	if(!str_comp(m_Info.m_Header.m_aType, "client"))
@@ -647,33 +826,29 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 
 	// read map
 	unsigned MapSize = (m_Info.m_Header.m_aMapSize[0]<<24) | (m_Info.m_Header.m_aMapSize[1]<<16) | (m_Info.m_Header.m_aMapSize[2]<<8) | (m_Info.m_Header.m_aMapSize[3]);
+	MapSize = min(MapSize, m_FileSize-m_FilePos);
 
 	// check if we already have the map
 	// TODO: improve map checking (maps folder, check crc)
 	unsigned Crc = (m_Info.m_Header.m_aMapCrc[0]<<24) | (m_Info.m_Header.m_aMapCrc[1]<<16) | (m_Info.m_Header.m_aMapCrc[2]<<8) | (m_Info.m_Header.m_aMapCrc[3]);
 	char aMapFilename[128];
 	str_format(aMapFilename, sizeof(aMapFilename), "downloadedmaps/%s_%08x.map", m_Info.m_Header.m_aMapName, Crc);
-	IOHANDLE MapFile = pStorage->OpenFile(aMapFilename, IOFLAG_READ, IStorage::TYPE_ALL);
+	IOHANDLE MapFile = m_SaveMap ? pStorage->OpenFile(aMapFilename, IOFLAG_READ, IStorage::TYPE_ALL) : 0;
 
 	if(MapFile)
-	{
-		io_skip(m_File, MapSize);
 		io_close(MapFile);
-	}
-	else if(MapSize > 0)
+	else if(m_SaveMap && MapSize > 0)
 	{
-		// get map data
-		unsigned char *pMapData = (unsigned char *)mem_alloc(MapSize, 1);
-		io_read(m_File, pMapData, MapSize);
-
 		// save map
 		MapFile = pStorage->OpenFile(aMapFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
-		io_write(MapFile, pMapData, MapSize);
-		io_close(MapFile);
-
-		// free data
-		mem_free(pMapData);
+		if(MapFile)
+		{
+			io_write(MapFile, m_pFileData+m_FilePos, MapSize);
+			io_close(MapFile);
+		}
 	}
+	m_FilePos += MapSize;
+	m_DataStart = m_FilePos;
 
 	if(m_Info.m_Header.m_Version > gs_OldVersion)
 	{
@@ -689,13 +864,26 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 		}
 	}
 
-	// scan the file for interessting points
-	ScanFile();
+	// use the keyframe index if the demo has one, otherwise scan the file for interessting points
+	if(!ReadIndex())
+		ScanFile();
 
 	// ready for playback
 	return 0;
 }
 
+void CDemoPlayer::ReleaseFile()
+{
+	if(m_FileMapped)
+		io_unmap((void *)m_pFileData, m_FileSize);
+	else
+		mem_free((void *)m_pFileData);
+	m_pFileData = 0;
+	m_FileSize = 0;
+	m_FilePos = 0;
+	m_FileMapped = false;
+}
+
 int CDemoPlayer::NextFrame()
 {
 	DoTick();
@@ -720,27 +908,29 @@ int CDemoPlayer::SetPos(float Percent)
 {
 	int Keyframe;
 	int WantedTick;
-	if(!m_File)
+	if(!m_pFileData)
 		return -1;
 
 	// -5 because we have to have a current tick and previous tick when we do the playback
 	WantedTick = m_Info.m_Info.m_FirstTick + (int)((m_Info.m_Info.m_LastTick-m_Info.m_Info.m_FirstTick)*Percent) - 5;
 
-	Keyframe = (int)(m_Info.m_SeekablePoints*Percent);
-
-	if(Keyframe < 0 || Keyframe >= m_Info.m_SeekablePoints)
+	if(Percent < 0.0f || Percent >= 1.0f || m_Info.m_SeekablePoints <= 0)
 		return -1;
 
-	// get correct key frame
-	if(m_pKeyFrames[Keyframe].m_Tick < WantedTick)
-		while(Keyframe < m_Info.m_SeekablePoints-1 && m_pKeyFrames[Keyframe].m_Tick < WantedTick)
-			Keyframe++;
-
-	while(Keyframe && m_pKeyFrames[Keyframe].m_Tick > WantedTick)
-		Keyframe--;
+	// get the last keyframe before the wanted tick
+	int Low = 0, High = m_Info.m_SeekablePoints-1;
+	while(Low < High)
+	{
+		int Mid = (Low+High+1)/2;
+		if(m_pKeyFrames[Mid].m_Tick > WantedTick)
+			High = Mid-1;
+		else
+			Low = Mid;
+	}
+	Keyframe = Low;
 
 	// seek to the correct keyframe
-	io_seek(m_File, m_pKeyFrames[Keyframe].m_Filepos, IOSEEK_START);
+	m_FilePos = m_pKeyFrames[Keyframe].m_Filepos;
 
 	//m_Info.start_tick = -1;
 	m_Info.m_NextTick = -1;
@@ -761,10 +951,10 @@ void CDemoPlayer::SetSpeed(float Speed)
 	m_Info.m_Info.m_Speed = Speed;
 }
 
-int CDemoPlayer::Update()
+int CDemoPlayer::Update(int64 FixedStep)
 {
 	int64 Now = time_get();
-	int64 Deltatime = Now-m_Info.m_LastUpdate;
+	int64 Deltatime = FixedStep ? FixedStep : Now-m_Info.m_LastUpdate;
 	m_Info.m_LastUpdate = Now;
 
 	if(!IsPlaying())
@@ -817,12 +1007,11 @@ int CDemoPlayer::Update()
 
 int CDemoPlayer::Stop()
 {
-	if(!m_File)
+	if(!m_pFileData)
 		return -1;
 
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_player", "Stopped playback");
-	io_close(m_File);
-	m_File = 0;
+	ReleaseFile();
 	mem_free(m_pKeyFrames);
 	m_pKeyFrames = 0;
 	str_copy(m_aFilename, "", sizeof(m_aFilename));
@@ -870,7 +1059,7 @@ bool CDemoPlayer::GetDemoInfo(class IStorage *pStorage, const char *pFilename, i
 
 int CDemoPlayer::GetDemoType() const
 {
-	if(m_File)
+	if(m_pFileData)
 		return m_DemoType;
 	return DEMOTYPE_INVALID;
 }
@@ -3,6 +3,8 @@
 #ifndef ENGINE_SHARED_DEMO_H
 #define ENGINE_SHARED_DEMO_H
 
+#include <base/tl/array.h>
+
 #include <engine/demo.h>
 #include <engine/shared/protocol.h>
 
@@ -10,11 +12,19 @@
 
 class CDemoRecorder : public IDemoRecorder
 {
+	struct CKeyFrame
+	{
+		long m_Filepos;
+		int m_Tick;
+	};
+
 	class IConsole *m_pConsole;
 	IOHANDLE m_File;
 	int m_LastTickMarker;
 	int m_LastKeyFrame;
+	int m_KeyFrameInterval;
 	int m_FirstTick;
+	array<CKeyFrame> m_aKeyFrames;
 	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
 	class CSnapshotDelta *m_pSnapshotDelta;
 	int m_NumTimelineMarkers;
@@ -22,6 +32,7 @@ class CDemoRecorder : public IDemoRecorder
 
 	void WriteTickMarker(int Tick, int Keyframe);
 	void Write(int Type, const void *pData, int Size);
+	void WriteIndex();
 public:
 	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta);
 
@@ -85,20 +96,34 @@ private:
 	};
 
 	class IConsole *m_pConsole;
-	IOHANDLE m_File;
 	char m_aFilename[256];
 	CKeyFrame *m_pKeyFrames;
 
+	// the whole file, mapped or read into memory
+	const unsigned char *m_pFileData;
+	unsigned m_FileSize;
+	unsigned m_FilePos;
+	unsigned m_DataStart;
+	bool m_FileMapped;
+	bool m_SaveMap;
+
 	CPlaybackInfo m_Info;
 	int m_DemoType;
 	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
 	int m_LastSnapshotDataSize;
+
+	// per player buffers for decoding chunks, so several players can run in parallel
+	char m_aDecompressedData[CSnapshot::MAX_SIZE];
+	char m_aChunkData[CSnapshot::MAX_SIZE];
+	char m_aNewSnapshotData[CSnapshot::MAX_SIZE];
+
 	class CSnapshotDelta *m_pSnapshotDelta;
 
 	int ReadChunkHeader(int *pType, int *pSize, int *pTick);
 	void DoTick();
+	void ReleaseFile();
+	bool ReadIndex();
 	void ScanFile();
-	int NextFrame();
 
 public:
 
@@ -106,8 +131,12 @@ public:
 
 	void SetListner(IListner *pListner);
 
+	// whether Load writes the embedded map to downloadedmaps when it's missing
+	void SetSaveMap(bool SaveMap) { m_SaveMap = SaveMap; }
+
 	int Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType);
 	int Play();
+	int NextFrame();
 	void Pause();
 	void Unpause();
 	int Stop();
@@ -118,10 +147,11 @@ public:
 	bool GetDemoInfo(class IStorage *pStorage, const char *pFilename, int StorageType, CDemoHeader *pDemoHeader) const;
 	int GetDemoType() const;
 
-	int Update();
+	// a fixed step advances the playback by that much instead of the passed time
+	int Update(int64 FixedStep = 0);
 
 	const CPlaybackInfo *Info() const { return &m_Info; }
-	int IsPlaying() const { return m_File != 0; }
+	int IsPlaying() const { return m_pFileData != 0; }
 };
 
 #endif
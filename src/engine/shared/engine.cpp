@@ -2,6 +2,7 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <stdlib.h> // srand
 
+#include <base/math.h>
 #include <base/system.h>
 
 #include <engine/console.h>
@@ -76,7 +77,8 @@ public:
 		net_init();
 		CNetBase::Init();
 
-		m_JobPool.Init(1);
+		// host lookups block their worker, so always have a spare one
+		m_JobPool.Init(max(2, thread_num_cpus()));
 
 		m_Logging = false;
 	}
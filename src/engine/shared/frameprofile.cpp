@@ -0,0 +1,19 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "frameprofile.h"
+
+bool CFrameProfile::ms_Active = false;
+int CFrameProfile::ms_aDepth[NUM_PARTS] = {0};
+int64 CFrameProfile::ms_aTime[NUM_PARTS] = {0};
+
+const char *CFrameProfile::PartName(int Part)
+{
+	static const char *s_apNames[NUM_PARTS] = {"update", "components", "text", "command buffers", "backend"};
+	return s_apNames[Part];
+}
+
+void CFrameProfile::Reset()
+{
+	for(int i = 0; i < NUM_PARTS; i++)
+		ms_aTime[i] = 0;
+}
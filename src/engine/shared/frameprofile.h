@@ -0,0 +1,53 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_SHARED_FRAMEPROFILE_H
+#define ENGINE_SHARED_FRAMEPROFILE_H
+
+#include <base/system.h>
+
+// cpu time spent in the parts of a client frame, only taken while a
+// benchmark runs. nested scopes of the same part are counted once
+class CFrameProfile
+{
+public:
+	enum
+	{
+		PART_UPDATE=0,
+		PART_COMPONENTS,
+		PART_TEXT,
+		PART_CMDBUFFER,
+		PART_BACKEND,
+		NUM_PARTS
+	};
+
+	static bool ms_Active;
+	static int ms_aDepth[NUM_PARTS];
+	static int64 ms_aTime[NUM_PARTS];
+
+	static const char *PartName(int Part);
+	static void Reset();
+};
+
+class CFrameProfileScope
+{
+	int m_Part;
+	bool m_Counted;
+	int64 m_Start;
+
+public:
+	CFrameProfileScope(int Part)
+	{
+		m_Part = Part;
+		m_Counted = CFrameProfile::ms_Active;
+		if(m_Counted && CFrameProfile::ms_aDepth[Part]++ == 0)
+			m_Start = time_get();
+	}
+
+	~CFrameProfileScope()
+	{
+		if(m_Counted && --CFrameProfile::ms_aDepth[m_Part] == 0)
+			CFrameProfile::ms_aTime[m_Part] += time_get()-m_Start;
+	}
+};
+
+#endif
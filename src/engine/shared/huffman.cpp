@@ -94,6 +94,41 @@ void CHuffman::ConstructTree(const unsigned *pFrequencies)
 	Setbits_r(m_pStartNode, 0, 0);
 }
 
+void CHuffman::BuildMultiLut()
+{
+	CNode *pEof = &m_aNodes[HUFFMAN_EOF_SYMBOL];
+
+	for(int i = 0; i < HUFFMAN_MULTI_LUTSIZE; i++)
+	{
+		CMultiEntry *pEntry = &m_aMultiLut[i];
+		unsigned Used = 0;
+		pEntry->m_NumSymbols = 0;
+		pEntry->m_Eof = 0;
+
+		// decode as many whole symbols as fit into the bits
+		while(pEntry->m_NumSymbols < HUFFMAN_MULTI_MAXSYMBOLS)
+		{
+			CNode *pNode = m_pStartNode;
+			unsigned k = Used;
+			while(k < HUFFMAN_MULTI_LUTBITS && !pNode->m_NumBits)
+				pNode = &m_aNodes[pNode->m_aLeafs[(i>>k++)&1]];
+
+			if(!pNode->m_NumBits)
+				break;
+
+			Used = k;
+			if(pNode == pEof)
+			{
+				pEntry->m_Eof = 1;
+				break;
+			}
+			pEntry->m_aSymbols[pEntry->m_NumSymbols++] = pNode->m_Symbol;
+		}
+
+		pEntry->m_NumBits = Used;
+	}
+}
+
 void CHuffman::Init(const unsigned *pFrequencies)
 {
 	int i;
@@ -129,87 +164,151 @@ void CHuffman::Init(const unsigned *pFrequencies)
 			m_apDecodeLut[i] = pNode;
 	}
 
+	// build encode tables
+	for(i = 0; i < HUFFMAN_MAX_SYMBOLS; i++)
+	{
+		m_aEncodeBits[i] = m_aNodes[i].m_Bits;
+		m_aEncodeNumBits[i] = m_aNodes[i].m_NumBits;
+	}
+
+	BuildMultiLut();
 }
 
 //***************************************************************
 int CHuffman::Compress(const void *pInput, int InputSize, void *pOutput, int OutputSize)
 {
-	// this macro loads a symbol for a byte into bits and bitcount
-#define HUFFMAN_MACRO_LOADSYMBOL(Sym) \
-	Bits |= m_aNodes[Sym].m_Bits << Bitcount; \
-	Bitcount += m_aNodes[Sym].m_NumBits;
-
-	// this macro writes the symbol stored in bits and bitcount to the dst pointer
-#define HUFFMAN_MACRO_WRITE() \
-	while(Bitcount >= 8) \
-	{ \
-		*pDst++ = (unsigned char)(Bits&0xff); \
-		if(pDst == pDstEnd) \
-			return -1; \
-		Bits >>= 8; \
-		Bitcount -= 8; \
-	}
-
 	// setup buffer pointers
 	const unsigned char *pSrc = (const unsigned char *)pInput;
 	const unsigned char *pSrcEnd = pSrc + InputSize;
 	unsigned char *pDst = (unsigned char *)pOutput;
 	unsigned char *pDstEnd = pDst + OutputSize;
 
-	// symbol variables
-	unsigned Bits = 0;
+	// symbol variables, codes are at most 32 bits so there is always room for one more
+	uint64 Bits = 0;
 	unsigned Bitcount = 0;
 
-	// make sure that we have data that we want to compress
-	if(InputSize)
+	// note: compression fails as soon as the output buffer is full, even if the data would fit exactly
+	while(pSrc != pSrcEnd)
 	{
-		// {A} load the first symbol
 		int Symbol = *pSrc++;
+		Bits |= (uint64)m_aEncodeBits[Symbol] << Bitcount;
+		Bitcount += m_aEncodeNumBits[Symbol];
 
-		while(pSrc != pSrcEnd)
+		// write 32 bits at once
+		if(Bitcount >= 32)
 		{
-			// {B} load the symbol
-			HUFFMAN_MACRO_LOADSYMBOL(Symbol)
-
-			// {C} fetch next symbol, this is done here because it will reduce dependency in the code
-			Symbol = *pSrc++;
-
-			// {B} write the symbol loaded at
-			HUFFMAN_MACRO_WRITE()
+			if(pDstEnd - pDst <= 4)
+				return -1;
+			pDst[0] = (unsigned char)Bits;
+			pDst[1] = (unsigned char)(Bits>>8);
+			pDst[2] = (unsigned char)(Bits>>16);
+			pDst[3] = (unsigned char)(Bits>>24);
+			pDst += 4;
+			Bits >>= 32;
+			Bitcount -= 32;
 		}
-
-		// write the last symbol loaded from {C} or {A} in the case of only 1 byte input buffer
-		HUFFMAN_MACRO_LOADSYMBOL(Symbol)
-		HUFFMAN_MACRO_WRITE()
 	}
 
 	// write EOF symbol
-	HUFFMAN_MACRO_LOADSYMBOL(HUFFMAN_EOF_SYMBOL)
-	HUFFMAN_MACRO_WRITE()
+	Bits |= (uint64)m_aEncodeBits[HUFFMAN_EOF_SYMBOL] << Bitcount;
+	Bitcount += m_aEncodeNumBits[HUFFMAN_EOF_SYMBOL];
+	while(Bitcount >= 8)
+	{
+		if(pDstEnd - pDst <= 1)
+			return -1;
+		*pDst++ = (unsigned char)Bits;
+		Bits >>= 8;
+		Bitcount -= 8;
+	}
 
 	// write out the last bits
-	*pDst++ = Bits;
+	if(pDst == pDstEnd)
+		return -1;
+	*pDst++ = (unsigned char)Bits;
 
 	// return the size of the output
 	return (int)(pDst - (const unsigned char *)pOutput);
+}
 
-	// remove macros
-#undef HUFFMAN_MACRO_LOADSYMBOL
-#undef HUFFMAN_MACRO_WRITE
+// loads 8 bytes in little endian order
+static inline uint64 Load64(const unsigned char *pSrc)
+{
+	return (uint64)pSrc[0] | ((uint64)pSrc[1]<<8) | ((uint64)pSrc[2]<<16) | ((uint64)pSrc[3]<<24) |
+		((uint64)pSrc[4]<<32) | ((uint64)pSrc[5]<<40) | ((uint64)pSrc[6]<<48) | ((uint64)pSrc[7]<<56);
 }
 
 //***************************************************************
 int CHuffman::Decompress(const void *pInput, int InputSize, void *pOutput, int OutputSize)
 {
 	// setup buffer pointers
+	const unsigned char *pSrc = (const unsigned char *)pInput;
+	const unsigned char *pSrcEnd = pSrc + InputSize;
 	unsigned char *pDst = (unsigned char *)pOutput;
-	unsigned char *pSrc = (unsigned char *)pInput;
 	unsigned char *pDstEnd = pDst + OutputSize;
-	unsigned char *pSrcEnd = pSrc + InputSize;
 
-	unsigned Bits = 0;
+	uint64 Bits = 0;
 	unsigned Bitcount = 0;
 
+	CNode *pEof = &m_aNodes[HUFFMAN_EOF_SYMBOL];
+
+	// fast path, as long as whole words can be read and written
+	while(pSrcEnd - pSrc >= 8 && pDstEnd - pDst >= HUFFMAN_MULTI_MAXSYMBOLS)
+	{
+		// refill to at least 56 bits, rereading bits that are already loaded doesn't change them
+		Bits |= Load64(pSrc) << Bitcount;
+		pSrc += (63 - Bitcount) >> 3;
+		Bitcount |= 56;
+
+		const CMultiEntry *pEntry = &m_aMultiLut[Bits&HUFFMAN_MULTI_LUTMASK];
+		if(pEntry->m_NumBits)
+		{
+			// output all symbols at once, the unused bytes get overwritten later
+			for(int i = 0; i < HUFFMAN_MULTI_MAXSYMBOLS; i++)
+				pDst[i] = pEntry->m_aSymbols[i];
+			pDst += pEntry->m_NumSymbols;
+			Bits >>= pEntry->m_NumBits;
+			Bitcount -= pEntry->m_NumBits;
+
+			if(pEntry->m_Eof)
+				return (int)(pDst - (const unsigned char *)pOutput);
+		}
+		else
+		{
+			// the symbol is longer than the table, walk the tree from where the small lut ends
+			CNode *pNode = m_apDecodeLut[Bits&HUFFMAN_LUTMASK];
+			Bits >>= HUFFMAN_LUTBITS;
+			Bitcount -= HUFFMAN_LUTBITS;
+			while(!pNode->m_NumBits)
+			{
+				// no more bits, decoding error
+				if(Bitcount == 0)
+					return -1;
+
+				pNode = &m_aNodes[pNode->m_aLeafs[Bits&1]];
+				Bitcount--;
+				Bits >>= 1;
+			}
+
+			if(pNode == pEof)
+				return (int)(pDst - (const unsigned char *)pOutput);
+			*pDst++ = pNode->m_Symbol;
+		}
+	}
+
+	// give back the whole bytes that are loaded but not used yet
+	while(Bitcount >= 8)
+	{
+		pSrc--;
+		Bitcount -= 8;
+	}
+	Bits &= (1<<Bitcount)-1;
+
+	return DecompressTail(pSrc, pSrcEnd, (unsigned)Bits, Bitcount, (const unsigned char *)pOutput, pDst, pDstEnd);
+}
+
+int CHuffman::DecompressTail(const unsigned char *pSrc, const unsigned char *pSrcEnd, unsigned Bits, unsigned Bitcount,
+	const unsigned char *pOutput, unsigned char *pDst, unsigned char *pDstEnd)
+{
 	CNode *pEof = &m_aNodes[HUFFMAN_EOF_SYMBOL];
 	CNode *pNode = 0;
 
@@ -278,5 +377,5 @@ int CHuffman::Decompress(const void *pInput, int InputSize, void *pOutput, int O
 	}
 
 	// return the size of the decompressed buffer
-	return (int)(pDst - (const unsigned char *)pOutput);
+	return (int)(pDst - pOutput);
 }
@@ -16,7 +16,13 @@ class CHuffman
 
 		HUFFMAN_LUTBITS = 10,
 		HUFFMAN_LUTSIZE = (1<<HUFFMAN_LUTBITS),
-		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE-1)
+		HUFFMAN_LUTMASK = (HUFFMAN_LUTSIZE-1),
+
+		// multi symbol decode table, sized to stay in the L1 cache
+		HUFFMAN_MULTI_LUTBITS = 11,
+		HUFFMAN_MULTI_LUTSIZE = (1<<HUFFMAN_MULTI_LUTBITS),
+		HUFFMAN_MULTI_LUTMASK = (HUFFMAN_MULTI_LUTSIZE-1),
+		HUFFMAN_MULTI_MAXSYMBOLS = 8
 	};
 
 	struct CNode
@@ -32,13 +38,31 @@ class CHuffman
 		unsigned char m_Symbol;
 	};
 
+	// all symbols that can be decoded from the next HUFFMAN_MULTI_LUTBITS bits
+	struct CMultiEntry
+	{
+		unsigned char m_aSymbols[HUFFMAN_MULTI_MAXSYMBOLS];
+		unsigned char m_NumSymbols;
+		unsigned char m_NumBits; // 0 if the first symbol is longer than the table
+		unsigned char m_Eof; // the symbols are followed by the EOF symbol
+	};
+
 	CNode m_aNodes[HUFFMAN_MAX_NODES];
 	CNode *m_apDecodeLut[HUFFMAN_LUTSIZE];
 	CNode *m_pStartNode;
 	int m_NumNodes;
 
+	// flat copies of the symbol codes, so the encoder doesn't have to touch the tree
+	unsigned m_aEncodeBits[HUFFMAN_MAX_SYMBOLS];
+	unsigned char m_aEncodeNumBits[HUFFMAN_MAX_SYMBOLS];
+	CMultiEntry m_aMultiLut[HUFFMAN_MULTI_LUTSIZE];
+
 	void Setbits_r(CNode *pNode, int Bits, unsigned Depth);
 	void ConstructTree(const unsigned *pFrequencies);
+	void BuildMultiLut();
+
+	int DecompressTail(const unsigned char *pSrc, const unsigned char *pSrcEnd, unsigned Bits, unsigned Bitcount,
+		const unsigned char *pOutput, unsigned char *pDst, unsigned char *pDstEnd);
 
 public:
 	/*
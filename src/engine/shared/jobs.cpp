@@ -1,75 +1,323 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
 #include <base/system.h>
+#include <base/tl/threading.h>
 #include "jobs.h"
 
+CJobGroup::CJobGroup()
+{
+	m_NumPending = 0;
+	m_Lock = lock_create();
+	sphore_init(&m_Done);
+	m_NumWaiters = 0;
+	m_pFirstContinuation = 0;
+}
+
+CJobGroup::~CJobGroup()
+{
+	sphore_destroy(&m_Done);
+	lock_destroy(m_Lock);
+}
+
 CJobPool::CJobPool()
 {
 	// empty the pool
 	m_Lock = lock_create();
 	m_pFirstJob = 0;
 	m_pLastJob = 0;
+	m_NumQueued = 0;
+	m_NumThreads = 0;
+	m_NumSleeping = 0;
+	sphore_init(&m_Wakeup);
 }
 
-void CJobPool::WorkerThread(void *pUser)
+// deque of a worker, see "Dynamic Circular Work-Stealing Deque" by Chase and Lev.
+// only the owner calls Push and Pop, everyone else can Steal
+bool CJobPool::Push(CWorker *pWorker, CJob *pJob)
 {
-	CJobPool *pPool = (CJobPool *)pUser;
+	unsigned Bottom = pWorker->m_Bottom;
+	if(Bottom - pWorker->m_Top >= DEQUE_SIZE)
+		return false;
 
-	while(1)
+	pWorker->m_apJobs[Bottom&DEQUE_MASK] = pJob;
+	sync_barrier();
+	pWorker->m_Bottom = Bottom+1;
+	return true;
+}
+
+CJob *CJobPool::Pop(CWorker *pWorker)
+{
+	unsigned Bottom = pWorker->m_Bottom-1;
+	pWorker->m_Bottom = Bottom;
+	sync_barrier();
+	unsigned Top = pWorker->m_Top;
+
+	if((int)(Bottom-Top) < 0)
 	{
-		CJob *pJob = 0;
+		// empty
+		pWorker->m_Bottom = Top;
+		return 0;
+	}
+
+	CJob *pJob = pWorker->m_apJobs[Bottom&DEQUE_MASK];
+	if(Bottom != Top)
+		return pJob;
+
+	// last job, race the thieves for it
+	if(atomic_compswap(&pWorker->m_Top, Top, Top+1) != Top)
+		pJob = 0;
+	pWorker->m_Bottom = Top+1;
+	return pJob;
+}
+
+CJob *CJobPool::Steal(CWorker *pVictim)
+{
+	unsigned Top = pVictim->m_Top;
+	sync_barrier();
+	unsigned Bottom = pVictim->m_Bottom;
 
-		// fetch job from queue
-		lock_wait(pPool->m_Lock);
-		if(pPool->m_pFirstJob)
+	if((int)(Bottom-Top) <= 0)
+		return 0;
+
+	CJob *pJob = pVictim->m_apJobs[Top&DEQUE_MASK];
+	if(atomic_compswap(&pVictim->m_Top, Top, Top+1) != Top)
+		return 0;
+	return pJob;
+}
+
+// claims one of the sleeping workers, every claim is one signal
+bool CJobPool::ClaimSleeper()
+{
+	unsigned Sleeping = m_NumSleeping;
+	while(Sleeping)
+	{
+		unsigned Old = atomic_compswap(&m_NumSleeping, Sleeping, Sleeping-1);
+		if(Old == Sleeping)
+			return true;
+		Sleeping = Old;
+	}
+	return false;
+}
+
+void CJobPool::Notify()
+{
+	sync_barrier();
+	if(ClaimSleeper())
+		sphore_signal(&m_Wakeup);
+}
+
+void CJobPool::Queue(CWorker *pWorker, CJob *pJob)
+{
+	// workers keep their own jobs, unless the deque is full
+	if(!pWorker || !Push(pWorker, pJob))
+	{
+		lock_wait(m_Lock);
+		pJob->m_pNext = 0;
+		if(m_pLastJob)
+			m_pLastJob->m_pNext = pJob;
+		else
+			m_pFirstJob = pJob;
+		m_pLastJob = pJob;
+		m_NumQueued++;
+		lock_unlock(m_Lock);
+	}
+
+	Notify();
+}
+
+CJob *CJobPool::TakeQueued(CWorker *pWorker)
+{
+	if(!m_NumQueued)
+		return 0;
+
+	lock_wait(m_Lock);
+	CJob *pJob = m_pFirstJob;
+	if(pJob)
+	{
+		// take a fair share of the queue, the rest of the batch can be stolen from us
+		int Batch = min((int)MAX_BATCH, (int)(m_NumQueued+m_NumThreads-1)/m_NumThreads);
+		m_pFirstJob = pJob->m_pNext;
+		m_NumQueued--;
+		for(int i = 1; i < Batch && m_pFirstJob && Push(pWorker, m_pFirstJob); i++)
 		{
-			pJob = pPool->m_pFirstJob;
-			pPool->m_pFirstJob = pPool->m_pFirstJob->m_pNext;
-			if(pPool->m_pFirstJob)
-				pPool->m_pFirstJob->m_pPrev = 0;
-			else
-				pPool->m_pLastJob = 0;
+			m_pFirstJob = m_pFirstJob->m_pNext;
+			m_NumQueued--;
 		}
-		lock_unlock(pPool->m_Lock);
+		if(!m_pFirstJob)
+			m_pLastJob = 0;
+	}
+	lock_unlock(m_Lock);
+	return pJob;
+}
+
+CJob *CJobPool::StealAny(CWorker *pWorker)
+{
+	int Start = (random_next(&pWorker->m_Seed)>>8)%m_NumThreads;
+	for(int i = 0; i < m_NumThreads; i++)
+	{
+		CWorker *pVictim = &m_aWorkers[(Start+i)%m_NumThreads];
+		if(pVictim == pWorker)
+			continue;
+		CJob *pJob = Steal(pVictim);
+		if(pJob)
+			return pJob;
+	}
+	return 0;
+}
+
+bool CJobPool::HasWork() const
+{
+	if(m_NumQueued)
+		return true;
+	for(int i = 0; i < m_NumThreads; i++)
+		if((int)(m_aWorkers[i].m_Bottom-m_aWorkers[i].m_Top) > 0)
+			return true;
+	return false;
+}
+
+void CJobPool::Run(CWorker *pWorker, CJob *pJob)
+{
+	// the job may be reused as soon as it's done, so don't touch it afterwards
+	CJobGroup *pGroup = pJob->m_pGroup;
+
+	pJob->m_Status = CJob::STATE_RUNNING;
+	pJob->m_Result = pJob->m_pfnFunc(pJob->m_pFuncData);
+	sync_barrier();
+	pJob->m_Status = CJob::STATE_DONE;
+
+	if(pGroup)
+		Finish(pWorker, pGroup);
+}
+
+void CJobPool::Finish(CWorker *pWorker, CJobGroup *pGroup)
+{
+	// not the last job of the group, nothing to do
+	unsigned Pending = pGroup->m_NumPending;
+	while(Pending > 1)
+	{
+		unsigned Old = atomic_compswap(&pGroup->m_NumPending, Pending, Pending-1);
+		if(Old == Pending)
+			return;
+		Pending = Old;
+	}
+
+	// the group might get done, this happens under the lock so waiters
+	// can't return and destroy the group before we are finished with it
+	lock_wait(pGroup->m_Lock);
+	CJob *pContinuation = 0;
+	if(atomic_dec(&pGroup->m_NumPending) == 0)
+	{
+		pContinuation = pGroup->m_pFirstContinuation;
+		pGroup->m_pFirstContinuation = 0;
+		for(int i = 0; i < pGroup->m_NumWaiters; i++)
+			sphore_signal(&pGroup->m_Done);
+		pGroup->m_NumWaiters = 0;
+	}
+	lock_unlock(pGroup->m_Lock);
+
+	while(pContinuation)
+	{
+		CJob *pNext = pContinuation->m_pNext;
+		Queue(pWorker, pContinuation);
+		pContinuation = pNext;
+	}
+}
+
+void CJobPool::WorkerThread(void *pUser)
+{
+	CWorker *pWorker = (CWorker *)pUser;
+	CJobPool *pPool = pWorker->m_pPool;
+
+	while(1)
+	{
+		// own jobs first, then the shared queue, then the other workers
+		CJob *pJob = Pop(pWorker);
+		if(!pJob)
+			pJob = pPool->TakeQueued(pWorker);
+		if(!pJob)
+			pJob = pPool->StealAny(pWorker);
 
 		// do the job if we have one
 		if(pJob)
 		{
-			pJob->m_Status = CJob::STATE_RUNNING;
-			pJob->m_Result = pJob->m_pfnFunc(pJob->m_pFuncData);
-			pJob->m_Status = CJob::STATE_DONE;
+			pPool->Run(pWorker, pJob);
+			continue;
 		}
-		else
-			thread_sleep(10);
-	}
 
+		// sleep until jobs get added, check once more after announcing it
+		// so jobs that got added in the meantime aren't missed. when the
+		// announcement was already claimed, the signal is on its way
+		atomic_inc(&pPool->m_NumSleeping);
+		if(pPool->HasWork() && pPool->ClaimSleeper())
+			continue;
+		sphore_wait(&pPool->m_Wakeup);
+	}
 }
 
 int CJobPool::Init(int NumThreads)
 {
 	// start threads
-	for(int i = 0; i < NumThreads; i++)
-		thread_init(WorkerThread, this);
+	m_NumThreads = clamp(NumThreads, 1, (int)MAX_THREADS);
+	for(int i = 0; i < m_NumThreads; i++)
+	{
+		CWorker *pWorker = &m_aWorkers[i];
+		pWorker->m_pPool = this;
+		pWorker->m_Seed = i+1;
+		pWorker->m_Top = 0;
+		pWorker->m_Bottom = 0;
+	}
+	for(int i = 0; i < m_NumThreads; i++)
+		thread_init(WorkerThread, &m_aWorkers[i]);
 	return 0;
 }
 
-int CJobPool::Add(CJob *pJob, JOBFUNC pfnFunc, void *pData)
+void CJobPool::Prepare(CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pGroup)
 {
 	mem_zero(pJob, sizeof(CJob));
+	pJob->m_pPool = this;
 	pJob->m_pfnFunc = pfnFunc;
 	pJob->m_pFuncData = pData;
+	pJob->m_pGroup = pGroup;
+	if(pGroup)
+		atomic_inc(&pGroup->m_NumPending);
+}
 
-	lock_wait(m_Lock);
+int CJobPool::Add(CJob *pJob, JOBFUNC pfnFunc, void *pData)
+{
+	return Add(pJob, pfnFunc, pData, 0);
+}
 
-	// add job to queue
-	pJob->m_pPrev = m_pLastJob;
-	if(m_pLastJob)
-		m_pLastJob->m_pNext = pJob;
-	m_pLastJob = pJob;
-	if(!m_pFirstJob)
-		m_pFirstJob = pJob;
+int CJobPool::Add(CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pGroup)
+{
+	Prepare(pJob, pfnFunc, pData, pGroup);
+	Queue(0, pJob);
+	return 0;
+}
 
-	lock_unlock(m_Lock);
+int CJobPool::Then(CJobGroup *pGroup, CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pNextGroup)
+{
+	Prepare(pJob, pfnFunc, pData, pNextGroup);
+
+	// hold the group open while adding the continuation
+	atomic_inc(&pGroup->m_NumPending);
+	lock_wait(pGroup->m_Lock);
+	pJob->m_pNext = pGroup->m_pFirstContinuation;
+	pGroup->m_pFirstContinuation = pJob;
+	lock_unlock(pGroup->m_Lock);
+	Finish(0, pGroup);
 	return 0;
 }
 
+void CJobPool::Wait(CJobGroup *pGroup)
+{
+	lock_wait(pGroup->m_Lock);
+	while(pGroup->m_NumPending)
+	{
+		pGroup->m_NumWaiters++;
+		lock_unlock(pGroup->m_Lock);
+		sphore_wait(&pGroup->m_Done);
+		lock_wait(pGroup->m_Lock);
+	}
+	lock_unlock(pGroup->m_Lock);
+}
@@ -2,17 +2,20 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef ENGINE_SHARED_JOBS_H
 #define ENGINE_SHARED_JOBS_H
+#include <base/system.h>
+
 typedef int (*JOBFUNC)(void *pData);
 
 class CJobPool;
+class CJobGroup;
 
 class CJob
 {
 	friend class CJobPool;
 
 	CJobPool *m_pPool;
-	CJob *m_pPrev;
 	CJob *m_pNext;
+	CJobGroup *m_pGroup;
 
 	volatile int m_Status;
 	volatile int m_Result;
@@ -37,18 +40,110 @@ public:
 	int Result() const {return m_Result; }
 };
 
+/*
+	Class: CJobGroup
+		A set of jobs that can be waited for as a whole. Continuations
+		added with CJobPool::Then run once all jobs of the group are done.
+		A group can be reused once it is done, it has to outlive its jobs.
+*/
+class CJobGroup
+{
+	friend class CJobPool;
+
+	volatile unsigned m_NumPending;
+
+	// only taken when the last job finishes and by waiters
+	LOCK m_Lock;
+	SEMAPHORE m_Done;
+	int m_NumWaiters;
+	CJob *m_pFirstContinuation;
+
+public:
+	CJobGroup();
+	~CJobGroup();
+
+	bool Done() const { return m_NumPending == 0; }
+	int NumPending() const { return m_NumPending; }
+};
+
+/*
+	Class: CJobPool
+		Work stealing thread pool. Every worker has its own deque which
+		only it pushes to and pops from, idle workers steal from the other
+		end of the deques of the others. Jobs added from outside go into a
+		shared queue which the workers take from in batches. Idle workers
+		sleep until new jobs arrive.
+*/
 class CJobPool
 {
+	enum
+	{
+		MAX_THREADS=32,
+		DEQUE_SIZE=1024,
+		DEQUE_MASK=DEQUE_SIZE-1,
+		MAX_BATCH=32,
+	};
+
+	struct CWorker
+	{
+		CJobPool *m_pPool;
+		unsigned m_Seed;
+
+		volatile unsigned m_Top;
+		volatile unsigned m_Bottom;
+		CJob *volatile m_apJobs[DEQUE_SIZE];
+	};
+
+	// shared queue for jobs added from outside of the workers
 	LOCK m_Lock;
 	CJob *m_pFirstJob;
 	CJob *m_pLastJob;
+	volatile unsigned m_NumQueued;
+
+	CWorker m_aWorkers[MAX_THREADS];
+	int m_NumThreads;
+
+	SEMAPHORE m_Wakeup;
+	volatile unsigned m_NumSleeping;
 
 	static void WorkerThread(void *pUser);
 
+	static bool Push(CWorker *pWorker, CJob *pJob);
+	static CJob *Pop(CWorker *pWorker);
+	static CJob *Steal(CWorker *pVictim);
+
+	void Prepare(CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pGroup);
+	void Queue(CWorker *pWorker, CJob *pJob);
+	bool ClaimSleeper();
+	void Notify();
+	CJob *TakeQueued(CWorker *pWorker);
+	CJob *StealAny(CWorker *pWorker);
+	bool HasWork() const;
+	void Run(CWorker *pWorker, CJob *pJob);
+	void Finish(CWorker *pWorker, CJobGroup *pGroup);
+
 public:
 	CJobPool();
 
 	int Init(int NumThreads);
+	int NumThreads() const { return m_NumThreads; }
+
 	int Add(CJob *pJob, JOBFUNC pfnFunc, void *pData);
+	int Add(CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pGroup);
+
+	/*
+		Function: Then
+			Runs pJob once all jobs that are currently in pGroup are done,
+			right away if there are none. The job can be added to
+			pNextGroup to chain further continuations.
+	*/
+	int Then(CJobGroup *pGroup, CJob *pJob, JOBFUNC pfnFunc, void *pData, CJobGroup *pNextGroup = 0);
+
+	/*
+		Function: Wait
+			Blocks until all jobs of the group are done. Must not be
+			called from a job.
+	*/
+	void Wait(CJobGroup *pGroup);
 };
 #endif
@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <base/system.h>
+#include <engine/engine.h>
 #include <engine/map.h>
 #include <engine/storage.h>
 #include "datafile.h"
@@ -14,6 +15,7 @@ public:
 	virtual void *GetData(int Index) { return m_DataFile.GetData(Index); }
 	virtual void *GetDataSwapped(int Index) { return m_DataFile.GetDataSwapped(Index); }
 	virtual void UnloadData(int Index) { m_DataFile.UnloadData(Index); }
+	virtual void PrefetchData(const int *pIndices, int Num) { m_DataFile.Prefetch(pIndices, Num); }
 	virtual void *GetItem(int Index, int *pType, int *pID) { return m_DataFile.GetItem(Index, pType, pID); }
 	virtual void GetType(int Type, int *pStart, int *pNum) { m_DataFile.GetType(Type, pStart, pNum); }
 	virtual void *FindItem(int Type, int ID) { return m_DataFile.FindItem(Type, ID); }
@@ -29,7 +31,8 @@ public:
 		IStorage *pStorage = Kernel()->RequestInterface<IStorage>();
 		if(!pStorage)
 			return false;
-		return m_DataFile.Open(pStorage, pMapName, IStorage::TYPE_ALL);
+		IEngine *pEngine = Kernel()->RequestInterface<IEngine>();
+		return m_DataFile.Open(pStorage, pMapName, IStorage::TYPE_ALL, pEngine ? pEngine->JobPool() : 0);
 	}
 
 	virtual bool IsLoaded()
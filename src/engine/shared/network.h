@@ -54,7 +54,7 @@ enum
 	NET_MAX_CHUNKHEADERSIZE = 5,
 	NET_PACKETHEADERSIZE = 7,
 	NET_PACKETHEADERSIZE_WITHOUT_TOKEN = 3,
-	NET_MAX_CLIENTS = 16,
+	NET_MAX_CLIENTS = 64,
 	NET_MAX_CONSOLE_CLIENTS = 4,
 	NET_MAX_SEQUENCE = 1<<10,
 	NET_SEQUENCE_MASK = NET_MAX_SEQUENCE-1,
@@ -268,7 +268,7 @@ class CNetServer
 
 	NETSOCKET m_Socket;
 	class CNetBan *m_pNetBan;
-	CSlot m_aSlots[NET_MAX_CLIENTS];
+	CSlot *m_aSlots;
 	int m_MaxClients;
 	int m_MaxClientsPerIP;
 
@@ -296,6 +296,9 @@ class CNetServer
 	bool LegacyRatelimit();
 
 public:
+	CNetServer() { m_aSlots = 0; m_MaxClients = 0; }
+	~CNetServer() { delete[] m_aSlots; }
+
 	int SetCallbacks(NETFUNC_NEWCLIENT pfnNewClient, NETFUNC_DELCLIENT pfnDelClient, void *pUser);
 
 	//
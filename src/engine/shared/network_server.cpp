@@ -14,6 +14,9 @@
 
 bool CNetServer::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int MaxClientsPerIP, int Flags)
 {
+	// slots of an earlier open, the pointer is zeroed with the rest
+	delete[] m_aSlots;
+
 	// zero out the whole structure
 	mem_zero(this, sizeof(*this));
 
@@ -39,7 +42,9 @@ bool CNetServer::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int Ma
 	m_LegacyRatelimitStart = -1;
 	m_LegacyRatelimitNum = 0;
 
-	for(int i = 0; i < NET_MAX_CLIENTS; i++)
+	// only as many slots as the server has, freed with it
+	m_aSlots = new CSlot[m_MaxClients];
+	for(int i = 0; i < m_MaxClients; i++)
 		m_aSlots[i].m_Connection.Init(m_Socket, !g_Config.m_Debug);
 
 	return true;
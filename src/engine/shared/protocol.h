@@ -78,7 +78,10 @@ enum
 	SERVER_TICK_SPEED=50,
 	SERVER_FLAG_PASSWORD = 0x1,
 
-	MAX_CLIENTS=16,
+	// slots a server can be started with, see sv_max_clients. clients
+	// only understand VANILLA_MAX_CLIENTS ids, the server maps the rest
+	MAX_CLIENTS=64,
+	VANILLA_MAX_CLIENTS=16,
 
 	MAX_INPUT_SIZE=128,
 	MAX_SNAPSHOT_PACKSIZE=900,
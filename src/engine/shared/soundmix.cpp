@@ -0,0 +1,167 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/system.h>
+
+#include "soundmix.h"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define SOUNDMIX_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define SOUNDMIX_NEON 1
+#endif
+
+// volume of the accumulated voices to 16 bit, same as ((x*MasterVol)/101)>>8
+// but without running out of int range when a lot of voices play at once
+static float FinishScale(int MasterVol)
+{
+	return MasterVol/(101.0f*256.0f);
+}
+
+void CSoundMix::MixMonoScalar(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	for(unsigned i = 0; i < Frames; i++)
+	{
+		*pOut++ += pIn[i]*LVol;
+		*pOut++ += pIn[i]*RVol;
+	}
+}
+
+void CSoundMix::MixStereoScalar(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	for(unsigned i = 0; i < Frames; i++)
+	{
+		*pOut++ += (*pIn++)*LVol;
+		*pOut++ += (*pIn++)*RVol;
+	}
+}
+
+void CSoundMix::FinishScalar(short *pOut, const int *pIn, unsigned Frames, int MasterVol)
+{
+	float Scale = FinishScale(MasterVol);
+	for(unsigned i = 0; i < Frames*2; i++)
+	{
+		int v = (int)(pIn[i]*Scale);
+		if(v > 0x7fff)
+			v = 0x7fff;
+		else if(v < -0x7fff)
+			v = -0x7fff;
+		pOut[i] = v;
+	}
+}
+
+#if defined(SOUNDMIX_SSE2)
+// the products of 16 bit samples and volumes are built from the low and
+// high halves of the 16 bit multiplication, 8 of them per step
+
+void CSoundMix::MixMono(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	const __m128i Vol = _mm_set_epi16(RVol, LVol, RVol, LVol, RVol, LVol, RVol, LVol);
+	unsigned i = 0;
+	for(; i+8 <= Frames; i += 8, pOut += 16)
+	{
+		__m128i In = _mm_loadu_si128((const __m128i *)(pIn+i));
+		for(int Half = 0; Half < 2; Half++)
+		{
+			// every sample twice, once for each side
+			__m128i Samples = Half ? _mm_unpackhi_epi16(In, In) : _mm_unpacklo_epi16(In, In);
+			__m128i Lo = _mm_mullo_epi16(Samples, Vol);
+			__m128i Hi = _mm_mulhi_epi16(Samples, Vol);
+			__m128i *pDst = (__m128i *)(pOut+Half*8);
+			_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_unpacklo_epi16(Lo, Hi)));
+			_mm_storeu_si128(pDst+1, _mm_add_epi32(_mm_loadu_si128(pDst+1), _mm_unpackhi_epi16(Lo, Hi)));
+		}
+	}
+	MixMonoScalar(pOut, pIn+i, Frames-i, LVol, RVol);
+}
+
+void CSoundMix::MixStereo(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	const __m128i Vol = _mm_set_epi16(RVol, LVol, RVol, LVol, RVol, LVol, RVol, LVol);
+	unsigned i = 0;
+	for(; i+4 <= Frames; i += 4, pIn += 8, pOut += 8)
+	{
+		__m128i Samples = _mm_loadu_si128((const __m128i *)pIn);
+		__m128i Lo = _mm_mullo_epi16(Samples, Vol);
+		__m128i Hi = _mm_mulhi_epi16(Samples, Vol);
+		__m128i *pDst = (__m128i *)pOut;
+		_mm_storeu_si128(pDst, _mm_add_epi32(_mm_loadu_si128(pDst), _mm_unpacklo_epi16(Lo, Hi)));
+		_mm_storeu_si128(pDst+1, _mm_add_epi32(_mm_loadu_si128(pDst+1), _mm_unpackhi_epi16(Lo, Hi)));
+	}
+	MixStereoScalar(pOut, pIn, Frames-i, LVol, RVol);
+}
+
+void CSoundMix::Finish(short *pOut, const int *pIn, unsigned Frames, int MasterVol)
+{
+	const __m128 Scale = _mm_set1_ps(FinishScale(MasterVol));
+	const __m128i Min = _mm_set1_epi16(-0x7fff);
+	unsigned i = 0;
+	for(; i+8 <= Frames*2; i += 8)
+	{
+		__m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pIn+i))), Scale));
+		__m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(pIn+i+4))), Scale));
+		// the pack saturates to -0x8000, the old mixer stopped one above
+		_mm_storeu_si128((__m128i *)(pOut+i), _mm_max_epi16(_mm_packs_epi32(a, b), Min));
+	}
+	FinishScalar(pOut+i, pIn+i, Frames-i/2, MasterVol);
+}
+
+const char *CSoundMix::Implementation() { return "sse2"; }
+
+#elif defined(SOUNDMIX_NEON)
+
+void CSoundMix::MixMono(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	const short aVol[4] = {(short)LVol, (short)RVol, (short)LVol, (short)RVol};
+	const int16x4_t Vol = vld1_s16(aVol);
+	unsigned i = 0;
+	for(; i+4 <= Frames; i += 4, pOut += 8)
+	{
+		// every sample twice, once for each side
+		int16x4_t In = vld1_s16(pIn+i);
+		int16x4x2_t Samples = vzip_s16(In, In);
+		vst1q_s32(pOut, vmlal_s16(vld1q_s32(pOut), Samples.val[0], Vol));
+		vst1q_s32(pOut+4, vmlal_s16(vld1q_s32(pOut+4), Samples.val[1], Vol));
+	}
+	MixMonoScalar(pOut, pIn+i, Frames-i, LVol, RVol);
+}
+
+void CSoundMix::MixStereo(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol)
+{
+	const short aVol[4] = {(short)LVol, (short)RVol, (short)LVol, (short)RVol};
+	const int16x4_t Vol = vld1_s16(aVol);
+	unsigned i = 0;
+	for(; i+4 <= Frames; i += 4, pIn += 8, pOut += 8)
+	{
+		vst1q_s32(pOut, vmlal_s16(vld1q_s32(pOut), vld1_s16(pIn), Vol));
+		vst1q_s32(pOut+4, vmlal_s16(vld1q_s32(pOut+4), vld1_s16(pIn+4), Vol));
+	}
+	MixStereoScalar(pOut, pIn, Frames-i, LVol, RVol);
+}
+
+void CSoundMix::Finish(short *pOut, const int *pIn, unsigned Frames, int MasterVol)
+{
+	const float32x4_t Scale = vdupq_n_f32(FinishScale(MasterVol));
+	const int16x8_t Min = vdupq_n_s16(-0x7fff);
+	unsigned i = 0;
+	for(; i+8 <= Frames*2; i += 8)
+	{
+		int32x4_t a = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vld1q_s32(pIn+i)), Scale));
+		int32x4_t b = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(vld1q_s32(pIn+i+4)), Scale));
+		vst1q_s16(pOut+i, vmaxq_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)), Min));
+	}
+	FinishScalar(pOut+i, pIn+i, Frames-i/2, MasterVol);
+}
+
+const char *CSoundMix::Implementation() { return "neon"; }
+
+#else
+
+void CSoundMix::MixMono(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol) { MixMonoScalar(pOut, pIn, Frames, LVol, RVol); }
+void CSoundMix::MixStereo(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol) { MixStereoScalar(pOut, pIn, Frames, LVol, RVol); }
+void CSoundMix::Finish(short *pOut, const int *pIn, unsigned Frames, int MasterVol) { FinishScalar(pOut, pIn, Frames, MasterVol); }
+
+const char *CSoundMix::Implementation() { return "scalar"; }
+
+#endif
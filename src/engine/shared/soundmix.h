@@ -0,0 +1,27 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_SHARED_SOUNDMIX_H
+#define ENGINE_SHARED_SOUNDMIX_H
+
+// the inner loops of the sound mixer. voices are added to an interleaved
+// stereo int buffer which gets scaled and clamped to 16 bit at the end.
+// they don't need an audio device, so tools can run them on plain buffers
+class CSoundMix
+{
+public:
+	// adds Frames frames of pIn, scaled by LVol and RVol (0 - 255), to pOut
+	static void MixMono(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol);
+	static void MixStereo(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol);
+
+	// applies the master volume (0 - 100) and clamps to -0x7fff - 0x7fff
+	static void Finish(short *pOut, const int *pIn, unsigned Frames, int MasterVol);
+
+	// one sample at a time, the others have to give the same results
+	static void MixMonoScalar(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol);
+	static void MixStereoScalar(int *pOut, const short *pIn, unsigned Frames, int LVol, int RVol);
+	static void FinishScalar(short *pOut, const int *pIn, unsigned Frames, int MasterVol);
+
+	static const char *Implementation();
+};
+
+#endif
@@ -52,11 +52,21 @@ public:
 	virtual int TextLineCount(void *pFontSetV, float Size, const char *pText, float LineWidth) = 0;
 };
 
+struct CTextLayoutStats
+{
+	int m_Hits;
+	int m_Misses;
+	int64 m_SavedTime; // layout time of the hits, in time_get() units
+};
+
 class IEngineTextRender : public ITextRender
 {
 	MACRO_INTERFACE("enginetextrender", 0)
 public:
 	virtual void Init() = 0;
+
+	// counted since the start
+	virtual void GetLayoutStats(CTextLayoutStats *pStats) = 0;
 };
 
 extern IEngineTextRender *CreateEngineTextRender();
@@ -338,6 +338,8 @@ void CGameClient::OnReset()
 {
 	// clear out the invalid pointers
 	m_LastNewPredictedTick = -1;
+	m_PredictionSnapTick = -1;
+	m_NumPredictedTicks = 0;
 	mem_zero(&g_GameClient.m_Snap, sizeof(g_GameClient.m_Snap));
 
 	for(int i = 0; i < MAX_CLIENTS; i++)
@@ -493,6 +495,7 @@ void CGameClient::OnMessage(int MsgId, CUnpacker *pUnpacker)
 
 		// apply new tuning
 		m_Tuning = NewTuning;
+		m_PredictionSnapTick = -1;
 		return;
 	}
 
@@ -886,6 +889,54 @@ void CGameClient::OnNewSnapshot()
 	}
 }
 
+void CGameClient::GetPredictionInput(int Tick, CNetObj_PlayerInput *pInput)
+{
+	mem_zero(pInput, sizeof(*pInput));
+	int *pData = Client()->GetInput(Tick);
+	if(pData)
+		*pInput = *((CNetObj_PlayerInput*)pData);
+}
+
+// a new snapshot that agrees with what was predicted for its tick lets the
+// prediction continue from there
+bool CGameClient::SnapMatchesPrediction(int Tick)
+{
+	CPredictedTick *pPredicted = &m_aPredictedTicks[Tick%PREDICTION_CACHE_SIZE];
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_Snap.m_aCharacters[i].m_Active != pPredicted->m_aActive[i])
+			return false;
+		if(!pPredicted->m_aActive[i])
+			continue;
+
+		// the tick field isn't part of the core state
+		const CNetObj_CharacterCore *pSnapCore = &m_Snap.m_aCharacters[i].m_Cur;
+		CNetObj_CharacterCore Core;
+		pPredicted->m_aCores[i].Write(&Core);
+		Core.m_Tick = pSnapCore->m_Tick;
+		if(mem_comp(&Core, pSnapCore, sizeof(Core)) != 0)
+			return false;
+	}
+	return true;
+}
+
+void CGameClient::LoadPrediction(CWorldCore *pWorld, int Tick)
+{
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		pWorld->m_apCharacters[i] = 0;
+		if(!m_Snap.m_aCharacters[i].m_Active)
+			continue;
+
+		if(Tick == Client()->GameTick())
+			m_aClients[i].m_Predicted.Read(&m_Snap.m_aCharacters[i].m_Cur);
+		else
+			m_aClients[i].m_Predicted = m_aPredictedTicks[Tick%PREDICTION_CACHE_SIZE].m_aCores[i];
+		m_aClients[i].m_Predicted.Init(pWorld, Collision());
+		pWorld->m_apCharacters[i] = &m_aClients[i].m_Predicted;
+	}
+}
+
 void CGameClient::OnPredict()
 {
 	// store the previous values so we can detect prediction errors
@@ -910,24 +961,50 @@ void CGameClient::OnPredict()
 	CWorldCore World;
 	World.m_Tuning = m_Tuning;
 
-	// search for players
-	for(int i = 0; i < MAX_CLIENTS; i++)
+	// find out how much of the last prediction still holds
+	int GameTick = Client()->GameTick();
+	int PredTick = Client()->PredGameTick();
+	bool UseCache = PredTick-GameTick < PREDICTION_CACHE_SIZE;
+	int StartTick = GameTick;
+	if(!UseCache || m_PredictionSnapTick == -1 || GameTick > m_PredictionLastTick ||
+		(GameTick != m_PredictionSnapTick && !SnapMatchesPrediction(GameTick)))
+		m_PredictionLastTick = GameTick;
+	else
 	{
-		if(!m_Snap.m_aCharacters[i].m_Active)
-			continue;
+		for(; StartTick < min(m_PredictionLastTick, PredTick); StartTick++)
+		{
+			CNetObj_PlayerInput Input;
+			GetPredictionInput(StartTick+1, &Input);
+			if(mem_comp(&Input, &m_aPredictedTicks[(StartTick+1)%PREDICTION_CACHE_SIZE].m_Input, sizeof(Input)) != 0)
+			{
+				m_PredictionLastTick = StartTick;
+				break;
+			}
+		}
+	}
+	m_PredictionSnapTick = UseCache ? GameTick : -1;
 
-		g_GameClient.m_aClients[i].m_Predicted.Init(&World, Collision());
-		World.m_apCharacters[i] = &g_GameClient.m_aClients[i].m_Predicted;
-		g_GameClient.m_aClients[i].m_Predicted.Read(&m_Snap.m_aCharacters[i].m_Cur);
+	// fetch the local from the ticks that don't need to be predicted again
+	if(PredTick > GameTick && PredTick-1 <= StartTick)
+	{
+		LoadPrediction(&World, PredTick-1);
+		m_PredictedPrevChar = m_aClients[m_Snap.m_LocalClientID].m_Predicted;
 	}
+	LoadPrediction(&World, StartTick);
+	if(PredTick > GameTick && PredTick <= StartTick)
+		m_PredictedChar = m_aClients[m_Snap.m_LocalClientID].m_Predicted;
 
 	// predict
-	for(int Tick = Client()->GameTick()+1; Tick <= Client()->PredGameTick(); Tick++)
+	m_NumPredictedTicks = 0;
+	for(int Tick = StartTick+1; Tick <= PredTick; Tick++)
 	{
 		// fetch the local
-		if(Tick == Client()->PredGameTick() && World.m_apCharacters[m_Snap.m_LocalClientID])
+		if(Tick == PredTick && World.m_apCharacters[m_Snap.m_LocalClientID])
 			m_PredictedPrevChar = *World.m_apCharacters[m_Snap.m_LocalClientID];
 
+		CNetObj_PlayerInput Input;
+		GetPredictionInput(Tick, &Input);
+
 		// first calculate where everyone should move
 		for(int c = 0; c < MAX_CLIENTS; c++)
 		{
@@ -938,9 +1015,7 @@ void CGameClient::OnPredict()
 			if(m_Snap.m_LocalClientID == c)
 			{
 				// apply player input
-				int *pInput = Client()->GetInput(Tick);
-				if(pInput)
-					World.m_apCharacters[c]->m_Input = *((CNetObj_PlayerInput*)pInput);
+				World.m_apCharacters[c]->m_Input = Input;
 				World.m_apCharacters[c]->Tick(true);
 			}
 			else
@@ -957,6 +1032,21 @@ void CGameClient::OnPredict()
 			World.m_apCharacters[c]->Move();
 			World.m_apCharacters[c]->Quantize();
 		}
+		m_NumPredictedTicks++;
+
+		// keep the tick for the next frames
+		if(UseCache)
+		{
+			CPredictedTick *pPredicted = &m_aPredictedTicks[Tick%PREDICTION_CACHE_SIZE];
+			pPredicted->m_Input = Input;
+			for(int c = 0; c < MAX_CLIENTS; c++)
+			{
+				pPredicted->m_aActive[c] = World.m_apCharacters[c] != 0;
+				if(World.m_apCharacters[c])
+					pPredicted->m_aCores[c] = *World.m_apCharacters[c];
+			}
+			m_PredictionLastTick = Tick;
+		}
 
 		// check if we want to trigger effects
 		if(Tick > m_LastNewPredictedTick)
@@ -984,7 +1074,7 @@ void CGameClient::OnPredict()
 			}
 		}
 
-		if(Tick == Client()->PredGameTick() && World.m_apCharacters[m_Snap.m_LocalClientID])
+		if(Tick == PredTick && World.m_apCharacters[m_Snap.m_LocalClientID])
 			m_PredictedChar = *World.m_apCharacters[m_Snap.m_LocalClientID];
 	}
 
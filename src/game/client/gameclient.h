@@ -56,6 +56,28 @@ class CGameClient : public IGameClient
 	int m_PredictedTick;
 	int m_LastNewPredictedTick;
 
+	// predicted ticks are kept between frames, a frame only simulates from
+	// the first tick whose snapshot or local input changed
+	enum
+	{
+		PREDICTION_CACHE_SIZE=64,
+	};
+
+	struct CPredictedTick
+	{
+		CNetObj_PlayerInput m_Input;
+		bool m_aActive[MAX_CLIENTS];
+		CCharacterCore m_aCores[MAX_CLIENTS];
+	};
+
+	CPredictedTick m_aPredictedTicks[PREDICTION_CACHE_SIZE];
+	int m_PredictionSnapTick;
+	int m_PredictionLastTick;
+
+	void GetPredictionInput(int Tick, CNetObj_PlayerInput *pInput);
+	bool SnapMatchesPrediction(int Tick);
+	void LoadPrediction(CWorldCore *pWorld, int Tick);
+
 	int64 m_LastSendInfo;
 
 	static void ConTeam(IConsole::IResult *pResult, void *pUserData);
@@ -89,6 +111,7 @@ public:
 	bool m_SuppressEvents;
 	bool m_NewTick;
 	bool m_NewPredictedTick;
+	int m_NumPredictedTicks;
 	int m_FlagDropTick[2];
 
 	// TODO: move this
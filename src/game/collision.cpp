@@ -65,26 +65,57 @@ bool CCollision::IsTileSolid(int x, int y)
 	return GetTile(x, y)&COLFLAG_SOLID;
 }
 
-// TODO: rewrite this smarter!
+int CCollision::GetTileIndex(vec2 Pos)
+{
+	int Nx = clamp(round_to_int(Pos.x)/32, 0, m_Width-1);
+	int Ny = clamp(round_to_int(Pos.y)/32, 0, m_Height-1);
+	return Ny*m_Width+Nx;
+}
+
+// the line is checked at every pixel like it always was, but all the
+// points that fall into the same tile are skipped at once
 int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
 {
 	float Distance = distance(Pos0, Pos1);
 	int End(Distance+1);
-	vec2 Last = Pos0;
+	vec2 Delta = Pos1-Pos0;
 
-	for(int i = 0; i < End; i++)
+	int i = 0;
+	while(i < End)
 	{
 		float a = i/Distance;
 		vec2 Pos = mix(Pos0, Pos1, a);
-		if(CheckPoint(Pos.x, Pos.y))
+		int Tile = GetTileIndex(Pos);
+		int Index = m_pTiles[Tile].m_Index;
+		if(Index <= 128 && (Index&COLFLAG_SOLID))
 		{
 			if(pOutCollision)
 				*pOutCollision = Pos;
 			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
+				*pOutBeforeCollision = i ? mix(Pos0, Pos1, (i-1)/Distance) : Pos0;
 			return GetCollisionAt(Pos.x, Pos.y);
 		}
-		Last = Pos;
+
+		// estimate the first point in another tile from where the line
+		// leaves this one, then correct it with the points themselves
+		int Nx = Tile%m_Width;
+		int Ny = Tile/m_Width;
+		float Leave = End;
+		if(Delta.x > 0 && Nx < m_Width-1)
+			Leave = min(Leave, ((Nx+1)*32-0.5f-Pos0.x)/Delta.x*Distance);
+		else if(Delta.x < 0 && Nx > 0)
+			Leave = min(Leave, (Nx*32-0.5f-Pos0.x)/Delta.x*Distance);
+		if(Delta.y > 0 && Ny < m_Height-1)
+			Leave = min(Leave, ((Ny+1)*32-0.5f-Pos0.y)/Delta.y*Distance);
+		else if(Delta.y < 0 && Ny > 0)
+			Leave = min(Leave, (Ny*32-0.5f-Pos0.y)/Delta.y*Distance);
+
+		int Next = Leave < End ? max(i+1, (int)Leave) : End;
+		while(Next > i+1 && GetTileIndex(mix(Pos0, Pos1, (Next-1)/Distance)) != Tile)
+			Next--;
+		while(Next < End && GetTileIndex(mix(Pos0, Pos1, Next/Distance)) == Tile)
+			Next++;
+		i = Next;
 	}
 	if(pOutCollision)
 		*pOutCollision = Pos1;
@@ -216,6 +247,23 @@ void CCollision::MovePoint(vec2 *pInoutPos, vec2 *pInoutVel, float Elasticity, i
 	}
 }
 
+// checks every tile a point in the area could round to
+bool CCollision::TestArea(vec2 Min, vec2 Max)
+{
+	int StartX = clamp(round_to_int(Min.x)/32, 0, m_Width-1);
+	int StartY = clamp(round_to_int(Min.y)/32, 0, m_Height-1);
+	int EndX = clamp(round_to_int(Max.x)/32, 0, m_Width-1);
+	int EndY = clamp(round_to_int(Max.y)/32, 0, m_Height-1);
+	for(int y = StartY; y <= EndY; y++)
+		for(int x = StartX; x <= EndX; x++)
+		{
+			int Index = m_pTiles[y*m_Width+x].m_Index;
+			if(Index <= 128 && Index&COLFLAG_SOLID)
+				return true;
+		}
+	return false;
+}
+
 bool CCollision::TestBox(vec2 Pos, vec2 Size)
 {
 	Size *= 0.5f;
@@ -239,6 +287,26 @@ void CCollision::MoveBox(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, float Elas
 	float Distance = length(Vel);
 	int Max = (int)Distance;
 
+	if(Max > 1)
+	{
+		// without a collision the box just moves in equal steps. walk them and
+		// if the area spanned by the start and the end is free no step could
+		// have hit anything, the steps are monotonic on both axes
+		float Fraction = 1.0f/(float)(Max+1);
+		vec2 EndPos = Pos;
+		for(int i = 0; i <= Max; i++)
+			EndPos = EndPos + Vel*Fraction;
+
+		vec2 HalfSize = Size*0.5f;
+		vec2 AreaMin = vec2(min(Pos.x, EndPos.x), min(Pos.y, EndPos.y)) - HalfSize;
+		vec2 AreaMax = vec2(max(Pos.x, EndPos.x), max(Pos.y, EndPos.y)) + HalfSize;
+		if(!TestArea(AreaMin, AreaMax))
+		{
+			*pInoutPos = EndPos;
+			return;
+		}
+	}
+
 	if(Distance > 0.00001f)
 	{
 		//vec2 old_pos = pos;
@@ -14,6 +14,7 @@ class CCollision
 
 	bool IsTileSolid(int x, int y);
 	int GetTile(int x, int y);
+	int GetTileIndex(vec2 Pos);
 
 public:
 	enum
@@ -35,6 +36,7 @@ public:
 	void MovePoint(vec2 *pInoutPos, vec2 *pInoutVel, float Elasticity, int *pBounces);
 	void MoveBox(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, float Elasticity);
 	bool TestBox(vec2 Pos, vec2 Size);
+	bool TestArea(vec2 Min, vec2 Max);
 };
 
 #endif
@@ -0,0 +1,162 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "corerecord.h"
+
+const char CCoreRecord::ms_aMarker[8] = "TWCORE";
+
+CCoreRecorder::CCoreRecorder()
+{
+	m_File = 0;
+}
+
+bool CCoreRecorder::Start(IOHANDLE File, const char *pMapName, const CTuningParams *pTuning)
+{
+	Stop();
+	if(!File)
+		return false;
+
+	CCoreRecord::CHeader Header;
+	mem_zero(&Header, sizeof(Header));
+	mem_copy(Header.m_aMarker, CCoreRecord::ms_aMarker, sizeof(Header.m_aMarker));
+	Header.m_Version = CCoreRecord::VERSION;
+	str_copy(Header.m_aMapName, pMapName, sizeof(Header.m_aMapName));
+	Header.m_Tuning = *pTuning;
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(&Header.m_Version, sizeof(int), 1);
+	swap_endian(&Header.m_Tuning, sizeof(int), sizeof(Header.m_Tuning)/sizeof(int));
+#endif
+	io_write(File, &Header, sizeof(Header));
+
+	m_File = File;
+	mem_zero(m_aLastInput, sizeof(m_aLastInput));
+	return true;
+}
+
+void CCoreRecorder::Stop()
+{
+	if(!m_File)
+		return;
+	io_close(m_File);
+	m_File = 0;
+}
+
+void CCoreRecorder::Write(CCoreRecord::CRecord *pRecord)
+{
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(pRecord, sizeof(int), sizeof(*pRecord)/sizeof(int));
+#endif
+	io_write(m_File, pRecord, sizeof(*pRecord));
+}
+
+void CCoreRecorder::RecordSpawn(int Tick, int ClientID, vec2 Pos)
+{
+	if(!m_File)
+		return;
+
+	CCoreRecord::CRecord Record = {Tick, ClientID, CCoreRecord::RECORD_SPAWN, {0}};
+	Record.m_aData[0] = CCoreRecord::PackFloat(Pos.x);
+	Record.m_aData[1] = CCoreRecord::PackFloat(Pos.y);
+	Write(&Record);
+
+	// a new character starts with an empty input
+	mem_zero(&m_aLastInput[ClientID], sizeof(m_aLastInput[ClientID]));
+}
+
+void CCoreRecorder::RecordDeath(int Tick, int ClientID)
+{
+	if(!m_File)
+		return;
+
+	CCoreRecord::CRecord Record = {Tick, ClientID, CCoreRecord::RECORD_DEATH, {0}};
+	Write(&Record);
+}
+
+void CCoreRecorder::RecordInput(int Tick, int ClientID, const CNetObj_PlayerInput *pInput)
+{
+	// only changes are recorded, the replay keeps the last one
+	if(!m_File || mem_comp(&m_aLastInput[ClientID], pInput, sizeof(*pInput)) == 0)
+		return;
+	m_aLastInput[ClientID] = *pInput;
+
+	CCoreRecord::CRecord Record = {Tick, ClientID, CCoreRecord::RECORD_INPUT, {0}};
+	mem_copy(Record.m_aData, pInput, sizeof(*pInput));
+	Write(&Record);
+}
+
+void CCoreRecorder::RecordProjectile(int Tick, int Owner, int Type, vec2 Pos, vec2 Dir, int LifeSpan)
+{
+	if(!m_File)
+		return;
+
+	CCoreRecord::CRecord Record = {Tick, Owner, CCoreRecord::RECORD_PROJECTILE, {0}};
+	Record.m_aData[0] = Type;
+	Record.m_aData[1] = CCoreRecord::PackFloat(Pos.x);
+	Record.m_aData[2] = CCoreRecord::PackFloat(Pos.y);
+	Record.m_aData[3] = CCoreRecord::PackFloat(Dir.x);
+	Record.m_aData[4] = CCoreRecord::PackFloat(Dir.y);
+	Record.m_aData[5] = LifeSpan;
+	Write(&Record);
+}
+
+void CCoreRecorder::RecordLaser(int Tick, int Owner, vec2 Pos, vec2 Dir, float Energy)
+{
+	if(!m_File)
+		return;
+
+	CCoreRecord::CRecord Record = {Tick, Owner, CCoreRecord::RECORD_LASER, {0}};
+	Record.m_aData[0] = CCoreRecord::PackFloat(Pos.x);
+	Record.m_aData[1] = CCoreRecord::PackFloat(Pos.y);
+	Record.m_aData[2] = CCoreRecord::PackFloat(Dir.x);
+	Record.m_aData[3] = CCoreRecord::PackFloat(Dir.y);
+	Record.m_aData[4] = CCoreRecord::PackFloat(Energy);
+	Write(&Record);
+}
+
+CCoreRecordReader::CCoreRecordReader()
+{
+	m_pRecords = 0;
+	m_NumRecords = 0;
+}
+
+CCoreRecordReader::~CCoreRecordReader()
+{
+	mem_free(m_pRecords);
+}
+
+bool CCoreRecordReader::Load(IOHANDLE File)
+{
+	mem_free(m_pRecords);
+	m_pRecords = 0;
+	m_NumRecords = 0;
+
+	long Size = io_length(File);
+	if(Size < (long)sizeof(m_Header) || io_read(File, &m_Header, sizeof(m_Header)) != sizeof(m_Header))
+		return false;
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(&m_Header.m_Version, sizeof(int), 1);
+	swap_endian(&m_Header.m_Tuning, sizeof(int), sizeof(m_Header.m_Tuning)/sizeof(int));
+#endif
+	if(mem_comp(m_Header.m_aMarker, CCoreRecord::ms_aMarker, sizeof(m_Header.m_aMarker)) != 0 || m_Header.m_Version != CCoreRecord::VERSION)
+		return false;
+	m_Header.m_aMapName[sizeof(m_Header.m_aMapName)-1] = 0;
+
+	int NumRecords = (Size-sizeof(m_Header))/sizeof(CCoreRecord::CRecord);
+	m_pRecords = (CCoreRecord::CRecord *)mem_alloc(max(NumRecords, 1)*sizeof(CCoreRecord::CRecord), 1);
+	m_NumRecords = io_read(File, m_pRecords, NumRecords*sizeof(CCoreRecord::CRecord))/sizeof(CCoreRecord::CRecord);
+#if defined(CONF_ARCH_ENDIAN_BIG)
+	swap_endian(m_pRecords, sizeof(int), m_NumRecords*sizeof(CCoreRecord::CRecord)/sizeof(int));
+#endif
+
+	// drop whatever doesn't make sense
+	int Num = 0;
+	for(int i = 0; i < m_NumRecords; i++)
+	{
+		CCoreRecord::CRecord *pRecord = &m_pRecords[i];
+		if(pRecord->m_ClientID < 0 || pRecord->m_ClientID >= MAX_CLIENTS || pRecord->m_Type < CCoreRecord::RECORD_SPAWN ||
+			pRecord->m_Type > CCoreRecord::RECORD_LASER || (Num && pRecord->m_Tick < m_pRecords[Num-1].m_Tick))
+			continue;
+		m_pRecords[Num++] = *pRecord;
+	}
+	m_NumRecords = Num;
+	return true;
+}
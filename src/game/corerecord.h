@@ -0,0 +1,87 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_CORERECORD_H
+#define GAME_CORERECORD_H
+
+#include <base/system.h>
+#include <base/vmath.h>
+
+#include "gamecore.h"
+
+// what went into the character cores on a server: spawns, deaths, inputs,
+// projectiles and lasers. the core_replay tool plays it back to measure
+// the physics in isolation
+class CCoreRecord
+{
+public:
+	enum
+	{
+		VERSION=1,
+		MAX_DATA=13,
+
+		RECORD_SPAWN=0,
+		RECORD_DEATH,
+		RECORD_INPUT,
+		RECORD_PROJECTILE,
+		RECORD_LASER,
+	};
+
+	struct CHeader
+	{
+		char m_aMarker[8];
+		int m_Version;
+		char m_aMapName[64];
+		CTuningParams m_Tuning;
+	};
+
+	struct CRecord
+	{
+		int m_Tick;
+		int m_ClientID;
+		int m_Type;
+		int m_aData[MAX_DATA];
+	};
+
+	// floats are stored by their bits so the replay is exact
+	static int PackFloat(float Value) { int i; mem_copy(&i, &Value, sizeof(i)); return i; }
+	static float UnpackFloat(int Value) { float f; mem_copy(&f, &Value, sizeof(f)); return f; }
+
+	static const char ms_aMarker[8];
+};
+
+class CCoreRecorder
+{
+	IOHANDLE m_File;
+	CNetObj_PlayerInput m_aLastInput[MAX_CLIENTS];
+
+	void Write(CCoreRecord::CRecord *pRecord);
+
+public:
+	CCoreRecorder();
+
+	bool Start(IOHANDLE File, const char *pMapName, const CTuningParams *pTuning);
+	void Stop();
+	bool IsRecording() const { return m_File != 0; }
+
+	void RecordSpawn(int Tick, int ClientID, vec2 Pos);
+	void RecordDeath(int Tick, int ClientID);
+	void RecordInput(int Tick, int ClientID, const CNetObj_PlayerInput *pInput);
+	void RecordProjectile(int Tick, int Owner, int Type, vec2 Pos, vec2 Dir, int LifeSpan);
+	void RecordLaser(int Tick, int Owner, vec2 Pos, vec2 Dir, float Energy);
+};
+
+class CCoreRecordReader
+{
+public:
+	CCoreRecord::CHeader m_Header;
+	CCoreRecord::CRecord *m_pRecords;
+	int m_NumRecords;
+
+	CCoreRecordReader();
+	~CCoreRecordReader();
+
+	// takes the whole file, records are ordered by tick
+	bool Load(IOHANDLE File);
+};
+
+#endif
@@ -485,6 +485,7 @@ class CEditor : public IEditor
 	class IGraphics *m_pGraphics;
 	class ITextRender *m_pTextRender;
 	class IStorage *m_pStorage;
+	class IEngine *m_pEngine;
 	CRenderTools m_RenderTools;
 	CUI m_UI;
 public:
@@ -494,6 +495,7 @@ public:
 	class IGraphics *Graphics() { return m_pGraphics; };
 	class ITextRender *TextRender() { return m_pTextRender; };
 	class IStorage *Storage() { return m_pStorage; };
+	class IEngine *Engine() { return m_pEngine; };
 	CUI *UI() { return &m_UI; }
 	CRenderTools *RenderTools() { return &m_RenderTools; }
 
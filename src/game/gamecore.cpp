@@ -210,12 +210,19 @@ void CCharacterCore::Tick(bool UseInput)
 		if(m_pWorld && m_pWorld->m_Tuning.m_PlayerHooking)
 		{
 			float Distance = 0.0f;
+			float Reach = PhysSize+3.0f;
+			vec2 BoxMin = vec2(min(m_HookPos.x, NewPos.x)-Reach, min(m_HookPos.y, NewPos.y)-Reach);
+			vec2 BoxMax = vec2(max(m_HookPos.x, NewPos.x)+Reach, max(m_HookPos.y, NewPos.y)+Reach);
 			for(int i = 0; i < MAX_CLIENTS; i++)
 			{
 				CCharacterCore *pCharCore = m_pWorld->m_apCharacters[i];
 				if(!pCharCore || pCharCore == this)
 					continue;
 
+				// players outside the box around the hook segment can't be hit
+				if(pCharCore->m_Pos.x < BoxMin.x || pCharCore->m_Pos.x > BoxMax.x || pCharCore->m_Pos.y < BoxMin.y || pCharCore->m_Pos.y > BoxMax.y)
+					continue;
+
 				vec2 ClosestPoint = closest_point_on_line(m_HookPos, NewPos, pCharCore->m_Pos);
 				if(distance(pCharCore->m_Pos, ClosestPoint) < PhysSize+2.0f)
 				{
@@ -314,6 +321,10 @@ void CCharacterCore::Tick(bool UseInput)
 			if(pCharCore == this) // || !(p->flags&FLAG_ALIVE)
 				continue; // make sure that we don't nudge our self
 
+			// only the hooked player and close ones have any influence
+			if(m_HookedPlayer != i && (absolute(m_Pos.x-pCharCore->m_Pos.x) >= PhysSize*1.25f || absolute(m_Pos.y-pCharCore->m_Pos.y) >= PhysSize*1.25f))
+				continue;
+
 			// handle player <-> player collision
 			float Distance = distance(m_Pos, pCharCore->m_Pos);
 			vec2 Dir = normalize(m_Pos - pCharCore->m_Pos);
@@ -369,30 +380,69 @@ void CCharacterCore::Move()
 
 	if(m_pWorld && m_pWorld->m_Tuning.m_PlayerCollision)
 	{
-		// check player collision
+		// gather the players close to the movement first, the others can't be touched
+		CCharacterCore *apCloseChars[MAX_CLIENTS];
+		int NumCloseChars = 0;
+		vec2 BoxMin = vec2(min(m_Pos.x, NewPos.x)-29.0f, min(m_Pos.y, NewPos.y)-29.0f);
+		vec2 BoxMax = vec2(max(m_Pos.x, NewPos.x)+29.0f, max(m_Pos.y, NewPos.y)+29.0f);
+		for(int p = 0; p < MAX_CLIENTS; p++)
+		{
+			CCharacterCore *pCharCore = m_pWorld->m_apCharacters[p];
+			if(!pCharCore || pCharCore == this)
+				continue;
+			if(pCharCore->m_Pos.x < BoxMin.x || pCharCore->m_Pos.x > BoxMax.x || pCharCore->m_Pos.y < BoxMin.y || pCharCore->m_Pos.y > BoxMax.y)
+				continue;
+			apCloseChars[NumCloseChars++] = pCharCore;
+		}
+
+		// the movement used to be walked pixel by pixel, testing every close player
+		// at each step. instead the range of steps that could touch a player is
+		// solved for and only those steps are tested, so the result is the same
 		float Distance = distance(m_Pos, NewPos);
-		int End = Distance+1;
-		vec2 LastPos = m_Pos;
-		for(int i = 0; i < End; i++)
+		int End = NumCloseChars && Distance > 0.0f ? Distance+1 : 0;
+		vec2 Dir = NewPos - m_Pos;
+		int First = End;
+		for(int p = 0; p < NumCloseChars; p++)
 		{
-			float a = i/Distance;
-			vec2 Pos = mix(m_Pos, NewPos, a);
-			for(int p = 0; p < MAX_CLIENTS; p++)
+			// steps i with |m_Pos + Dir*i/Distance - Pos| < 28, with a little slack
+			vec2 Rel = m_Pos - apCloseChars[p]->m_Pos;
+			double B = (double)Dir.x*Rel.x + (double)Dir.y*Rel.y;
+			double C = (double)Rel.x*Rel.x + (double)Rel.y*Rel.y - 28.5*28.5;
+			double Det = B*B - (double)Distance*Distance*C;
+			if(Det < 0.0)
+				continue;
+			double Root = sqrt(Det);
+			int Start = max(0, (int)clamp((-B-Root)/Distance, -1.0, (double)End)-1);
+			int Stop = min(First, (int)clamp((-B+Root)/Distance, -1.0, (double)End)+2);
+			for(int i = Start; i < Stop; i++)
 			{
-				CCharacterCore *pCharCore = m_pWorld->m_apCharacters[p];
-				if(!pCharCore || pCharCore == this)
-					continue;
-				float D = distance(Pos, pCharCore->m_Pos);
+				float D = distance(mix(m_Pos, NewPos, i/Distance), apCloseChars[p]->m_Pos);
 				if(D < 28.0f && D > 0.0f)
 				{
-					if(a > 0.0f)
-						m_Pos = LastPos;
-					else if(distance(NewPos, pCharCore->m_Pos) > D)
+					First = i;
+					break;
+				}
+			}
+		}
+
+		if(First == 0)
+		{
+			// already touching someone, only move if it gets us away from them
+			for(int p = 0; p < NumCloseChars; p++)
+			{
+				float D = distance(m_Pos, apCloseChars[p]->m_Pos);
+				if(D < 28.0f && D > 0.0f)
+				{
+					if(distance(NewPos, apCloseChars[p]->m_Pos) > D)
 						m_Pos = NewPos;
 					return;
 				}
 			}
-			LastPos = Pos;
+		}
+		else if(First < End)
+		{
+			m_Pos = mix(m_Pos, NewPos, (First-1)/Distance);
+			return;
 		}
 	}
 
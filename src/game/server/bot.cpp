@@ -60,7 +60,7 @@ void CBot::OnReset()
 void CBot::UpdateTargetOrder()
 {
 	//int *pGenome = m_Genetics.GetGenome();
-	const int *pGenome = &g_aBotPriority[m_pPlayer->GetCID()][0];
+	const int *pGenome = &g_aBotPriority[m_pPlayer->GetCID()%(sizeof(g_aBotPriority)/sizeof(g_aBotPriority[0]))][0];
 	// const int *pGenome = &g_aBotPriority[random_int_range(0, MAX_CLIENTS - 1)][0];
 	for(int i = 0 ; i < CTarget::NUM_TARGETS ; i++)
 	{
@@ -76,15 +76,7 @@ void CBot::UpdateTargetOrder()
 
 vec2 CBot::ClosestCharacter()
 {
-	float d = -1;
-	vec2 Pos = vec2(0,0);
-	for(int c = 0; c < MAX_CLIENTS; c++)
-		if(c != m_pPlayer->GetCID() && GameServer()->m_apPlayers[c] && GameServer()->m_apPlayers[c]->GetCharacter() && (d < -1 || d > distance(m_pPlayer->GetCharacter()->GetPos(),GameServer()->m_apPlayers[c]->GetCharacter()->GetPos())))
-		{
-			d = distance(m_pPlayer->GetCharacter()->GetPos(),GameServer()->m_apPlayers[c]->GetCharacter()->GetPos());
-			Pos = GameServer()->m_apPlayers[c]->GetCharacter()->GetPos();
-		}
-	return Pos;
+	return BotEngine()->GetClosestCharacterPos(m_pPlayer->GetCID());
 }
 
 void CBot::UpdateTarget()
@@ -178,19 +170,26 @@ void CBot::UpdateTarget()
 			case CTarget::TARGET_PLAYER:
 				{
 					int Team = m_pPlayer->GetTeam();
+					bool Teamplay = GameServer()->m_pController->IsTeamplay();
 					int Count = 0;
 					for(int c = 0; c < MAX_CLIENTS; c++)
-						if(c != m_pPlayer->GetCID() && GameServer()->m_apPlayers[c] && GameServer()->m_apPlayers[c]->GetCharacter() && (GameServer()->m_apPlayers[c]->GetTeam() != Team || !GameServer()->m_pController->IsTeamplay()))
+					{
+						const CBotEngine::CCharacterInfo *pInfo = BotEngine()->GetCharacter(c);
+						if(c != m_pPlayer->GetCID() && pInfo->m_Alive && (pInfo->m_Team != Team || !Teamplay))
 							Count++;
+					}
 					if(Count)
 					{
 						Count = random_int()%Count+1;
 						int c = 0;
 						for(; Count; c++)
-							if(c != m_pPlayer->GetCID() && GameServer()->m_apPlayers[c] && GameServer()->m_apPlayers[c]->GetCharacter() && (GameServer()->m_apPlayers[c]->GetTeam() != Team || !GameServer()->m_pController->IsTeamplay()))
+						{
+							const CBotEngine::CCharacterInfo *pInfo = BotEngine()->GetCharacter(c);
+							if(c != m_pPlayer->GetCID() && pInfo->m_Alive && (pInfo->m_Team != Team || !Teamplay))
 								Count--;
+						}
 						c--;
-						m_ComputeTarget.m_Pos = GameServer()->m_apPlayers[c]->GetCharacter()->GetPos();
+						m_ComputeTarget.m_Pos = BotEngine()->GetCharacter(c)->m_Pos;
 						m_ComputeTarget.m_Type = CTarget::TARGET_PLAYER;
 						m_ComputeTarget.m_PlayerCID = c;
 						return;
@@ -223,7 +222,7 @@ void CBot::UpdateTarget()
 	if(m_ComputeTarget.m_Type == CTarget::TARGET_PLAYER)
 	{
 		CPlayer *pPlayer = GameServer()->m_apPlayers[m_ComputeTarget.m_PlayerCID];
-		if(Collision()->FastIntersectLine(m_ComputeTarget.m_Pos, pPlayer->GetCharacter()->GetPos(),0,0))
+		if(BotEngine()->IntersectLine(m_ComputeTarget.m_Pos, pPlayer->GetCharacter()->GetPos(),0,0))
 		{
 			m_ComputeTarget.m_NeedUpdate = true;
 			m_ComputeTarget.m_Pos = pPlayer->GetCharacter()->GetPos();
@@ -273,15 +272,16 @@ bool CBot::FindPickup(int Type, vec2 *pPos, float Radius)
 			SubType = WEAPON_RIFLE;
 			break;
 	}
-	CEntity *pEnt = GameServer()->m_World.FindFirst(CGameWorld::ENTTYPE_PICKUP);
+	const array<CBotEngine::CPickupInfo> &aPickups = BotEngine()->GetPickups();
+	vec2 Pos = m_pPlayer->GetCharacter()->GetPos();
 	bool Found = false;
-	for(;	pEnt; pEnt = pEnt->TypeNext())
+	for(int i = 0; i < aPickups.size(); i++)
 	{
-		CPickup *pPickup = (CPickup *) pEnt;
-		if(pPickup->GetType() == Type && pPickup->GetSubType() == SubType && pPickup->IsSpawned() && Radius > distance(pPickup->GetPos(),m_pPlayer->GetCharacter()->GetPos()) )
+		const CBotEngine::CPickupInfo *pPickup = &aPickups[i];
+		if(pPickup->m_Type == Type && pPickup->m_SubType == SubType && Radius > distance(pPickup->m_Pos, Pos))
 		{
-			*pPos = pPickup->GetPos();
-			Radius = distance(pPickup->GetPos(),m_pPlayer->GetCharacter()->GetPos());
+			*pPos = pPickup->m_Pos;
+			Radius = distance(pPickup->m_Pos, Pos);
 			Found = true;
 		}
 	}
@@ -330,10 +330,10 @@ void CBot::Tick()
 	bool InSight = false;
 	if(m_ComputeTarget.m_Type == CTarget::TARGET_PLAYER)
 	{
-		const CCharacterCore *pClosest = GameServer()->m_apPlayers[m_ComputeTarget.m_PlayerCID]->GetCharacter()->GetCore();
-		InSight = !Collision()->FastIntersectLine(Pos, pClosest->m_Pos, 0, 0);
-		m_Target = pClosest->m_Pos - Pos;
-		m_RealTarget = pClosest->m_Pos;
+		vec2 TargetPos = BotEngine()->GetCharacter(m_ComputeTarget.m_PlayerCID)->m_Pos;
+		InSight = BotEngine()->IsVisible(m_pPlayer->GetCID(), m_ComputeTarget.m_PlayerCID);
+		m_Target = TargetPos - Pos;
+		m_RealTarget = TargetPos;
 	}
 
 	if(g_Config.m_SvBotAllowMove)
@@ -459,7 +459,7 @@ void CBot::HandleHook(bool SeeTarget)
 				vec2 dir = direction(a);
 				vec2 Pos = pMe->m_Pos+dir*Tuning()->m_HookLength;
 
-				if((Collision()->FastIntersectLine(pMe->m_Pos,Pos,&Pos,0) & (CCollision::COLFLAG_SOLID | CCollision::COLFLAG_NOHOOK)) == CCollision::COLFLAG_SOLID)
+				if((BotEngine()->IntersectLine(pMe->m_Pos,Pos,&Pos,0) & (CCollision::COLFLAG_SOLID | CCollision::COLFLAG_NOHOOK)) == CCollision::COLFLAG_SOLID)
 				{
 					vec2 HookVel = dir*GameServer()->Tuning()->m_HookDragAccel;
 
@@ -499,43 +499,41 @@ void CBot::HandleWeapon(bool SeeTarget)
 	if(!pMe)
 		return;
 
+	int CID = m_pPlayer->GetCID();
 	int Team = m_pPlayer->GetTeam();
+	bool Teamplay = GameServer()->m_pController->IsTeamplay();
 	vec2 Pos = pMe->GetCore()->m_Pos;
 
-	CCharacterCore* apTarget[MAX_CLIENTS];
+	int aTargets[MAX_CLIENTS];
 	int Count = 0;
 
 	for(int c = 0 ; c < MAX_CLIENTS ; c++)
 	{
-		if(c == m_pPlayer->GetCID())
+		if(c == CID)
 			continue;
+		const CBotEngine::CCharacterInfo *pInfo = BotEngine()->GetCharacter(c);
 		if(SeeTarget && c == m_ComputeTarget.m_PlayerCID)
 		{
-			apTarget[Count++] = apTarget[0];
-			apTarget[0] =	GameServer()->m_apPlayers[c]->GetCharacter()->GetCore();
+			aTargets[Count++] = aTargets[0];
+			aTargets[0] = c;
 		}
-		else if(GameServer()->m_apPlayers[c] && GameServer()->m_apPlayers[c]->GetCharacter() && (GameServer()->m_apPlayers[c]->GetTeam() != Team || !GameServer()->m_pController->IsTeamplay()))
-			apTarget[Count++] = GameServer()->m_apPlayers[c]->GetCharacter()->GetCore();
+		else if(pInfo->m_Alive && (pInfo->m_Team != Team || !Teamplay))
+			aTargets[Count++] = c;
 	}
 	int Weapon = -1;
 	vec2 Target;
 	for(int c = 0; c < Count; c++)
 	{
-		float ClosestRange = distance(Pos, apTarget[c]->m_Pos);
+		vec2 TargetPos = BotEngine()->GetCharacter(aTargets[c])->m_Pos;
+		float ClosestRange = distance(Pos, TargetPos);
 		float Close = 65.0f;
-		vec2 bVel = pMe->GetCore()->m_Vel / GameServer()->Server()->TickSpeed();
-		vec2 tVel = apTarget[c]->m_Vel / GameServer()->Server()->TickSpeed();
-		vec2 bPos = Pos;
-		vec2 tPos = apTarget[c]->m_Pos;
-		Collision()->FastIntersectLine(bPos, bPos+bVel*g_Config.m_SvBotDelay, 0, &bPos);
-		Collision()->FastIntersectLine(tPos, tPos+tVel*g_Config.m_SvBotDelay, 0, &tPos);
-		Target = tPos - bPos;
+		Target = BotEngine()->GetDelayedPos(aTargets[c]) - BotEngine()->GetDelayedPos(CID);
 		if(ClosestRange < Close)
 		{
 			Weapon = WEAPON_HAMMER;
 			break;
 		}
-		else if(pMe->GetAmmoCount(WEAPON_RIFLE) != 0 && ClosestRange <= (GameServer()->Tuning()->m_LaserReach * ((float)g_Config.m_SvBotReach / 99.99f)) && !Collision()->FastIntersectLine(Pos, apTarget[c]->m_Pos, 0, 0))
+		else if(pMe->GetAmmoCount(WEAPON_RIFLE) != 0 && ClosestRange <= (GameServer()->Tuning()->m_LaserReach * ((float)g_Config.m_SvBotReach / 99.99f)) && BotEngine()->IsVisible(CID, aTargets[c]))
 		{
 			Weapon = WEAPON_RIFLE;
 			break;
@@ -547,10 +545,9 @@ void CBot::HandleWeapon(bool SeeTarget)
 
 		vec2 aProjectilePos[BOT_HOOK_DIRS];
 
-		const int NbLoops = 10;
+		const int NbLoops = BOT_PREDICTION_STEPS;
 
-		vec2 aTargetPos[MAX_CLIENTS];
-		vec2 aTargetVel[MAX_CLIENTS];
+		const vec2 *apTargetPath[MAX_CLIENTS];
 
 		const int Weapons[] = {WEAPON_GRENADE, WEAPON_SHOTGUN, WEAPON_GUN};
 		for(int j = 0 ; j < 3 ; j++)
@@ -584,10 +581,7 @@ void CBot::HandleWeapon(bool SeeTarget)
 			// Curvature *= 0.00001f;
 
 			for(int c = 0; c < Count; c++)
-			{
-				aTargetPos[c] = apTarget[c]->m_Pos;
-				aTargetVel[c] = apTarget[c]->m_Vel*DTick;
-			}
+				apTargetPath[c] = BotEngine()->GetPredictedPath(aTargets[c], Weapons[j], DTick);
 
 			for(int i = 0 ; i < BOT_HOOK_DIRS ; i++) {
 				vec2 dir = direction(2*i*pi / BOT_HOOK_DIRS);
@@ -605,23 +599,17 @@ void CBot::HandleWeapon(bool SeeTarget)
 					// vec2 NextPos = aProjectilePos[i];
 					// NextPos.x += dir.x*DTime;
 					// NextPos.y += dir.y*DTime + Curvature*(DTime*DTime)*(2*k+1);
-					aIsDead[i] = Collision()->FastIntersectLine(aProjectilePos[i], NextPos, &NextPos, 0);
+					aIsDead[i] = BotEngine()->IntersectLine(aProjectilePos[i], NextPos, &NextPos, 0);
 					for(int c = 0; c < Count; c++)
 					{
-						vec2 InterPos = closest_point_on_line(aProjectilePos[i],NextPos, aTargetPos[c]);
-						if(distance(aTargetPos[c], InterPos)< 28) {
+						vec2 InterPos = closest_point_on_line(aProjectilePos[i],NextPos, apTargetPath[c][k]);
+						if(distance(apTargetPath[c][k], InterPos)< 28) {
 							GoodDir = i;
 							break;
 						}
 					}
 					aProjectilePos[i] = NextPos;
 				}
-				for(int c = 0; c < Count; c++)
-				{
-					//Collision()->MoveBox(&aTargetPos[c], &aTargetVel[c], vec2(28.f,28.f), 0);
-					Collision()->FastIntersectLine(aTargetPos[c], aTargetPos[c]+aTargetVel[c], 0, &aTargetPos[c]);
-					aTargetVel[c].y += GameServer()->Tuning()->m_Gravity*DTick*DTick;
-				}
 			}
 			if(GoodDir != -1)
 			{
@@ -747,7 +735,7 @@ void CBot::MakeChoice(bool UseTarget)
 		if(!(pMe->m_Jumped))
 		{
 			vec2 Vel(pMe->m_Vel.x, min(pMe->m_Vel.y, 0.0f));
-			if(Collision()->FastIntersectLine(pMe->m_Pos,pMe->m_Pos+Vel*10.0f,0,0) && !Collision()->FastIntersectLine(pMe->m_Pos,pMe->m_Pos+(Vel-vec2(0,TempWorld.m_Tuning.m_AirJumpImpulse))*10.0f,0,0))
+			if(BotEngine()->IntersectLine(pMe->m_Pos,pMe->m_Pos+Vel*10.0f,0,0) && !BotEngine()->IntersectLine(pMe->m_Pos,pMe->m_Pos+(Vel-vec2(0,TempWorld.m_Tuning.m_AirJumpImpulse))*10.0f,0,0))
 				Flags |= BFLAG_JUMP;
 			if(absolute(m_Target.x) < 28.f && pMe->m_Vel.y > -1.f)
 				Flags |= BFLAG_JUMP;
@@ -89,7 +89,8 @@ inline const char* GetDifficultyName(int difficulty) {
 }
 
 const char g_BotClan[12] = "Love";
-const char g_aBotName[MAX_CLIENTS][16] = {
+// indexed by client id modulo the table size
+const char g_aBotName[][16] = {
 	"[B]Anna",
 	"[B]Bob",
 	"[B]Carlos",
@@ -108,7 +109,7 @@ const char g_aBotName[MAX_CLIENTS][16] = {
 	"[B]Platon"
 };
 
-const int g_aBotPriority[MAX_CLIENTS][8] = {
+const int g_aBotPriority[][8] = {
 	{0,0,0,0,0,0,0,1},
 	{0,0,0,0,0,0,0,1},
 	{0,0,0,0,0,0,0,1},
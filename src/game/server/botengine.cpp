@@ -8,6 +8,9 @@
 
 #include "botengine.h"
 #include "bot.h"
+#include "player.h"
+#include "entities/character.h"
+#include "entities/pickup.h"
 
 CGraph::CGraph()
 {
@@ -115,20 +118,38 @@ CBotEngine::CBotEngine(CGameContext *pGameServer)
 {
 	m_pGameServer = pGameServer;
 	m_pGrid = 0;
+	m_pSolidSum = 0;
+	m_pVisibilityRow = 0;
+	m_pVisibility = 0;
 	m_Triangulation.m_pTriangles = 0;
 	m_Triangulation.m_Size = 0;
 	m_pCorners = 0;
 	m_CornerCount = 0;
 	m_pSegments = 0;
 	m_SegmentCount = 0;
+	m_pSegmentCellStart = 0;
+	m_pSegmentCells = 0;
+	m_SegmentSnapStamp = 0;
 	mem_zero(m_aPaths,sizeof(m_aPaths));
 	mem_zero(m_apBot,sizeof(m_apBot));
+	mem_zero(m_Blackboard.m_aCharacters, sizeof(m_Blackboard.m_aCharacters));
 }
 
 void CBotEngine::Free()
 {
 	if(m_pGrid)
 		mem_free(m_pGrid);
+	m_pGrid = 0;
+
+	if(m_pSolidSum)
+		mem_free(m_pSolidSum);
+	if(m_pVisibilityRow)
+		mem_free(m_pVisibilityRow);
+	if(m_pVisibility)
+		mem_free(m_pVisibility);
+	m_pSolidSum = 0;
+	m_pVisibilityRow = 0;
+	m_pVisibility = 0;
 
 	for (int i = 0; i < m_Triangulation.m_Size; i++)
 		for(int k = 0 ; k < 3; k++)
@@ -152,6 +173,10 @@ void CBotEngine::Free()
 		mem_free(m_pSegments);
 	m_SegmentCount = 0;
 	m_pSegments = 0;
+	mem_free(m_pSegmentCellStart);
+	mem_free(m_pSegmentCells);
+	m_pSegmentCellStart = 0;
+	m_pSegmentCells = 0;
 
 	for(int k = 0; k < m_Graph.m_NumEdges; k++)
 	{
@@ -281,6 +306,7 @@ void CBotEngine::Init(CTile *pTiles, int Width, int Height)
 			}
 		}
 
+		GenerateVisibility();
 		GenerateCorners();
 		GenerateSegments();
 		GenerateTriangles();
@@ -299,6 +325,80 @@ void CBotEngine::Init(CTile *pTiles, int Width, int Height)
 	}
 }
 
+// bit of the tile pair (x, y), (x+dx, y+dy) within the row of (x, y). the
+// pairs are symmetric, so only the offsets with dy > 0 or dy == 0, dx > 0
+// get stored
+static inline int VisibilityBit(int dx, int dy, int Radius)
+{
+	return dy == 0 ? dx-1 : Radius + (dy-1)*(2*Radius+1) + dx+Radius;
+}
+
+void CBotEngine::GenerateVisibility()
+{
+	CCollision *pCollision = GameServer()->Collision();
+
+	// summed area table of the solid tiles for constant time rectangle tests
+	int SumWidth = m_Width+1;
+	m_pSolidSum = (int *)mem_alloc(SumWidth*(m_Height+1)*sizeof(int), 1);
+	m_pVisibilityRow = (int *)mem_alloc(m_Width*m_Height*sizeof(int), 1);
+	if(!m_pSolidSum || !m_pVisibilityRow)
+		return;
+	mem_zero(m_pSolidSum, SumWidth*sizeof(int));
+	for(int j = 0; j < m_Height; j++)
+	{
+		int RowSum = 0;
+		m_pSolidSum[(j+1)*SumWidth] = 0;
+		for(int i = 0; i < m_Width; i++)
+		{
+			if(pCollision->CheckPoint(i*32+16, j*32+16))
+				RowSum++;
+			m_pSolidSum[(j+1)*SumWidth+i+1] = m_pSolidSum[j*SumWidth+i+1] + RowSum;
+		}
+	}
+
+	// one row of bits for every free tile
+	int NumRows = 0;
+	for(int i = 0; i < m_Width*m_Height; i++)
+		m_pVisibilityRow[i] = IsAreaFree(i%m_Width, i/m_Width, i%m_Width, i/m_Width) ? NumRows++ : -1;
+	m_pVisibility = (unsigned *)mem_alloc(max(NumRows, 1)*VISIBILITY_WORDS*sizeof(unsigned), 1);
+	if(!m_pVisibility)
+		return;
+	mem_zero(m_pVisibility, max(NumRows, 1)*VISIBILITY_WORDS*sizeof(unsigned));
+
+	for(int j = 0; j < m_Height; j++)
+	{
+		for(int i = 0; i < m_Width; i++)
+		{
+			int Row = m_pVisibilityRow[i+j*m_Width];
+			if(Row < 0)
+				continue;
+			unsigned *pBits = m_pVisibility + Row*VISIBILITY_WORDS;
+			// walk outwards along every direction, once a line is blocked
+			// all the longer ones containing it are as well
+			for(int dy = 0; dy <= VISIBILITY_RADIUS; dy++)
+			{
+				for(int dx = dy ? -VISIBILITY_RADIUS : 1; dx <= VISIBILITY_RADIUS; dx++)
+				{
+					if(gcd(absolute(dx), dy) != 1)
+						continue;
+					for(int k = 1; k*absolute(dx) <= VISIBILITY_RADIUS && k*dy <= VISIBILITY_RADIUS; k++)
+					{
+						int x = i+k*dx;
+						int y = j+k*dy;
+						if(x < 0 || x >= m_Width || y >= m_Height || !IsTileLineFree(i, j, x, y))
+							break;
+						int Bit = VisibilityBit(k*dx, k*dy, VISIBILITY_RADIUS);
+						pBits[Bit>>5] |= 1u<<(Bit&31);
+					}
+				}
+			}
+		}
+	}
+	#ifdef BOT_DEBUG
+	dbg_msg("botengine","visibility generated, %d free tiles, %d bytes", NumRows, NumRows*VISIBILITY_WORDS*(int)sizeof(unsigned));
+	#endif
+}
+
 void CBotEngine::GenerateSegments()
 {
 	int VSegmentCount = 0;
@@ -505,6 +605,39 @@ void CBotEngine::GenerateSegments()
 		exit(1);
 	qsort(m_pSegments,HSegmentCount,sizeof(CSegment),SegmentComp);
 	qsort(m_pSegments+HSegmentCount,VSegmentCount,sizeof(CSegment),SegmentComp);
+
+	GenerateSegmentGrid();
+}
+
+void CBotEngine::GenerateSegmentGrid()
+{
+	m_SegmentGrid.Init(m_Width, m_Height);
+	int NumCells = m_SegmentGrid.NumCells();
+
+	// same counting sort as the entities in CGameWorld::PreSnap
+	m_pSegmentCellStart = (int *)mem_alloc((NumCells+3)*sizeof(int), 1);
+	m_pSegmentCells = (int *)mem_alloc(max(m_SegmentCount*2, 1)*sizeof(int), 1);
+	mem_zero(m_pSegmentCellStart, (NumCells+3)*sizeof(int));
+	for(int k = 0; k < m_SegmentCount; k++)
+	{
+		int CellA = m_SegmentGrid.Cell(m_pSegments[k].m_A);
+		int CellB = m_SegmentGrid.Cell(m_pSegments[k].m_B);
+		m_pSegmentCellStart[CellA+2]++;
+		if(CellB != CellA)
+			m_pSegmentCellStart[CellB+2]++;
+		m_pSegments[k].m_SnapStamp = 0;
+	}
+	for(int c = 2; c < NumCells+3; c++)
+		m_pSegmentCellStart[c] += m_pSegmentCellStart[c-1];
+	for(int k = 0; k < m_SegmentCount; k++)
+	{
+		int CellA = m_SegmentGrid.Cell(m_pSegments[k].m_A);
+		int CellB = m_SegmentGrid.Cell(m_pSegments[k].m_B);
+		m_pSegmentCells[m_pSegmentCellStart[CellA+1]++] = k;
+		if(CellB != CellA)
+			m_pSegmentCells[m_pSegmentCellStart[CellB+1]++] = k;
+	}
+	m_SegmentSnapStamp = 0;
 }
 
 int CBotEngine::SegmentComp(const void *a, const void *b)
@@ -848,6 +981,107 @@ int CBotEngine::FastIntersectLine(int Id1, int Id2)
 	return 0;
 }
 
+// x0 <= x1, y0 <= y1
+bool CBotEngine::IsAreaFree(int x0, int y0, int x1, int y1)
+{
+	int SumWidth = m_Width+1;
+	return m_pSolidSum[(y1+1)*SumWidth+x1+1] - m_pSolidSum[y0*SumWidth+x1+1] - m_pSolidSum[(y1+1)*SumWidth+x0] + m_pSolidSum[y0*SumWidth+x0] == 0;
+}
+
+// whether the collision tile walk between any point of the first and any
+// point of the second tile stays clear. the walk only steps towards the end
+// tile, so it never leaves the bounding box of the two tiles, and every tile
+// it enters is within one tile of the line between the tile centers
+bool CBotEngine::IsTileLineFree(int x0, int y0, int x1, int y1)
+{
+	int MinX = min(x0, x1);
+	int MaxX = max(x0, x1);
+	int MinY = min(y0, y1);
+	int MaxY = max(y0, y1);
+	if(IsAreaFree(MinX, MinY, MaxX, MaxY))
+		return true;
+
+	// a bit more than a tile, the walk rounds the positions to pixels
+	const float Reach = 1.05f;
+	for(int y = MinY; y <= MaxY; y++)
+	{
+		// the part of the line close enough to this row
+		float Lo, Hi;
+		if(y0 == y1)
+		{
+			Lo = MinX;
+			Hi = MaxX;
+		}
+		else
+		{
+			float a0 = (y-Reach-y0)/(float)(y1-y0);
+			float a1 = (y+Reach-y0)/(float)(y1-y0);
+			if(a0 > a1)
+				swap(a0, a1);
+			a0 = max(a0, 0.0f);
+			a1 = min(a1, 1.0f);
+			Lo = min(mix((float)x0, (float)x1, a0), mix((float)x0, (float)x1, a1));
+			Hi = max(mix((float)x0, (float)x1, a0), mix((float)x0, (float)x1, a1));
+		}
+		int From = max(MinX, (int)ceilf(Lo-Reach));
+		int To = min(MaxX, (int)floorf(Hi+Reach));
+		if(From <= To && !IsAreaFree(From, y, To, y))
+			return false;
+	}
+	return true;
+}
+
+// CCollision::FastIntersectLine, but lines that are known to be clear are
+// answered from the visibility bits
+int CBotEngine::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	int x0 = round_to_int(Pos0.x);
+	int y0 = round_to_int(Pos0.y);
+	int x1 = round_to_int(Pos1.x);
+	int y1 = round_to_int(Pos1.y);
+	if(m_pVisibility && x0 >= 0 && y0 >= 0 && x1 >= 0 && y1 >= 0)
+	{
+		x0 /= 32;
+		y0 /= 32;
+		x1 /= 32;
+		y1 /= 32;
+		if(x0 < m_Width && y0 < m_Height && x1 < m_Width && y1 < m_Height)
+		{
+			if(y1 < y0 || (y1 == y0 && x1 < x0))
+			{
+				swap(x0, x1);
+				swap(y0, y1);
+			}
+			int dx = x1-x0;
+			int dy = y1-y0;
+			int Row = m_pVisibilityRow[x0+y0*m_Width];
+
+			bool Free;
+			if(Row < 0)
+				Free = false;
+			else if(dx == 0 && dy == 0)
+				Free = true;
+			else if(absolute(dx) <= VISIBILITY_RADIUS && dy <= VISIBILITY_RADIUS)
+			{
+				int Bit = VisibilityBit(dx, dy, VISIBILITY_RADIUS);
+				Free = m_pVisibility[Row*VISIBILITY_WORDS+(Bit>>5)] & (1u<<(Bit&31));
+			}
+			else
+				Free = IsAreaFree(min(x0, x1), y0, max(x0, x1), y1);
+
+			if(Free)
+			{
+				if(pOutCollision)
+					*pOutCollision = Pos1;
+				if(pOutBeforeCollision)
+					*pOutBeforeCollision = Pos1;
+				return 0;
+			}
+		}
+	}
+	return GameServer()->Collision()->FastIntersectLine(Pos0, Pos1, pOutCollision, pOutBeforeCollision);
+}
+
 void CBotEngine::GetPath(vec2 VStart, vec2 VEnd, CPath *pPath)
 {
 	pPath->m_Size = m_Graph.GetPath(GetClosestVertex(VStart),GetClosestVertex(VEnd),pPath->m_pVertices+1);
@@ -943,7 +1177,7 @@ int CBotEngine::FarestPointOnEdge(CPath *pPath, vec2 Pos, vec2 *pTarget)
 		{
 			vec2 VertexPos = pPath->m_pVertices[k];
 			vec2 W = direction(angle(normalize(VertexPos-Pos))+pi/2)*14.f;
-			if(!(GameServer()->Collision()->FastIntersectLine(Pos-W,VertexPos-W,0,0)) && !(GameServer()->Collision()->FastIntersectLine(Pos+W,VertexPos+W,0,0)))
+			if(!(IntersectLine(Pos-W,VertexPos-W,0,0)) && !(IntersectLine(Pos+W,VertexPos+W,0,0)))
 			{
 				if(pTarget)
 					*pTarget = VertexPos;
@@ -1008,6 +1242,9 @@ void CBotEngine::OnCharacterSpawn(int CID) {
 
 void CBotEngine::OnCharacterDeath(int Victim, int Killer, int Weapon)
 {
+	m_Blackboard.m_aCharacters[Victim].m_Alive = false;
+	mem_zero(m_Blackboard.m_aClosestValid, sizeof(m_Blackboard.m_aClosestValid));
+
 	if(m_apBot[Victim]) {
 		m_apBot[Victim]->m_GenomeTick >>= 1;
 		int delay_min;
@@ -1065,6 +1302,110 @@ void CBotEngine::OnCharacterDeath(int Victim, int Killer, int Weapon)
 		m_apBot[Killer]->m_GenomeTick <<= 1;
 }
 
+void CBotEngine::UpdateBlackboard()
+{
+	for(int c = 0; c < MAX_CLIENTS; c++)
+	{
+		CCharacterInfo *pInfo = &m_Blackboard.m_aCharacters[c];
+		CPlayer *pPlayer = GameServer()->m_apPlayers[c];
+		CCharacter *pChr = pPlayer ? pPlayer->GetCharacter() : 0;
+		pInfo->m_Alive = pChr != 0;
+		if(!pChr)
+			continue;
+		pInfo->m_Team = pPlayer->GetTeam();
+		pInfo->m_Pos = pChr->GetCore()->m_Pos;
+		pInfo->m_Vel = pChr->GetCore()->m_Vel;
+	}
+
+	m_Blackboard.m_aPickups.set_size(0);
+	for(CEntity *pEnt = GameServer()->m_World.FindFirst(CGameWorld::ENTTYPE_PICKUP); pEnt; pEnt = pEnt->TypeNext())
+	{
+		CPickup *pPickup = (CPickup *)pEnt;
+		if(!pPickup->IsSpawned())
+			continue;
+		CPickupInfo Info;
+		Info.m_Type = pPickup->GetType();
+		Info.m_SubType = pPickup->GetSubType();
+		Info.m_Pos = pPickup->GetPos();
+		m_Blackboard.m_aPickups.add(Info);
+	}
+
+	mem_zero(m_Blackboard.m_aaSight, sizeof(m_Blackboard.m_aaSight));
+	mem_zero(m_Blackboard.m_aClosestValid, sizeof(m_Blackboard.m_aClosestValid));
+	mem_zero(m_Blackboard.m_aDelayedValid, sizeof(m_Blackboard.m_aDelayedValid));
+	mem_zero(m_Blackboard.m_aaPredictedValid, sizeof(m_Blackboard.m_aaPredictedValid));
+}
+
+bool CBotEngine::IsVisible(int From, int To)
+{
+	unsigned char *pSight = &m_Blackboard.m_aaSight[From][To];
+	if(*pSight == CBlackboard::SIGHT_UNKNOWN)
+	{
+		vec2 FromPos = m_Blackboard.m_aCharacters[From].m_Pos;
+		vec2 ToPos = m_Blackboard.m_aCharacters[To].m_Pos;
+		*pSight = IntersectLine(FromPos, ToPos, 0, 0) ? CBlackboard::SIGHT_BLOCKED : CBlackboard::SIGHT_FREE;
+	}
+	return *pSight == CBlackboard::SIGHT_FREE;
+}
+
+vec2 CBotEngine::GetClosestCharacterPos(int CID)
+{
+	if(!m_Blackboard.m_aClosestValid[CID])
+	{
+		vec2 Pos = m_Blackboard.m_aCharacters[CID].m_Pos;
+		vec2 Closest = vec2(0,0);
+		float ClosestDist = -1.0f;
+		for(int c = 0; c < MAX_CLIENTS; c++)
+		{
+			if(c == CID || !m_Blackboard.m_aCharacters[c].m_Alive)
+				continue;
+			float Dist = distance(Pos, m_Blackboard.m_aCharacters[c].m_Pos);
+			if(ClosestDist < 0.0f || Dist < ClosestDist)
+			{
+				ClosestDist = Dist;
+				Closest = m_Blackboard.m_aCharacters[c].m_Pos;
+			}
+		}
+		m_Blackboard.m_aClosestPos[CID] = Closest;
+		m_Blackboard.m_aClosestValid[CID] = true;
+	}
+	return m_Blackboard.m_aClosestPos[CID];
+}
+
+vec2 CBotEngine::GetDelayedPos(int CID)
+{
+	// where the character is once the bot reaction delay has passed
+	if(!m_Blackboard.m_aDelayedValid[CID])
+	{
+		vec2 Pos = m_Blackboard.m_aCharacters[CID].m_Pos;
+		vec2 Vel = m_Blackboard.m_aCharacters[CID].m_Vel / GameServer()->Server()->TickSpeed();
+		IntersectLine(Pos, Pos+Vel*g_Config.m_SvBotDelay, 0, &Pos);
+		m_Blackboard.m_aDelayedPos[CID] = Pos;
+		m_Blackboard.m_aDelayedValid[CID] = true;
+	}
+	return m_Blackboard.m_aDelayedPos[CID];
+}
+
+const vec2 *CBotEngine::GetPredictedPath(int CID, int Weapon, int DTick)
+{
+	// rough flight of the character while a projectile of the weapon is
+	// underway, one position every DTick ticks
+	vec2 *pPath = m_Blackboard.m_aaaPredictedPath[Weapon][CID];
+	if(!m_Blackboard.m_aaPredictedValid[Weapon][CID])
+	{
+		vec2 Pos = m_Blackboard.m_aCharacters[CID].m_Pos;
+		vec2 Vel = m_Blackboard.m_aCharacters[CID].m_Vel*DTick;
+		for(int k = 0; k < BOT_PREDICTION_STEPS; k++)
+		{
+			pPath[k] = Pos;
+			IntersectLine(Pos, Pos+Vel, 0, &Pos);
+			Vel.y += GameServer()->Tuning()->m_Gravity*DTick*DTick;
+		}
+		m_Blackboard.m_aaPredictedValid[Weapon][CID] = true;
+	}
+	return pPath;
+}
+
 void CBotEngine::RegisterBot(int CID, CBot *pBot)
 {
 	m_apBot[CID] = pBot;
@@ -1127,21 +1468,61 @@ void CBotEngine::Snap(int SnappingClient)
 		pObj->m_FromY = (int) From.y;
 		pObj->m_StartTick = GameServer()->Server()->Tick();
 	}
-	for(int k = 0; k < m_SegmentCount; k++)
+	// without a view or a grid go over all segments like before
+	if(SnappingClient == -1 || !m_pSegmentCellStart)
 	{
-		CSegment *pSegment = m_pSegments + k;
+		for(int k = 0; k < m_SegmentCount; k++)
+			if(!SnapSegment(SnappingClient, m_pSegments + k))
+				return;
+		return;
+	}
 
-		vec2 From = pSegment->m_A;
-		vec2 To = pSegment->m_B;
-		if(NetworkClipped(SnappingClient, To) && NetworkClipped(SnappingClient, From))
-			continue;
-		CNetObj_Laser *pObj = static_cast<CNetObj_Laser *>(GameServer()->Server()->SnapNewItem(NETOBJTYPE_LASER, pSegment->m_SnapID, sizeof(CNetObj_Laser)));
-		if(!pObj)
-			return;
-		pObj->m_X = (int) To.x;
-		pObj->m_Y = (int) To.y;
-		pObj->m_FromX = (int) From.x;
-		pObj->m_FromY = (int) From.y;
-		pObj->m_StartTick = GameServer()->Server()->Tick();
+	// segments are only sent when one of their ends is in view, so the
+	// cells of the view hold all of them. a segment can be in two cells
+	m_SegmentSnapStamp++;
+	CSnapGrid::CView View = m_SegmentGrid.View(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos);
+	for(int y = View.m_Y0; y <= View.m_Y1+1; y++)
+	{
+		// the row after the view stands for the outside cell
+		int Start, End;
+		if(y <= View.m_Y1)
+		{
+			int Row = y*m_SegmentGrid.Width();
+			Start = m_pSegmentCellStart[Row+View.m_X0];
+			End = m_pSegmentCellStart[Row+View.m_X1+1];
+		}
+		else
+		{
+			Start = m_pSegmentCellStart[m_SegmentGrid.OutsideCell()];
+			End = m_pSegmentCellStart[m_SegmentGrid.OutsideCell()+1];
+		}
+
+		for(int i = Start; i < End; i++)
+		{
+			CSegment *pSegment = m_pSegments + m_pSegmentCells[i];
+			if(pSegment->m_SnapStamp == m_SegmentSnapStamp)
+				continue;
+			pSegment->m_SnapStamp = m_SegmentSnapStamp;
+
+			if(!SnapSegment(SnappingClient, pSegment))
+				return;
+		}
 	}
 }
+
+bool CBotEngine::SnapSegment(int SnappingClient, CSegment *pSegment)
+{
+	vec2 From = pSegment->m_A;
+	vec2 To = pSegment->m_B;
+	if(NetworkClipped(SnappingClient, To) && NetworkClipped(SnappingClient, From))
+		return true;
+	CNetObj_Laser *pObj = static_cast<CNetObj_Laser *>(GameServer()->Server()->SnapNewItem(NETOBJTYPE_LASER, pSegment->m_SnapID, sizeof(CNetObj_Laser)));
+	if(!pObj)
+		return false;
+	pObj->m_X = (int) To.x;
+	pObj->m_Y = (int) To.y;
+	pObj->m_FromX = (int) From.x;
+	pObj->m_FromY = (int) From.y;
+	pObj->m_StartTick = GameServer()->Server()->Tick();
+	return true;
+}
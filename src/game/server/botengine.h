@@ -2,6 +2,9 @@
 #define GAME_SERVER_BOTENGINE_H
 
 #include <base/vmath.h>
+#include <base/tl/array.h>
+
+#include "snapgrid.h"
 
 const char g_IsRemovable[256] = { 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1, 0};
 const char g_ConnectedComponents[256] = { 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, 2, 2, 2, 2, 3, 3, 2, 2, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 2, 2, 1, 1, 2, 2, 2, 2, 3, 3, 2, 2, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 2, 3, 2, 2, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 2, 3, 2, 2, 2, 2, 1, 2, 2, 3, 2, 2, 2, 3, 2, 3, 3, 4, 3, 3, 3, 3, 2, 2, 2, 3, 2, 2, 2, 3, 2, 2, 2, 3, 2, 2, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 2, 3, 2, 2, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 2, 3, 2, 2, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 2, 2, 3, 2, 2, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 1, 1, 2, 1, 1, 1, 1, 1 };
@@ -199,9 +202,27 @@ public:
 	vec2 ConvertIndex(int ID) { return vec2(ID%m_Width,ID/m_Width)*32 + vec2(16.,16.); }
 };
 
+#define BOT_PREDICTION_STEPS 10
+
 class CBotEngine
 {
 	class CGameContext *m_pGameServer;
+public:
+	struct CCharacterInfo
+	{
+		bool m_Alive;
+		int m_Team;
+		vec2 m_Pos;
+		vec2 m_Vel;
+	};
+
+	struct CPickupInfo
+	{
+		int m_Type;
+		int m_SubType;
+		vec2 m_Pos;
+	};
+
 protected:
 
 	class CTile *m_pTiles;
@@ -216,10 +237,17 @@ protected:
 		vec2 m_B;
 		int m_SnapID;
 		bool m_Intersect;
+		int m_SnapStamp;
 	} *m_pSegments;
 	int m_SegmentCount;
 	int m_HSegmentCount;
 
+	// segments under the cells of both of their ends, for the debug snap
+	CSnapGrid m_SegmentGrid;
+	int *m_pSegmentCellStart;
+	int *m_pSegmentCells;
+	int m_SegmentSnapStamp;
+
 	int m_Width;
 	int m_Height;
 
@@ -233,8 +261,24 @@ protected:
 		int m_Size;
 	} m_Triangulation;
 
+	// which tile pairs can see each other for sure. a set bit means that
+	// no solid tile lies close enough to the line between any two points
+	// of the tiles for the collision tile walk to touch it
+	enum
+	{
+		VISIBILITY_RADIUS=12,
+		VISIBILITY_WORDS=(VISIBILITY_RADIUS+VISIBILITY_RADIUS*(2*VISIBILITY_RADIUS+1)+31)/32,
+	};
+	int *m_pSolidSum;
+	int *m_pVisibilityRow;
+	unsigned *m_pVisibility;
+
+	bool IsAreaFree(int x0, int y0, int x1, int y1);
+	bool IsTileLineFree(int x0, int y0, int x1, int y1);
+
 	void Free();
 
+	void GenerateVisibility();
 	void GenerateCorners();
 	void GenerateSegments();
 	void GenerateTriangles();
@@ -245,6 +289,32 @@ protected:
 
 	class CBot *m_apBot[MAX_CLIENTS];
 
+	// what the bots know about the world, gathered once per tick. the
+	// more expensive parts are only computed when a bot asks for them
+	struct CBlackboard
+	{
+		enum
+		{
+			SIGHT_UNKNOWN=0,
+			SIGHT_FREE,
+			SIGHT_BLOCKED,
+		};
+
+		CCharacterInfo m_aCharacters[MAX_CLIENTS];
+		array<CPickupInfo> m_aPickups;
+
+		unsigned char m_aaSight[MAX_CLIENTS][MAX_CLIENTS];
+
+		bool m_aClosestValid[MAX_CLIENTS];
+		vec2 m_aClosestPos[MAX_CLIENTS];
+
+		bool m_aDelayedValid[MAX_CLIENTS];
+		vec2 m_aDelayedPos[MAX_CLIENTS];
+
+		bool m_aaPredictedValid[NUM_WEAPONS][MAX_CLIENTS];
+		vec2 m_aaaPredictedPath[NUM_WEAPONS][MAX_CLIENTS][BOT_PREDICTION_STEPS];
+	} m_Blackboard;
+
 public:
 	CBotEngine(class CGameContext *pGameServer);
 	~CBotEngine();
@@ -256,6 +326,14 @@ public:
 		int m_MaxSize;
 	} m_aPaths[MAX_CLIENTS];
 
+	void UpdateBlackboard();
+	const CCharacterInfo *GetCharacter(int CID) { return &m_Blackboard.m_aCharacters[CID]; }
+	const array<CPickupInfo> &GetPickups() { return m_Blackboard.m_aPickups; }
+	bool IsVisible(int From, int To);
+	vec2 GetClosestCharacterPos(int CID);
+	vec2 GetDelayedPos(int CID);
+	const vec2 *GetPredictedPath(int CID, int Weapon, int DTick);
+
 	int GetWidth() { return m_Width; }
 	int GetHeight() { return m_Height; }
 
@@ -270,6 +348,7 @@ public:
 	int GetTile(vec2 Pos);
 	int GetTile(int i) { return m_pGrid[i]; };
 	int FastIntersectLine(int Id1, int Id2);
+	int IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision);
 	int IntersectSegment(vec2 P1, vec2 P2, vec2 *pPos);
 
 	int GetClosestEdge(vec2 Pos, int ClosestRange, CEdge *pEdge);
@@ -284,6 +363,7 @@ public:
 
 	void Init(class CTile *pTiles, int Width, int Height);
 	void Snap(int SnappingClient);
+	bool SnapSegment(int SnappingClient, CSegment *pSegment);
 	void OnRelease();
 
 	int NetworkClipped(int SnappingClient, vec2 CheckPos);
@@ -294,6 +374,7 @@ public:
 	void UnRegisterBot(int CID);
 
 	static int SegmentComp(const void *a, const void *b);
+	void GenerateSegmentGrid();
 };
 
 #endif
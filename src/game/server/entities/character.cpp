@@ -103,6 +103,7 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 	m_Core.Init(&GameServer()->m_World.m_Core, GameServer()->Collision());
 	m_Core.m_Pos = m_Pos;
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = &m_Core;
+	GameServer()->m_CoreRecorder.RecordSpawn(Server()->Tick(), m_pPlayer->GetCID(), m_Pos);
 
 	m_ReckoningTick = 0;
 	mem_zero(&m_SendCore, sizeof(m_SendCore));
@@ -120,6 +121,7 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 void CCharacter::Destroy()
 {
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
+	GameServer()->m_CoreRecorder.RecordDeath(Server()->Tick(), m_pPlayer->GetCID());
 	m_Alive = false;
 }
 
@@ -692,6 +694,7 @@ void CCharacter::Tick()
 		Anticamper();
 
 	m_Core.m_Input = m_Input;
+	GameServer()->m_CoreRecorder.RecordInput(Server()->Tick(), m_pPlayer->GetCID(), &m_Input);
 	m_Core.Tick(true);
 
 	// handle death-tiles and leaving gamelayer
@@ -761,7 +764,7 @@ void CCharacter::TickDefered()
 	}
 
 	int Events = m_Core.m_TriggeredEvents;
-	int Mask = CmaskAllExceptOne(m_pPlayer->GetCID());
+	int64 Mask = CmaskAllExceptOne(m_pPlayer->GetCID());
 
 	if(Events&COREEVENT_GROUND_JUMP) GameServer()->CreateSound(m_Pos, SOUND_PLAYER_JUMP, Mask);
 
@@ -854,7 +857,22 @@ void CCharacter::Die(int Killer, int Weapon)
 	Msg.m_Victim = m_pPlayer->GetCID();
 	Msg.m_Weapon = Weapon;
 	Msg.m_ModeSpecial = ModeSpecial;
-	Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, -1);
+	if(Server()->MaxClients() <= VANILLA_MAX_CLIENTS)
+		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, -1);
+	else
+	{
+		// every client knows the players by its own ids, skip those who don't know both
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(!GameServer()->m_apPlayers[i] || GameServer()->m_apPlayers[i]->IsBot())
+				continue;
+			Msg.m_Killer = Killer;
+			Msg.m_Victim = m_pPlayer->GetCID();
+			if(!GameServer()->TranslateID(i, &Msg.m_Killer) || !GameServer()->TranslateID(i, &Msg.m_Victim))
+				continue;
+			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i);
+		}
+	}
 
 	// a nice sound
 	GameServer()->CreateSound(m_Pos, SOUND_PLAYER_DIE);
@@ -870,6 +888,7 @@ void CCharacter::Die(int Killer, int Weapon)
 	m_Alive = false;
 	GameServer()->m_World.RemoveEntity(this);
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
+	GameServer()->m_CoreRecorder.RecordDeath(Server()->Tick(), m_pPlayer->GetCID());
 	GameServer()->CreateDeath(m_Pos, m_pPlayer->GetCID());
 }
 
@@ -951,7 +970,7 @@ bool CCharacter::TakeDamage(vec2 Force, int Dmg, int From, int Weapon)
 	// do damage Hit sound
 	if(From >= 0 && From != m_pPlayer->GetCID() && GameServer()->m_apPlayers[From])
 	{
-		int Mask = CmaskOne(From);
+		int64 Mask = CmaskOne(From);
 		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
 			if(GameServer()->m_apPlayers[i] && GameServer()->m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS && GameServer()->m_apPlayers[i]->m_SpectatorID == From)
@@ -1003,7 +1022,11 @@ void CCharacter::Snap(int SnappingClient)
 			return;
 	}
 
-	CNetObj_Character *pCharacter = static_cast<CNetObj_Character *>(Server()->SnapNewItem(NETOBJTYPE_CHARACTER, m_pPlayer->GetCID(), sizeof(CNetObj_Character)));
+	int ID = m_pPlayer->GetCID();
+	if(!GameServer()->TranslateID(SnappingClient, &ID))
+		return;
+
+	CNetObj_Character *pCharacter = static_cast<CNetObj_Character *>(Server()->SnapNewItem(NETOBJTYPE_CHARACTER, ID, sizeof(CNetObj_Character)));
 	if(!pCharacter)
 		return;
 
@@ -1021,6 +1044,9 @@ void CCharacter::Snap(int SnappingClient)
 		m_SendCore.Write(pCharacter);
 	}
 
+	if(!GameServer()->TranslateID(SnappingClient, &pCharacter->m_HookedPlayer))
+		pCharacter->m_HookedPlayer = -1;
+
 	// set emote
 	if (m_EmoteStop < Server()->Tick())
 	{
@@ -1182,6 +1208,7 @@ void CCharacter::KillChar()
 	m_Alive = false;
 	GameServer()->m_World.RemoveEntity(this);
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
+	GameServer()->m_CoreRecorder.RecordDeath(Server()->Tick(), m_pPlayer->GetCID());
 	GameServer()->CreateDeath(m_Pos, m_pPlayer->GetCID());
 
 }
@@ -5,6 +5,8 @@
 #include <engine/shared/config.h>
 #include "laser.h"
 
+MACRO_ALLOC_POOL_IMPL(CLaser, 32)
+
 CLaser::CLaser(CGameWorld *pGameWorld, vec2 Pos, vec2 Direction, float StartEnergy, int Owner)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER)
 {
@@ -15,6 +17,7 @@ CLaser::CLaser(CGameWorld *pGameWorld, vec2 Pos, vec2 Direction, float StartEner
 	m_Bounces = 0;
 	m_EvalTick = 0;
 	GameWorld()->InsertEntity(this);
+	GameServer()->m_CoreRecorder.RecordLaser(Server()->Tick(), Owner, Pos, Direction, StartEnergy);
 	DoBounce();
 }
 
@@ -3,6 +3,8 @@
 #include <game/server/gamecontext.h>
 #include "loltext.h"
 
+MACRO_ALLOC_POOL_IMPL(ClolPlasma, 128)
+
 ClolPlasma *CLoltext::s_aapPlasma[MAX_LOLTEXTS][MAX_PLASMA_PER_LOLTEXT];
 int CLoltext::s_aExpire[MAX_LOLTEXTS];
 
@@ -11,6 +11,8 @@
 
 class ClolPlasma : public CEntity
 {
+	MACRO_ALLOC_POOL(ClolPlasma)
+
 public:
 	//position relative to pParent->m_Pos. if pParent is NULL, Pos is absolute. lifespan in ticks
 	ClolPlasma(CGameWorld *pGameWorld, CEntity *pParent, vec2 Pos, vec2 Vel, int Lifespan);
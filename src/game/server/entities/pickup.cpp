@@ -4,6 +4,8 @@
 #include <game/server/gamecontext.h>
 #include "pickup.h"
 
+MACRO_ALLOC_POOL_IMPL(CPickup, 32)
+
 CPickup::CPickup(CGameWorld *pGameWorld, int Type, int SubType)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_PICKUP)
 {
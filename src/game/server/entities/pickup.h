@@ -9,6 +9,8 @@ const int PickupPhysSize = 14;
 
 class CPickup : public CEntity
 {
+	MACRO_ALLOC_POOL(CPickup)
+
 public:
 	CPickup(CGameWorld *pGameWorld, int Type, int SubType = 0);
 
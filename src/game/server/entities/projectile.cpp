@@ -4,6 +4,8 @@
 #include <game/server/gamecontext.h>
 #include "projectile.h"
 
+MACRO_ALLOC_POOL_IMPL(CProjectile, 64)
+
 CProjectile::CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_PROJECTILE)
@@ -21,6 +23,7 @@ CProjectile::CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos,
 	m_Explosive = Explosive;
 
 	GameWorld()->InsertEntity(this);
+	GameServer()->m_CoreRecorder.RecordProjectile(m_StartTick, Owner, Type, Pos, Dir, Span);
 }
 
 void CProjectile::Reset()
@@ -97,11 +100,15 @@ void CProjectile::FillInfo(CNetObj_Projectile *pProj)
 	pProj->m_Type = m_Type;
 }
 
-void CProjectile::Snap(int SnappingClient)
+vec2 CProjectile::GetSnapPos()
 {
 	float Ct = (Server()->Tick()-m_StartTick)/(float)Server()->TickSpeed();
+	return GetPos(Ct);
+}
 
-	if(NetworkClipped(SnappingClient, GetPos(Ct)))
+void CProjectile::Snap(int SnappingClient)
+{
+	if(NetworkClipped(SnappingClient, GetSnapPos()))
 		return;
 
 	CNetObj_Projectile *pProj = static_cast<CNetObj_Projectile *>(Server()->SnapNewItem(NETOBJTYPE_PROJECTILE, m_ID, sizeof(CNetObj_Projectile)));
@@ -5,6 +5,8 @@
 
 class CProjectile : public CEntity
 {
+	MACRO_ALLOC_POOL(CProjectile)
+
 public:
 	CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon);
@@ -16,6 +18,7 @@ public:
 	virtual void Tick();
 	virtual void TickPaused();
 	virtual void Snap(int SnappingClient);
+	virtual vec2 GetSnapPos();
 
 private:
 	vec2 m_Direction;
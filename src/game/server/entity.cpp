@@ -4,6 +4,73 @@
 #include "entity.h"
 #include "gamecontext.h"
 
+//////////////////////////////////////////////////
+// Entity pool
+//////////////////////////////////////////////////
+CEntityPool *CEntityPool::ms_pFirstPool = 0;
+
+CEntityPool::CEntityPool(const char *pName, int ObjectSize, int ChunkSize)
+{
+	m_pName = pName;
+	m_ObjectSize = (max(ObjectSize, (int)sizeof(CSlot))+7)&~7;
+	m_ChunkSize = ChunkSize;
+
+	m_pFirstChunk = 0;
+	m_pFirstFree = 0;
+
+	m_NumLive = 0;
+	m_PeakLive = 0;
+	m_NumSlots = 0;
+
+	// pools are static, the list is only walked for the stats
+	m_pNextPool = ms_pFirstPool;
+	ms_pFirstPool = this;
+}
+
+void CEntityPool::Grow()
+{
+	// the first bytes of a chunk link it to the next one, the objects
+	// follow with the same alignment mem_alloc gives
+	int Header = 8;
+	char *pChunk = (char *)mem_alloc(Header + m_ObjectSize*m_ChunkSize, 8);
+	*(void **)pChunk = m_pFirstChunk;
+	m_pFirstChunk = pChunk;
+
+	for(int i = m_ChunkSize-1; i >= 0; i--)
+	{
+		CSlot *pSlot = (CSlot *)(pChunk + Header + i*m_ObjectSize);
+		pSlot->m_pNext = m_pFirstFree;
+		m_pFirstFree = pSlot;
+	}
+	m_NumSlots += m_ChunkSize;
+}
+
+void *CEntityPool::Alloc(size_t Size)
+{
+	dbg_assert((int)Size <= m_ObjectSize, "size error");
+	if(!m_pFirstFree)
+		Grow();
+
+	CSlot *pSlot = m_pFirstFree;
+	m_pFirstFree = pSlot->m_pNext;
+	mem_zero(pSlot, Size);
+
+	m_NumLive++;
+	m_PeakLive = max(m_PeakLive, m_NumLive);
+	return pSlot;
+}
+
+void CEntityPool::Free(void *p)
+{
+	if(!p)
+		return;
+
+	CSlot *pSlot = (CSlot *)p;
+	pSlot->m_pNext = m_pFirstFree;
+	m_pFirstFree = pSlot;
+	m_NumLive--;
+}
+
 //////////////////////////////////////////////////
 // Entity
 //////////////////////////////////////////////////
@@ -50,6 +50,60 @@
 		mem_zero(ms_PoolData##POOLTYPE[id], sizeof(POOLTYPE)); \
 	}
 
+#define MACRO_ALLOC_POOL(POOLTYPE) \
+	public: \
+	void *operator new(size_t Size) { return ms_Pool##POOLTYPE.Alloc(Size); } \
+	void operator delete(void *p) { ms_Pool##POOLTYPE.Free(p); } \
+	private: \
+	static CEntityPool ms_Pool##POOLTYPE;
+
+#define MACRO_ALLOC_POOL_IMPL(POOLTYPE, ChunkSize) \
+	CEntityPool POOLTYPE::ms_Pool##POOLTYPE(#POOLTYPE, sizeof(POOLTYPE), ChunkSize);
+
+/*
+	Class: CEntityPool
+		Slab allocator for entities that come and go all the time.
+		Memory is taken in chunks which are kept around, freed objects
+		go onto a free list and get reused by the next allocation.
+*/
+class CEntityPool
+{
+	struct CSlot
+	{
+		CSlot *m_pNext;
+	};
+
+	const char *m_pName;
+	int m_ObjectSize;
+	int m_ChunkSize;
+
+	void *m_pFirstChunk;
+	CSlot *m_pFirstFree;
+
+	int m_NumLive;
+	int m_PeakLive;
+	int m_NumSlots;
+
+	CEntityPool *m_pNextPool;
+	static CEntityPool *ms_pFirstPool;
+
+	void Grow();
+
+public:
+	CEntityPool(const char *pName, int ObjectSize, int ChunkSize);
+
+	void *Alloc(size_t Size);
+	void Free(void *p);
+
+	const char *Name() const { return m_pName; }
+	int NumLive() const { return m_NumLive; }
+	int PeakLive() const { return m_PeakLive; }
+	int NumSlots() const { return m_NumSlots; }
+
+	static CEntityPool *First() { return ms_pFirstPool; }
+	CEntityPool *Next() const { return m_pNextPool; }
+};
+
 /*
 	Class: Entity
 		Basic entity class.
@@ -141,6 +195,13 @@ public:
 	int NetworkClipped(int SnappingClient);
 	int NetworkClipped(int SnappingClient, vec2 CheckPos);
 
+	/*
+		Function: GetSnapPos
+			The position snap() clips the entity at. The game world
+			only lets clients near it snap the entity.
+	*/
+	virtual vec2 GetSnapPos() { return m_Pos; }
+
 	bool GameLayerClipped(vec2 CheckPos);
 
 	/*
@@ -9,50 +9,174 @@
 CEventHandler::CEventHandler()
 {
 	m_pGameServer = 0;
+	m_EventCapacity = MIN_EVENTS;
+	m_pEvents = (CEvent *)mem_alloc(m_EventCapacity*sizeof(CEvent), 1);
+	m_DataCapacity = MIN_DATASIZE;
+	m_pData = (char *)mem_alloc(m_DataCapacity, 1);
+	m_NumCreated = 0;
+	m_NumMerged = 0;
+	m_NumDropped = 0;
+	m_NumSnapDropped = 0;
+	m_PeakEvents = 0;
 	Clear();
 }
 
+CEventHandler::~CEventHandler()
+{
+	mem_free(m_pEvents);
+	mem_free(m_pData);
+}
+
 void CEventHandler::SetGameServer(CGameContext *pGameServer)
 {
 	m_pGameServer = pGameServer;
 }
 
-void *CEventHandler::Create(int Type, int Size, int Mask)
+void *CEventHandler::Create(int Type, int Size, int64 Mask)
 {
 	if(m_NumEvents == MAX_EVENTS)
+	{
+		m_NumDropped++;
 		return 0;
-	if(m_CurrentOffset+Size >= MAX_DATASIZE)
-		return 0;
+	}
+
+	// make room, the pointers handed out before are filled in by now
+	if(m_NumEvents == m_EventCapacity)
+	{
+		CEvent *pEvents = (CEvent *)mem_alloc(m_EventCapacity*2*sizeof(CEvent), 1);
+		mem_copy(pEvents, m_pEvents, m_NumEvents*sizeof(CEvent));
+		mem_free(m_pEvents);
+		m_pEvents = pEvents;
+		m_EventCapacity *= 2;
+	}
+	if(m_DataSize+Size > m_DataCapacity)
+	{
+		int Capacity = max(m_DataCapacity*2, m_DataSize+Size);
+		char *pData = (char *)mem_alloc(Capacity, 1);
+		mem_copy(pData, m_pData, m_DataSize);
+		mem_free(m_pData);
+		m_pData = pData;
+		m_DataCapacity = Capacity;
+	}
 
-	void *p = &m_aData[m_CurrentOffset];
-	m_aOffsets[m_NumEvents] = m_CurrentOffset;
-	m_aTypes[m_NumEvents] = Type;
-	m_aSizes[m_NumEvents] = Size;
-	m_aClientMasks[m_NumEvents] = Mask;
-	m_CurrentOffset += Size;
+	void *p = &m_pData[m_DataSize];
+	CEvent *pEvent = &m_pEvents[m_NumEvents];
+	pEvent->m_Type = Type;
+	pEvent->m_Offset = m_DataSize;
+	pEvent->m_Size = Size;
+	pEvent->m_ClientMask = Mask;
+	pEvent->m_Next = -1;
+	m_DataSize += Size;
 	m_NumEvents++;
+	m_NumCreated++;
+	m_PeakEvents = max(m_PeakEvents, m_NumEvents);
 	return p;
 }
 
 void CEventHandler::Clear()
 {
 	m_NumEvents = 0;
-	m_CurrentOffset = 0;
+	m_DataSize = 0;
+	m_NumBucketed = 0;
+	for(int i = 0; i < NUM_BUCKETS; i++)
+		m_aBuckets[i] = -1;
 }
 
-void CEventHandler::Snap(int SnappingClient)
+void CEventHandler::BucketEvents()
 {
-	for(int i = 0; i < m_NumEvents; i++)
+	// the positions are only known once the events are filled in,
+	// so this waits for the first snap after they were created
+	for(; m_NumBucketed < m_NumEvents; m_NumBucketed++)
 	{
-		if(SnappingClient == -1 || CmaskIsSet(m_aClientMasks[i], SnappingClient))
+		CEvent *pEvent = &m_pEvents[m_NumBucketed];
+		const CNetEvent_Common *pCommon = (const CNetEvent_Common *)&m_pData[pEvent->m_Offset];
+		int b = Bucket(pCommon->m_X>>CELL_SHIFT, pCommon->m_Y>>CELL_SHIFT);
+
+		// the same sound or damage star at the same place would only be played twice
+		if(pEvent->m_Type == NETEVENTTYPE_SOUNDWORLD || pEvent->m_Type == NETEVENTTYPE_DAMAGEIND)
 		{
-			CNetEvent_Common *ev = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
-			if(SnappingClient == -1 || distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, vec2(ev->m_X, ev->m_Y)) < 1500.0f)
+			int i = m_aBuckets[b];
+			for(; i != -1; i = m_pEvents[i].m_Next)
+			{
+				if(m_pEvents[i].m_Type == pEvent->m_Type && m_pEvents[i].m_Size == pEvent->m_Size &&
+					mem_comp(&m_pData[m_pEvents[i].m_Offset], pCommon, pEvent->m_Size) == 0)
+					break;
+			}
+			if(i != -1)
 			{
-				void *d = GameServer()->Server()->SnapNewItem(m_aTypes[i], i, m_aSizes[i]);
-				if(d)
-					mem_copy(d, &m_aData[m_aOffsets[i]], m_aSizes[i]);
+				m_pEvents[i].m_ClientMask |= pEvent->m_ClientMask;
+				pEvent->m_Type = -1;
+				m_NumMerged++;
+				continue;
 			}
 		}
+
+		pEvent->m_Next = m_aBuckets[b];
+		m_aBuckets[b] = m_NumBucketed;
+	}
+}
+
+void CEventHandler::SnapEvent(int SnappingClient, int Index)
+{
+	const CEvent *pEvent = &m_pEvents[Index];
+	if(SnappingClient != -1 && !CmaskIsSet(pEvent->m_ClientMask, SnappingClient))
+		return;
+
+	CNetEvent_Common *ev = (CNetEvent_Common *)&m_pData[pEvent->m_Offset];
+	if(SnappingClient != -1 && distance(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos, vec2(ev->m_X, ev->m_Y)) >= (float)VIEW_RANGE)
+		return;
+
+	int DeathID = 0;
+	if(pEvent->m_Type == NETEVENTTYPE_DEATH)
+	{
+		DeathID = ((CNetEvent_Death *)ev)->m_ClientID;
+		if(!GameServer()->TranslateID(SnappingClient, &DeathID))
+			return;
+	}
+
+	void *d = GameServer()->Server()->SnapNewItem(pEvent->m_Type, Index, pEvent->m_Size);
+	if(d)
+	{
+		mem_copy(d, ev, pEvent->m_Size);
+		if(pEvent->m_Type == NETEVENTTYPE_DEATH)
+			((CNetEvent_Death *)d)->m_ClientID = DeathID;
+	}
+	else
+		m_NumSnapDropped++;
+}
+
+void CEventHandler::Snap(int SnappingClient)
+{
+	BucketEvents();
+
+	// demos get everything
+	if(SnappingClient == -1)
+	{
+		for(int i = 0; i < m_NumEvents; i++)
+		{
+			if(m_pEvents[i].m_Type != -1)
+				SnapEvent(SnappingClient, i);
+		}
+		return;
+	}
+
+	// only the cells in view, a bucket can be hit by more than one of them
+	vec2 ViewPos = GameServer()->m_apPlayers[SnappingClient]->m_ViewPos;
+	int StartX = ((int)ViewPos.x-VIEW_RANGE)>>CELL_SHIFT;
+	int StartY = ((int)ViewPos.y-VIEW_RANGE)>>CELL_SHIFT;
+	int EndX = ((int)ViewPos.x+VIEW_RANGE)>>CELL_SHIFT;
+	int EndY = ((int)ViewPos.y+VIEW_RANGE)>>CELL_SHIFT;
+	bool aVisited[NUM_BUCKETS] = {false};
+	for(int y = StartY; y <= EndY; y++)
+	{
+		for(int x = StartX; x <= EndX; x++)
+		{
+			int b = Bucket(x, y);
+			if(aVisited[b])
+				continue;
+			aVisited[b] = true;
+			for(int i = m_aBuckets[b]; i != -1; i = m_pEvents[i].m_Next)
+				SnapEvent(SnappingClient, i);
+		}
 	}
 }
@@ -3,30 +3,72 @@
 #ifndef GAME_SERVER_EVENTHANDLER_H
 #define GAME_SERVER_EVENTHANDLER_H
 
+#include <base/system.h>
+
 //
 class CEventHandler
 {
-	static const int MAX_EVENTS = 128;
-	static const int MAX_DATASIZE = 128*64;
+	enum
+	{
+		MAX_EVENTS=4096, // snap ids have to stay unique, more never fit into the snapshots anyway
+		MIN_EVENTS=128,
+		MIN_DATASIZE=128*64,
 
-	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
-	int m_aOffsets[MAX_EVENTS];
-	int m_aSizes[MAX_EVENTS];
-	int m_aClientMasks[MAX_EVENTS];
-	char m_aData[MAX_DATASIZE];
+		// events are bucketed by a grid over the map, so a snapping
+		// client only has to look at the cells around its view
+		CELL_SHIFT=9,
+		NUM_BUCKETS=256,
+		VIEW_RANGE=1500,
+	};
 
-	class CGameContext *m_pGameServer;
+	struct CEvent
+	{
+		int m_Type; // -1 when merged into another one
+		int m_Offset;
+		int m_Size;
+		int64 m_ClientMask;
+		int m_Next; // next event in the same bucket
+	};
 
-	int m_CurrentOffset;
+	CEvent *m_pEvents;
 	int m_NumEvents;
+	int m_EventCapacity;
+
+	char *m_pData;
+	int m_DataSize;
+	int m_DataCapacity;
+
+	int m_aBuckets[NUM_BUCKETS];
+	int m_NumBucketed;
+
+	class CGameContext *m_pGameServer;
+
+	// totals for dump_events
+	int64 m_NumCreated;
+	int64 m_NumMerged;
+	int64 m_NumDropped;
+	int64 m_NumSnapDropped;
+	int m_PeakEvents;
+
+	static int Bucket(int CellX, int CellY) { return (unsigned(CellX)*73856093u ^ unsigned(CellY)*19349663u)&(NUM_BUCKETS-1); }
+	void BucketEvents();
+	void SnapEvent(int SnappingClient, int Index);
+
 public:
 	CGameContext *GameServer() const { return m_pGameServer; }
 	void SetGameServer(CGameContext *pGameServer);
 
 	CEventHandler();
-	void *Create(int Type, int Size, int Mask = -1);
+	~CEventHandler();
+	void *Create(int Type, int Size, int64 Mask = -1);
 	void Clear();
 	void Snap(int SnappingClient);
+
+	int64 NumCreated() const { return m_NumCreated; }
+	int64 NumMerged() const { return m_NumMerged; }
+	int64 NumDropped() const { return m_NumDropped; }
+	int64 NumSnapDropped() const { return m_NumSnapDropped; }
+	int PeakEvents() const { return m_PeakEvents; }
 };
 
 #endif
@@ -5,6 +5,7 @@
 #include <engine/shared/config.h>
 #include <engine/map.h>
 #include <engine/console.h>
+#include <engine/storage.h>
 #include "gamecontext.h"
 #include <game/version.h>
 #include <game/collision.h>
@@ -95,6 +96,106 @@ class CCharacter *CGameContext::GetPlayerChar(int ClientID)
 	return m_apPlayers[ClientID]->GetCharacter();
 }
 
+void CGameContext::UpdateIDMap(int ClientID)
+{
+	if(Server()->MaxClients() <= VANILLA_MAX_CLIENTS || ClientID < 0 || !m_apPlayers[ClientID])
+		return;
+
+	// the client itself and whoever it watches come first, then the closest players.
+	// players that already have an id get a head start so the map doesn't flicker
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+	int aOrder[MAX_CLIENTS];
+	float aDist[MAX_CLIENTS];
+	int Num = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(!m_apPlayers[i])
+			continue;
+
+		float Dist = 1e10f;
+		if(i == ClientID)
+			Dist = -2.0f;
+		else if(i == pPlayer->m_SpectatorID)
+			Dist = -1.0f;
+		else if(m_apPlayers[i]->GetCharacter())
+		{
+			Dist = distance(pPlayer->m_ViewPos, m_apPlayers[i]->GetCharacter()->GetPos());
+			if(pPlayer->m_aReverseIDMap[i] != -1)
+				Dist -= 200.0f;
+		}
+		aOrder[Num] = i;
+		aDist[i] = Dist;
+		Num++;
+	}
+
+	int NumChosen = min(Num, (int)VANILLA_MAX_CLIENTS);
+	for(int k = 0; k < NumChosen; k++)
+	{
+		int Best = k;
+		for(int j = k+1; j < Num; j++)
+			if(aDist[aOrder[j]] < aDist[aOrder[Best]])
+				Best = j;
+		int Tmp = aOrder[k];
+		aOrder[k] = aOrder[Best];
+		aOrder[Best] = Tmp;
+	}
+
+	bool aChosen[MAX_CLIENTS] = {0};
+	for(int k = 0; k < NumChosen; k++)
+		aChosen[aOrder[k]] = true;
+
+	// free the ids of players that dropped out, then hand them to the new ones
+	for(int i = 0; i < VANILLA_MAX_CLIENTS; i++)
+	{
+		int ID = pPlayer->m_aIDMap[i];
+		if(ID != -1 && !aChosen[ID])
+		{
+			pPlayer->m_aReverseIDMap[ID] = -1;
+			pPlayer->m_aIDMap[i] = -1;
+		}
+	}
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(!aChosen[i])
+			pPlayer->m_aReverseIDMap[i] = -1;
+
+	int Free = 0;
+	for(int k = 0; k < NumChosen; k++)
+	{
+		int ID = aOrder[k];
+		if(pPlayer->m_aReverseIDMap[ID] != -1)
+			continue;
+		while(pPlayer->m_aIDMap[Free] != -1)
+			Free++;
+		pPlayer->m_aIDMap[Free] = ID;
+		pPlayer->m_aReverseIDMap[ID] = Free;
+	}
+}
+
+bool CGameContext::TranslateID(int ClientID, int *pID)
+{
+	if(*pID < 0 || Server()->MaxClients() <= VANILLA_MAX_CLIENTS)
+		return true;
+
+	// demos only get the first ids
+	if(ClientID < 0 || !m_apPlayers[ClientID])
+		return *pID < VANILLA_MAX_CLIENTS;
+
+	int ID = m_apPlayers[ClientID]->m_aReverseIDMap[*pID];
+	if(ID == -1)
+		return false;
+	*pID = ID;
+	return true;
+}
+
+int CGameContext::ReverseTranslateID(int ClientID, int ID)
+{
+	if(ID < 0 || Server()->MaxClients() <= VANILLA_MAX_CLIENTS || !m_apPlayers[ClientID])
+		return ID;
+	if(ID >= VANILLA_MAX_CLIENTS)
+		return -1;
+	return m_apPlayers[ClientID]->m_aIDMap[ID];
+}
+
 void CGameContext::CreateDamageInd(vec2 Pos, float Angle, int Amount)
 {
 	float a = 3 * 3.14159f / 2 + Angle;
@@ -193,7 +294,7 @@ void CGameContext::CreateDeath(vec2 Pos, int ClientID)
 	}
 }
 
-void CGameContext::CreateSound(vec2 Pos, int Sound, int Mask)
+void CGameContext::CreateSound(vec2 Pos, int Sound, int64 Mask)
 {
 	if (Sound < 0)
 		return;
@@ -246,7 +347,7 @@ void CGameContext::SendChat(int ChatterClientID, int Team, const char *pText)
 		str_format(aBuf, sizeof(aBuf), "*** %s", pText);
 	Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, Team!=CHAT_ALL?"teamchat":"chat", aBuf);
 
-	if(Team == CHAT_ALL)
+	if(Team == CHAT_ALL && Server()->MaxClients() <= VANILLA_MAX_CLIENTS)
 	{
 		CNetMsg_Sv_Chat Msg;
 		Msg.m_Team = 0;
@@ -257,18 +358,30 @@ void CGameContext::SendChat(int ChatterClientID, int Team, const char *pText)
 	else
 	{
 		CNetMsg_Sv_Chat Msg;
-		Msg.m_Team = 1;
+		Msg.m_Team = Team == CHAT_ALL ? 0 : 1;
 		Msg.m_ClientID = ChatterClientID;
 		Msg.m_pMessage = pText;
 
 		// pack one for the recording only
-		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_NOSEND, -1);
+		if(TranslateID(-1, &Msg.m_ClientID))
+			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_NOSEND, -1);
 
-		// send to the clients
+		// send to the clients, a chatter the client has no id for is sent as a server message
+		char aText[256];
+		str_format(aText, sizeof(aText), "%s: %s", ChatterClientID >= 0 ? Server()->ClientName(ChatterClientID) : "", pText);
 		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
-			if(m_apPlayers[i] && m_apPlayers[i]->GetTeam() == Team)
+			if(m_apPlayers[i] && (Team == CHAT_ALL || m_apPlayers[i]->GetTeam() == Team))
+			{
+				Msg.m_ClientID = ChatterClientID;
+				Msg.m_pMessage = pText;
+				if(!TranslateID(i, &Msg.m_ClientID))
+				{
+					Msg.m_ClientID = -1;
+					Msg.m_pMessage = aText;
+				}
 				Server()->SendPackMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_NORECORD, i);
+			}
 		}
 	}
 }
@@ -278,7 +391,18 @@ void CGameContext::SendEmoticon(int ClientID, int Emoticon)
 	CNetMsg_Sv_Emoticon Msg;
 	Msg.m_ClientID = ClientID;
 	Msg.m_Emoticon = Emoticon;
-	Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, -1);
+	if(Server()->MaxClients() <= VANILLA_MAX_CLIENTS)
+	{
+		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, -1);
+		return;
+	}
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		Msg.m_ClientID = ClientID;
+		if(m_apPlayers[i] && TranslateID(i, &Msg.m_ClientID))
+			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i);
+	}
 }
 
 void CGameContext::SendWeaponPickup(int ClientID, int Weapon)
@@ -388,6 +512,11 @@ void CGameContext::SendVoteSet(int ClientID)
 
 void CGameContext::SendVoteStatus(int ClientID, int Total, int Yes, int No)
 {
+	// the client can't show more votes than it has player slots
+	Total = min(Total, (int)VANILLA_MAX_CLIENTS);
+	Yes = min(Yes, Total);
+	No = min(No, Total-Yes);
+
 	CNetMsg_Sv_VoteStatus Msg = {0};
 	Msg.m_Total = Total;
 	Msg.m_Yes = Yes;
@@ -528,10 +657,11 @@ void CGameContext::OnTick()
 			if(m_VoteUpdate)
 			{
 				// count votes
-				char aaBuf[MAX_CLIENTS][NETADDR_MAXSTRSIZE] = {{0}};
+				NETADDR aAddrs[MAX_CLIENTS];
+				mem_zero(aAddrs, sizeof(aAddrs));
 				for(int i = 0; i < MAX_CLIENTS; i++)
 					if(m_apPlayers[i])
-						Server()->GetClientAddr(i, aaBuf[i], NETADDR_MAXSTRSIZE);
+						Server()->GetClientAddr(i, &aAddrs[i]);
 				bool aVoteChecked[MAX_CLIENTS] = {0};
 				for(int i = 0; i < MAX_CLIENTS; i++)
 				{
@@ -544,7 +674,7 @@ void CGameContext::OnTick()
 					// check for more players with the same ip (only use the vote of the one who voted first)
 					for(int j = i+1; j < MAX_CLIENTS; ++j)
 					{
-						if(!m_apPlayers[j] || aVoteChecked[j] || str_comp(aaBuf[j], aaBuf[i]))
+						if(!m_apPlayers[j] || aVoteChecked[j] || net_addr_comp(&aAddrs[j], &aAddrs[i]))
 							continue;
 
 						aVoteChecked[j] = true;
@@ -593,6 +723,7 @@ void CGameContext::OnTick()
 	}
 
 	// Test basic move for bots
+	m_pBotEngine->UpdateBlackboard();
 	for(int i = 0; i < MAX_CLIENTS ; i++)
 	{
 		if(!m_apPlayers[i] || !m_apPlayers[i]->m_IsBot)
@@ -607,7 +738,7 @@ void CGameContext::OnTick()
 		{
 			CNetObj_PlayerInput Input = {0};
 			Input.m_Direction = (i&1)?-1:1;
-			m_apPlayers[MAX_CLIENTS-i-1]->OnPredictedInput(&Input);
+			m_apPlayers[Server()->MaxClients()-i-1]->OnPredictedInput(&Input);
 		}
 	}
 #endif
@@ -699,7 +830,7 @@ void CGameContext::OnClientConnected(int ClientID)
 #ifdef CONF_DEBUG
 	if(g_Config.m_DbgDummies)
 	{
-		if(ClientID >= MAX_CLIENTS-g_Config.m_DbgDummies)
+		if(ClientID >= Server()->MaxClients()-g_Config.m_DbgDummies)
 			return;
 	}
 #endif
@@ -969,7 +1100,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 					}
 				}
 
-				int KickID = str_toint(pMsg->m_Value);
+				int KickID = ReverseTranslateID(ClientID, str_toint(pMsg->m_Value));
 				if(KickID < 0 || KickID >= MAX_CLIENTS || !m_apPlayers[KickID])
 				{
 					SendChatTarget(ClientID, "Invalid client id to kick");
@@ -1013,7 +1144,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 					return;
 				}
 
-				int SpectateID = str_toint(pMsg->m_Value);
+				int SpectateID = ReverseTranslateID(ClientID, str_toint(pMsg->m_Value));
 				if(SpectateID < 0 || SpectateID >= MAX_CLIENTS || !m_apPlayers[SpectateID] || m_apPlayers[SpectateID]->GetTeam() == TEAM_SPECTATORS)
 				{
 					SendChatTarget(ClientID, "Invalid client id to move");
@@ -1180,6 +1311,7 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 		else if (MsgID == NETMSGTYPE_CL_SETSPECTATORMODE && !m_World.m_Paused)
 		{
 			CNetMsg_Cl_SetSpectatorMode *pMsg = (CNetMsg_Cl_SetSpectatorMode *)pRawMsg;
+			pMsg->m_SpectatorID = ReverseTranslateID(ClientID, pMsg->m_SpectatorID);
 
 			if(pPlayer->GetTeam() != TEAM_SPECTATORS || pPlayer->m_SpectatorID == pMsg->m_SpectatorID || ClientID == pMsg->m_SpectatorID ||
 				(g_Config.m_SvSpamprotection && pPlayer->m_LastSetSpectatorMode && pPlayer->m_LastSetSpectatorMode+Server()->TickSpeed()*3 > Server()->Tick()))
@@ -1432,6 +1564,48 @@ void CGameContext::ConTuneDump(IConsole::IResult *pResult, void *pUserData)
 	}
 }
 
+void CGameContext::ConCoreRecord(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	char aFilename[128];
+	str_format(aFilename, sizeof(aFilename), "%s.core", pResult->GetString(0));
+	IOHANDLE File = pSelf->Kernel()->RequestInterface<IStorage>()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+
+	char aBuf[256];
+	if(pSelf->m_CoreRecorder.Start(File, g_Config.m_SvMap, &pSelf->m_Tuning))
+		str_format(aBuf, sizeof(aBuf), "recording to '%s'", aFilename);
+	else
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s'", aFilename);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "core_record", aBuf);
+}
+
+void CGameContext::ConCoreRecordStop(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	pSelf->m_CoreRecorder.Stop();
+}
+
+void CGameContext::ConDumpEntityPools(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	char aBuf[256];
+	for(CEntityPool *pPool = CEntityPool::First(); pPool; pPool = pPool->Next())
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: live=%d peak=%d slots=%d", pPool->Name(), pPool->NumLive(), pPool->PeakLive(), pPool->NumSlots());
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "entities", aBuf);
+	}
+}
+
+void CGameContext::ConDumpEvents(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "created=%d merged=%d dropped=%d snap_dropped=%d peak=%d",
+		(int)pSelf->m_Events.NumCreated(), (int)pSelf->m_Events.NumMerged(), (int)pSelf->m_Events.NumDropped(),
+		(int)pSelf->m_Events.NumSnapDropped(), pSelf->m_Events.PeakEvents());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "events", aBuf);
+}
+
 void CGameContext::ConPause(IConsole::IResult *pResult, void *pUserData)
 {
 	CGameContext *pSelf = (CGameContext *)pUserData;
@@ -2080,7 +2254,7 @@ void CGameContext::ConXonX(IConsole::IResult *pResult, void *pUserData)
 {
 	CGameContext *pSelf = (CGameContext *)pUserData;
 	int Mode = pResult->GetInteger(0);
-	g_Config.m_SvSpectatorSlots = MAX_CLIENTS - 2*Mode;
+	g_Config.m_SvSpectatorSlots = pSelf->Server()->MaxClients() - 2*Mode;
 	pSelf->m_pController->DoWarmup(g_Config.m_SvWarTime);
 	char aBuf[128];
 
@@ -2238,6 +2412,10 @@ void CGameContext::OnConsoleInit()
 	Console()->Register("tune", "s?i", CFGFLAG_SERVER, ConTuneParam, this, "Tune variable to value");
 	Console()->Register("tune_reset", "", CFGFLAG_SERVER, ConTuneReset, this, "Reset tuning");
 	Console()->Register("tune_dump", "", CFGFLAG_SERVER, ConTuneDump, this, "Dump tuning");
+	Console()->Register("dump_entity_pools", "", CFGFLAG_SERVER, ConDumpEntityPools, this, "Dump the number of live entities per pooled type");
+	Console()->Register("dump_events", "", CFGFLAG_SERVER, ConDumpEvents, this, "Dump the number of created, merged and dropped events");
+	Console()->Register("core_record", "s", CFGFLAG_SERVER, ConCoreRecord, this, "Record character inputs, projectiles and lasers to a file for core_replay");
+	Console()->Register("core_record_stop", "", CFGFLAG_SERVER, ConCoreRecordStop, this, "Stop recording character inputs");
 
 	Console()->Register("pause", "", CFGFLAG_SERVER, ConPause, this, "Pause/unpause game");
 	Console()->Register("change_map", "?r", CFGFLAG_SERVER|CFGFLAG_STORE, ConChangeMap, this, "Change map");
@@ -2386,7 +2564,7 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	{
 		for(int i = 0; i < g_Config.m_DbgDummies ; i++)
 		{
-			OnClientConnected(MAX_CLIENTS-i-1);
+			OnClientConnected(Server()->MaxClients()-i-1);
 		}
 	}
 #endif
@@ -2396,6 +2574,8 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 
 void CGameContext::OnShutdown()
 {
+	// the record only covers one map
+	m_CoreRecorder.Stop();
 	CLoltext::Destroy(&m_World, -1);
 	delete m_pController;
 	m_pController = 0;
@@ -2415,6 +2595,8 @@ void CGameContext::OnSnap(int ClientID)
 		Server()->SendMsg(&Msg, MSGFLAG_RECORD|MSGFLAG_NOSEND, ClientID);
 	}
 
+	UpdateIDMap(ClientID);
+
 	m_World.Snap(ClientID);
 	m_pController->Snap(ClientID);
 	m_Events.Snap(ClientID);
@@ -2432,9 +2614,14 @@ void CGameContext::OnSnap(int ClientID)
 			m_apPlayers[i]->Snap(ClientID);
 	}
 }
-void CGameContext::OnPreSnap() {}
+void CGameContext::OnPreSnap()
+{
+	m_World.PreSnap();
+}
+
 void CGameContext::OnPostSnap()
 {
+	m_World.PostSnap();
 	m_Events.Clear();
 }
 
@@ -2502,7 +2689,7 @@ bool CGameContext::AddBot(int i, bool UseDropPlayer) {
 		m_apPlayers[i] = new(i) CPlayer(this, i, StartTeam);
 	m_apPlayers[i]->m_IsBot = true;
 	m_apPlayers[i]->m_pBot = new CBot(m_pBotEngine, m_apPlayers[i]);
-	Server()->SetClientName(i, g_aBotName[i]);
+	Server()->SetClientName(i, g_aBotName[i%(sizeof(g_aBotName)/sizeof(g_aBotName[0]))]);
 	Server()->SetClientClan(i, g_BotClan);
 	return true;
 }
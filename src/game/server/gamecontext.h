@@ -17,6 +17,8 @@
 #include "mute.h"
 #include "botengine.h"
 
+#include <game/corerecord.h>
+
 #include "database/database.h"
 
 #include <string>
@@ -58,6 +60,10 @@ class CGameContext : public IGameServer
 	static void ConTuneParam(IConsole::IResult *pResult, void *pUserData);
 	static void ConTuneReset(IConsole::IResult *pResult, void *pUserData);
 	static void ConTuneDump(IConsole::IResult *pResult, void *pUserData);
+	static void ConDumpEntityPools(IConsole::IResult *pResult, void *pUserData);
+	static void ConDumpEvents(IConsole::IResult *pResult, void *pUserData);
+	static void ConCoreRecord(IConsole::IResult *pResult, void *pUserData);
+	static void ConCoreRecordStop(IConsole::IResult *pResult, void *pUserData);
 	static void ConPause(IConsole::IResult *pResult, void *pUserData);
 	static void ConChangeMap(IConsole::IResult *pResult, void *pUserData);
 	static void ConRestart(IConsole::IResult *pResult, void *pUserData);
@@ -113,6 +119,9 @@ public:
 	CEventHandler m_Events;
 	CPlayer *m_apPlayers[MAX_CLIENTS];
 
+	// character inputs, projectiles and lasers for the core_replay tool
+	CCoreRecorder m_CoreRecorder;
+
 	IGameController *m_pController;
 	CGameWorld m_World;
 
@@ -120,6 +129,11 @@ public:
 	class CCharacter *GetPlayerChar(int ClientID);
 	inline bool IsValidCID(int CID) { return (CID >= 0) && (CID < MAX_CLIENTS) && m_apPlayers[CID]; }
 
+	// id translation for servers with more than VANILLA_MAX_CLIENTS slots
+	void UpdateIDMap(int ClientID);
+	bool TranslateID(int ClientID, int *pID);
+	int ReverseTranslateID(int ClientID, int ID);
+
 	int m_LockTeams;
 
 	// voting
@@ -164,7 +178,7 @@ public:
 	void CreateHammerHit(vec2 Pos);
 	void CreatePlayerSpawn(vec2 Pos);
 	void CreateDeath(vec2 Pos, int Who);
-	void CreateSound(vec2 Pos, int Sound, int Mask=-1);
+	void CreateSound(vec2 Pos, int Sound, int64 Mask=-1);
 	void CreateSoundGlobal(int Sound, int Target=-1);
 
 
@@ -239,8 +253,8 @@ public:
 	bool CheckForCapslock(const char *pStr);
 };
 
-inline int CmaskAll() { return -1; }
-inline int CmaskOne(int ClientID) { return 1<<ClientID; }
-inline int CmaskAllExceptOne(int ClientID) { return 0x7fffffff^CmaskOne(ClientID); }
-inline bool CmaskIsSet(int Mask, int ClientID) { return (Mask&CmaskOne(ClientID)) != 0; }
+inline int64 CmaskAll() { return -1; }
+inline int64 CmaskOne(int ClientID) { return (int64)1<<ClientID; }
+inline int64 CmaskAllExceptOne(int ClientID) { return CmaskAll()^CmaskOne(ClientID); }
+inline bool CmaskIsSet(int64 Mask, int ClientID) { return (Mask&CmaskOne(ClientID)) != 0; }
 #endif
@@ -131,7 +131,11 @@ void CGameControllerCTF::Snap(int SnappingClient)
 		if(m_apFlags[TEAM_RED]->m_AtStand)
 			pGameDataObj->m_FlagCarrierRed = FLAG_ATSTAND;
 		else if(m_apFlags[TEAM_RED]->m_pCarryingCharacter && m_apFlags[TEAM_RED]->m_pCarryingCharacter->GetPlayer())
+		{
 			pGameDataObj->m_FlagCarrierRed = m_apFlags[TEAM_RED]->m_pCarryingCharacter->GetPlayer()->GetCID();
+			if(!GameServer()->TranslateID(SnappingClient, &pGameDataObj->m_FlagCarrierRed))
+				pGameDataObj->m_FlagCarrierRed = FLAG_TAKEN;
+		}
 		else
 			pGameDataObj->m_FlagCarrierRed = FLAG_TAKEN;
 	}
@@ -142,7 +146,11 @@ void CGameControllerCTF::Snap(int SnappingClient)
 		if(m_apFlags[TEAM_BLUE]->m_AtStand)
 			pGameDataObj->m_FlagCarrierBlue = FLAG_ATSTAND;
 		else if(m_apFlags[TEAM_BLUE]->m_pCarryingCharacter && m_apFlags[TEAM_BLUE]->m_pCarryingCharacter->GetPlayer())
+		{
 			pGameDataObj->m_FlagCarrierBlue = m_apFlags[TEAM_BLUE]->m_pCarryingCharacter->GetPlayer()->GetCID();
+			if(!GameServer()->TranslateID(SnappingClient, &pGameDataObj->m_FlagCarrierBlue))
+				pGameDataObj->m_FlagCarrierBlue = FLAG_TAKEN;
+		}
 		else
 			pGameDataObj->m_FlagCarrierBlue = FLAG_TAKEN;
 	}
@@ -17,6 +17,13 @@ CGameWorld::CGameWorld()
 	m_ResetRequested = false;
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		m_apFirstEntityTypes[i] = 0;
+
+	m_ppSnapEntities = 0;
+	m_pSnapEntityCells = 0;
+	m_SnapEntityCapacity = 0;
+	m_pSnapCellStart = 0;
+	m_SnapCellCapacity = 0;
+	m_NumSnapEntities = -1;
 }
 
 CGameWorld::~CGameWorld()
@@ -25,6 +32,10 @@ CGameWorld::~CGameWorld()
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		while(m_apFirstEntityTypes[i])
 			delete m_apFirstEntityTypes[i];
+
+	mem_free(m_ppSnapEntities);
+	mem_free(m_pSnapEntityCells);
+	mem_free(m_pSnapCellStart);
 }
 
 void CGameWorld::SetGameServer(CGameContext *pGameServer)
@@ -102,15 +113,85 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 }
 
 //
-void CGameWorld::Snap(int SnappingClient)
+void CGameWorld::PreSnap()
 {
+	m_SnapGrid.Init(GameServer()->Collision()->GetWidth(), GameServer()->Collision()->GetHeight());
+	int NumCells = m_SnapGrid.NumCells();
+
+	int Num = 0;
 	for(int i = 0; i < NUM_ENTTYPES; i++)
-		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			Num++;
+
+	if(Num > m_SnapEntityCapacity)
+	{
+		mem_free(m_ppSnapEntities);
+		mem_free(m_pSnapEntityCells);
+		m_SnapEntityCapacity = max(Num, m_SnapEntityCapacity*2);
+		m_ppSnapEntities = (CEntity **)mem_alloc(m_SnapEntityCapacity*sizeof(CEntity *), 1);
+		m_pSnapEntityCells = (int *)mem_alloc(m_SnapEntityCapacity*sizeof(int), 1);
+	}
+	if(NumCells+3 > m_SnapCellCapacity)
+	{
+		mem_free(m_pSnapCellStart);
+		m_SnapCellCapacity = NumCells+3;
+		m_pSnapCellStart = (int *)mem_alloc(m_SnapCellCapacity*sizeof(int), 1);
+	}
+
+	// count the entities per cell, the cell of the outside is the last one
+	mem_zero(m_pSnapCellStart, (NumCells+3)*sizeof(int));
+	Num = 0;
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
 		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Snap(SnappingClient);
-			pEnt = m_pNextTraverseEntity;
+			int Cell = m_SnapGrid.Cell(pEnt->GetSnapPos());
+			m_pSnapEntityCells[Num++] = Cell;
+			m_pSnapCellStart[Cell+2]++;
 		}
+	for(int c = 2; c < NumCells+3; c++)
+		m_pSnapCellStart[c] += m_pSnapCellStart[c-1];
+
+	// place them, afterwards cell c holds the entities from m_pSnapCellStart[c] to m_pSnapCellStart[c+1]
+	Num = 0;
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			m_ppSnapEntities[m_pSnapCellStart[m_pSnapEntityCells[Num++]+1]++] = pEnt;
+
+	m_NumSnapEntities = Num;
+}
+
+void CGameWorld::PostSnap()
+{
+	// entities can go away before the next snapshot
+	m_NumSnapEntities = -1;
+}
+
+void CGameWorld::Snap(int SnappingClient)
+{
+	if(SnappingClient == -1 || m_NumSnapEntities == -1)
+	{
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				pEnt->Snap(SnappingClient);
+				pEnt = m_pNextTraverseEntity;
+			}
+		return;
+	}
+
+	// the cells of a row in view are next to each other in the list
+	CSnapGrid::CView View = m_SnapGrid.View(GameServer()->m_apPlayers[SnappingClient]->m_ViewPos);
+	for(int y = View.m_Y0; y <= View.m_Y1; y++)
+	{
+		int Row = y*m_SnapGrid.Width();
+		for(int i = m_pSnapCellStart[Row+View.m_X0]; i < m_pSnapCellStart[Row+View.m_X1+1]; i++)
+			m_ppSnapEntities[i]->Snap(SnappingClient);
+	}
+
+	int Outside = m_SnapGrid.OutsideCell();
+	for(int i = m_pSnapCellStart[Outside]; i < m_pSnapCellStart[Outside+1]; i++)
+		m_ppSnapEntities[i]->Snap(SnappingClient);
 }
 
 void CGameWorld::Reset()
@@ -196,12 +277,21 @@ CCharacter *CGameWorld::IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, v
 	float ClosestLen = distance(Pos0, Pos1) * 100.0f;
 	CCharacter *pClosest = 0;
 
+	// characters far enough from the bounding box of the line can't be
+	// hit, the extra unit keeps rounding errors of the exact test out
+	vec2 Min = vec2(min(Pos0.x, Pos1.x), min(Pos0.y, Pos1.y)) - vec2(Radius+1.0f, Radius+1.0f);
+	vec2 Max = vec2(max(Pos0.x, Pos1.x), max(Pos0.y, Pos1.y)) + vec2(Radius+1.0f, Radius+1.0f);
+
 	CCharacter *p = (CCharacter *)FindFirst(ENTTYPE_CHARACTER);
 	for(; p; p = (CCharacter *)p->TypeNext())
  	{
 		if(p == pNotThis)
 			continue;
 
+		if(p->m_Pos.x < Min.x-p->m_ProximityRadius || p->m_Pos.x > Max.x+p->m_ProximityRadius ||
+			p->m_Pos.y < Min.y-p->m_ProximityRadius || p->m_Pos.y > Max.y+p->m_ProximityRadius)
+			continue;
+
 		vec2 IntersectPos = closest_point_on_line(Pos0, Pos1, p->m_Pos);
 		float Len = distance(p->m_Pos, IntersectPos);
 		if(Len < p->m_ProximityRadius+Radius)
@@ -5,6 +5,8 @@
 
 #include <game/gamecore.h>
 
+#include "snapgrid.h"
+
 class CEntity;
 class CCharacter;
 
@@ -33,6 +35,15 @@ private:
 	CEntity *m_pNextTraverseEntity;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
 
+	// all entities by snap grid cell, rebuilt before every snapshot
+	CSnapGrid m_SnapGrid;
+	CEntity **m_ppSnapEntities;
+	int *m_pSnapEntityCells;
+	int m_SnapEntityCapacity;
+	int *m_pSnapCellStart;
+	int m_SnapCellCapacity;
+	int m_NumSnapEntities; // -1 when there is no grid for this snapshot
+
 	class CGameContext *m_pGameServer;
 	class IServer *m_pServer;
 
@@ -136,6 +147,15 @@ public:
 	*/
 	void Snap(int SnappingClient);
 
+	/*
+		Function: PreSnap
+			Sorts the entities into the snap grid, so every client
+			only snaps the ones around its view. Has to be called
+			before the snaps of a snapshot, PostSnap after them.
+	*/
+	void PreSnap();
+	void PostSnap();
+
 	/*
 		Function: tick
 			Calls tick on all the entities in the world to progress
@@ -9,10 +9,10 @@
 #include <game/server/gamecontext.h>
 #include "mute.h"
 
-CMute::CMute() :
-		m_Mutes(MAX_MUTES)
+CMute::CMute()
 {
 	mem_zero(this, sizeof(CMute));
+	Reset();
 }
 
 void CMute::Init(CGameContext *pGameServer)
@@ -30,6 +30,20 @@ void CMute::OnConsoleInit(IConsole *pConsole)
 	Console()->Register("mutes", "", CFGFLAG_SERVER, ConMutes, this, "Show all mutes");
 }
 
+void CMute::Reset()
+{
+	mem_zero(m_apHashList, sizeof(m_apHashList));
+	m_pFirstFree = 0;
+	for(int i = MAX_MUTES-1; i >= 0; i--)
+	{
+		m_aMutes[i].m_HeapIndex = -1;
+		m_aMutes[i].m_pNextFree = m_pFirstFree;
+		m_pFirstFree = &m_aMutes[i];
+	}
+	m_NumMutes = 0;
+	m_LastPurge = -1;
+}
+
 int CMute::NumMutes()
 {
 	if(m_LastPurge != Server()->Tick())
@@ -37,50 +51,160 @@ int CMute::NumMutes()
 		m_LastPurge = Server()->Tick();
 		PurgeMutes();
 	}
-	return m_Mutes.Num();
+	return m_NumMutes;
 }
 
 void CMute::PurgeMutes()
 {
-	int i = 0;
-	while(i < NumMutes())
+	// the heap root is always the mute which expires first
+	while(m_NumMutes > 0 && m_apExpiryHeap[0]->m_Expires <= Server()->Tick())
+		RemoveMute(m_apExpiryHeap[0]);
+}
+
+int CMute::Hash(const NETADDR *pAddr)
+{
+	unsigned Hash = 2166136261u;
+	int Length = (pAddr->type&NETTYPE_IPV6) ? 16 : 4;
+	for(int i = 0; i < Length; i++)
+		Hash = (Hash^pAddr->ip[i])*16777619u;
+	return (Hash^(Hash>>HASH_BITS))&(HASH_SIZE-1);
+}
+
+bool CMute::ClientAddr(int ClientID, NETADDR *pAddr)
+{
+	mem_zero(pAddr, sizeof(NETADDR));
+	return Server()->GetClientAddr(ClientID, pAddr);
+}
+
+void CMute::HeapSwap(int Index1, int Index2)
+{
+	CMuteEntry *pTemp = m_apExpiryHeap[Index1];
+	m_apExpiryHeap[Index1] = m_apExpiryHeap[Index2];
+	m_apExpiryHeap[Index2] = pTemp;
+	m_apExpiryHeap[Index1]->m_HeapIndex = Index1;
+	m_apExpiryHeap[Index2]->m_HeapIndex = Index2;
+}
+
+void CMute::HeapUp(int Index)
+{
+	while(Index > 0)
 	{
-		const CMuteEntry *pMute = m_Mutes.Get(i);
-		if(pMute->m_Expires <= Server()->Tick())
-			m_Mutes.Remove(i);
-		else
-			i++;
+		int Parent = (Index-1)/2;
+		if(m_apExpiryHeap[Parent]->m_Expires <= m_apExpiryHeap[Index]->m_Expires)
+			break;
+		HeapSwap(Index, Parent);
+		Index = Parent;
 	}
 }
 
-bool CMute::AddMute(const char* pIP, int Secs)
+void CMute::HeapDown(int Index)
 {
-	CMuteEntry *pMute = Muted(pIP);
+	while(1)
+	{
+		int Smallest = Index;
+		int Left = Index*2+1;
+		int Right = Left+1;
+		if(Left < m_NumMutes && m_apExpiryHeap[Left]->m_Expires < m_apExpiryHeap[Smallest]->m_Expires)
+			Smallest = Left;
+		if(Right < m_NumMutes && m_apExpiryHeap[Right]->m_Expires < m_apExpiryHeap[Smallest]->m_Expires)
+			Smallest = Right;
+		if(Smallest == Index)
+			break;
+		HeapSwap(Index, Smallest);
+		Index = Smallest;
+	}
+}
+
+void CMute::HeapUpdate(int Index)
+{
+	if(Index > 0 && m_apExpiryHeap[(Index-1)/2]->m_Expires > m_apExpiryHeap[Index]->m_Expires)
+		HeapUp(Index);
+	else
+		HeapDown(Index);
+}
+
+void CMute::RemoveMute(CMuteEntry *pMute)
+{
+	// remove from hash list
+	if(pMute->m_pHashNext)
+		pMute->m_pHashNext->m_pHashPrev = pMute->m_pHashPrev;
+	if(pMute->m_pHashPrev)
+		pMute->m_pHashPrev->m_pHashNext = pMute->m_pHashNext;
+	else
+		m_apHashList[pMute->m_Hash] = pMute->m_pHashNext;
+	pMute->m_pHashNext = pMute->m_pHashPrev = 0;
+
+	// remove from heap by moving the last entry into the gap
+	int Index = pMute->m_HeapIndex;
+	m_NumMutes--;
+	if(Index != m_NumMutes)
+	{
+		m_apExpiryHeap[Index] = m_apExpiryHeap[m_NumMutes];
+		m_apExpiryHeap[Index]->m_HeapIndex = Index;
+		HeapUpdate(Index);
+	}
+
+	// add to free list
+	pMute->m_HeapIndex = -1;
+	pMute->m_pNextFree = m_pFirstFree;
+	m_pFirstFree = pMute;
+}
+
+bool CMute::AddMute(const NETADDR *pAddr, int Secs)
+{
+	CMuteEntry *pMute = Muted(pAddr);
 	if(Secs < 0)
 	{
 		Unmute(pMute);
 		return false;
 	}
 
+	int Expires = Server()->TickSpeed() * Secs + Server()->Tick();
 	if(pMute)
-		pMute->m_Expires = Server()->TickSpeed() * Secs + Server()->Tick(); // overwrite mute
+	{
+		// overwrite mute
+		pMute->m_Expires = Expires;
+		HeapUpdate(pMute->m_HeapIndex);
+	}
 	else
 	{
-		CMuteEntry Mute;
-		str_copy(Mute.m_aIP, pIP, sizeof(Mute.m_aIP));
-		Mute.m_Expires = Server()->TickSpeed() * Secs + Server()->Tick();
+		if(!m_pFirstFree)
+		{
+			// drop the mute which would expire first to make room
+			if(m_apExpiryHeap[0]->m_Expires > Expires)
+				return false;
+			RemoveMute(m_apExpiryHeap[0]);
+		}
 
-		m_Mutes.Add(Mute);
+		pMute = m_pFirstFree;
+		m_pFirstFree = pMute->m_pNextFree;
+		pMute->m_pNextFree = 0;
+		pMute->m_Addr = *pAddr;
+		pMute->m_Expires = Expires;
+
+		// add it to the hash list
+		pMute->m_Hash = Hash(pAddr);
+		pMute->m_pHashPrev = 0;
+		pMute->m_pHashNext = m_apHashList[pMute->m_Hash];
+		if(pMute->m_pHashNext)
+			pMute->m_pHashNext->m_pHashPrev = pMute;
+		m_apHashList[pMute->m_Hash] = pMute;
+
+		// add it to the heap
+		pMute->m_HeapIndex = m_NumMutes;
+		m_apExpiryHeap[m_NumMutes++] = pMute;
+		HeapUp(pMute->m_HeapIndex);
 	}
 	return true;
 }
 
 void CMute::AddMute(int ClientID, int Secs)
 {
-	char aAddrStr[NETADDR_MAXSTRSIZE] = { 0 };
-	Server()->GetClientAddr(ClientID, aAddrStr, sizeof(aAddrStr));
+	NETADDR Addr;
+	if(!ClientAddr(ClientID, &Addr))
+		return;
 
-	if(AddMute(aAddrStr, Secs))
+	if(AddMute(&Addr, Secs))
 	{
 		char aBuf[128];
 		str_format(aBuf, sizeof(aBuf), "%s has been muted for %d min and %d sec.", Server()->ClientName(ClientID), Secs / 60, Secs % 60);
@@ -88,22 +212,23 @@ void CMute::AddMute(int ClientID, int Secs)
 	}
 }
 
-CMute::CMuteEntry *CMute::Muted(const char* pIP)
+CMute::CMuteEntry *CMute::Muted(const NETADDR *pAddr)
 {
-	if(!pIP[0])
+	if(!NumMutes())
 		return 0;
 
-	for(int i = 0; i < NumMutes(); i++)
-		if(!str_comp_num(pIP, m_Mutes.Get(i)->m_aIP, sizeof(m_Mutes.Get(i)->m_aIP)))
-			return const_cast<CMuteEntry *>(m_Mutes.Get(i));
+	for(CMuteEntry *pMute = m_apHashList[Hash(pAddr)]; pMute; pMute = pMute->m_pHashNext)
+		if(net_addr_comp(&pMute->m_Addr, pAddr) == 0)
+			return pMute;
 	return 0;
 }
 
 CMute::CMuteEntry *CMute::Muted(int ClientID)
 {
-	char aAddrStr[NETADDR_MAXSTRSIZE] = { 0 };
-	Server()->GetClientAddr(ClientID, aAddrStr, sizeof(aAddrStr));
-	return Muted(aAddrStr);
+	NETADDR Addr;
+	if(!ClientAddr(ClientID, &Addr))
+		return 0;
+	return Muted(&Addr);
 }
 
 CMute::CMuteEntry *CMute::GetMute(int Num)
@@ -111,28 +236,30 @@ CMute::CMuteEntry *CMute::GetMute(int Num)
 	if(Num < 0 || Num >= NumMutes())
 		return 0;
 
-	return const_cast<CMuteEntry *>(m_Mutes.Get(Num));
+	return m_apExpiryHeap[Num];
 }
 
 void CMute::Unmute(CMuteEntry *pMute)
 {
 	if(!pMute)
 		return;
-	pMute->m_Expires = 0;
 
-	char aAddrStr[NETADDR_MAXSTRSIZE] = { 0 }, aBuf[128];
+	char aAddrStr[NETADDR_MAXSTRSIZE], aBuf[128];
+	NETADDR Addr;
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
-		Server()->GetClientAddr(i, aAddrStr, sizeof(aAddrStr));
-		if(str_comp(aAddrStr, pMute->m_aIP) == 0)
+		if(ClientAddr(i, &Addr) && net_addr_comp(&Addr, &pMute->m_Addr) == 0)
 		{
 			str_format(aBuf, sizeof(aBuf), "%s has been unmuted.", Server()->ClientName(i));
 			GameServer()->SendChatTarget(-1, aBuf);
 			break;
 		}
 	}
-	str_format(aBuf, sizeof(aBuf), "unmuted %s", pMute->m_aIP);
+	net_addr_str(&pMute->m_Addr, aAddrStr, sizeof(aAddrStr), false);
+	str_format(aBuf, sizeof(aBuf), "unmuted %s", aAddrStr);
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Mutes", aBuf);
+
+	RemoveMute(pMute);
 }
 
 // Console commands
@@ -153,13 +280,15 @@ void CMute::ConMute(IConsole::IResult *pResult, void *pUserData)
 void CMute::ConMutes(IConsole::IResult *pResult, void *pUserData)
 {
 	CMute *pSelf = (CMute *) pUserData;
-	char aBuf[128];
+	char aBuf[128], aAddrStr[NETADDR_MAXSTRSIZE];
 	int Sec, Count = 0;
 
 	for(int i = 0; i < pSelf->NumMutes(); i++)
 	{
-		Sec = (pSelf->m_Mutes.Get(i)->m_Expires - pSelf->Server()->Tick()) / pSelf->Server()->TickSpeed();
-		str_format(aBuf, sizeof(aBuf), "#%d: %s for %d minutes and %d sec", Count, pSelf->m_Mutes.Get(i)->m_aIP, Sec / 60, Sec % 60);
+		const CMuteEntry *pMute = pSelf->m_apExpiryHeap[i];
+		Sec = (pMute->m_Expires - pSelf->Server()->Tick()) / pSelf->Server()->TickSpeed();
+		net_addr_str(&pMute->m_Addr, aAddrStr, sizeof(aAddrStr), false);
+		str_format(aBuf, sizeof(aBuf), "#%d: %s for %d minutes and %d sec", Count, aAddrStr, Sec / 60, Sec % 60);
 		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Mutes", aBuf);
 		Count++;
 	}
@@ -8,7 +8,7 @@
 #ifndef GAME_SERVER_MUTE_H
 #define GAME_SERVER_MUTE_H
 
-#include <base/List.h>
+#include <base/system.h>
 #include <engine/shared/config.h>
 #include <engine/console.h>
 
@@ -33,10 +33,25 @@ public:
 	 */
 	struct CMuteEntry
 	{
-		char m_aIP[NETADDR_MAXSTRSIZE];
+		NETADDR m_Addr;
 		int m_Expires;
+
+		// hash list
+		CMuteEntry *m_pHashNext;
+		CMuteEntry *m_pHashPrev;
+		int m_Hash;
+
+		// position in the expiry heap, -1 if the entry is free
+		int m_HeapIndex;
+		// free list
+		CMuteEntry *m_pNextFree;
+	};
+	enum
+	{
+		MAX_MUTES = 4096,
+		HASH_BITS = 10,
+		HASH_SIZE = 1<<HASH_BITS,
 	};
-	enum { MAX_MUTES = 128 };
 
 	/**
 	 * Function for initialization
@@ -49,11 +64,15 @@ public:
 	/**
 	 * Return the number of current mutes
 	 */
-	inline int NumMutes();
+	int NumMutes();
 	/**
 	 * Remove expired mutes
 	 */
 	void PurgeMutes();
+	/**
+	 * Remove all mutes
+	 */
+	void Reset();
 	/**
 	 * Mutes a player by given ClientID for Secs seconds
 	 */
@@ -69,22 +88,44 @@ public:
 
 private:
 	/**
-	 * List where our mutes are saved in
+	 * Pool of mute entries, indexed by address hash and ordered by expiry
+	 * in a binary min-heap, so lookups and purges don't depend on the
+	 * number of mutes
 	 */
-	CList<CMuteEntry> m_Mutes;
+	CMuteEntry m_aMutes[MAX_MUTES];
+	CMuteEntry *m_apHashList[HASH_SIZE];
+	CMuteEntry *m_apExpiryHeap[MAX_MUTES];
+	CMuteEntry *m_pFirstFree;
+	int m_NumMutes;
+	int m_LastPurge;
+
+	static int Hash(const NETADDR *pAddr);
+	/**
+	 * Fills pAddr with the address of the client without port
+	 */
+	bool ClientAddr(int ClientID, NETADDR *pAddr);
+
+	void HeapSwap(int Index1, int Index2);
+	void HeapUp(int Index);
+	void HeapDown(int Index);
+	void HeapUpdate(int Index);
+
 	/**
 	 * Returns a pointer to the mute or null if not muted
 	 */
-	CMuteEntry *Muted(const char* pIP);
+	CMuteEntry *Muted(const NETADDR *pAddr);
 	/**
 	 * Mute an IP for Secs seconds
 	 */
-	bool AddMute(const char* pIP, int Secs);
+	bool AddMute(const NETADDR *pAddr, int Secs);
 	/**
-	 * Remove a mute by given MuteEntry
+	 * Remove a mute by given MuteEntry and announce it
 	 */
 	void Unmute(CMuteEntry *pMute);
-	int m_LastPurge;
+	/**
+	 * Give the entry back to the pool
+	 */
+	void RemoveMute(CMuteEntry *pMute);
 };
 
 #endif /* GAME_SERVER_MUTE_H */
@@ -51,6 +51,11 @@ public:
 	// used for spectator mode
 	int m_SpectatorID;
 
+	// clients only know VANILLA_MAX_CLIENTS ids, these map them to the
+	// real client ids and back. -1 marks a free or unmapped id
+	int m_aIDMap[VANILLA_MAX_CLIENTS];
+	int m_aReverseIDMap[MAX_CLIENTS];
+
 	bool m_IsReady;
 
 	int m_Version;
@@ -0,0 +1,76 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_SNAPGRID_H
+#define GAME_SERVER_SNAPGRID_H
+
+#include <base/math.h>
+#include <base/vmath.h>
+
+// the map in cells of 512 units. a snapping client only has to look at
+// what is in the cells its view touches, everything else is network
+// clipped anyway. positions outside of the map share one extra cell that
+// every client looks at
+class CSnapGrid
+{
+public:
+	enum
+	{
+		CELL_SHIFT=9,
+
+		// the view of CEntity::NetworkClipped, with some room for rounding
+		VIEW_WIDTH=1000+32,
+		VIEW_HEIGHT=800+32,
+	};
+
+	// cells in view, inclusive
+	struct CView
+	{
+		int m_X0, m_Y0;
+		int m_X1, m_Y1;
+	};
+
+	CSnapGrid() { m_Width = 1; m_Height = 1; }
+
+	void Init(int MapWidth, int MapHeight)
+	{
+		m_Width = max(((MapWidth*32)>>CELL_SHIFT)+1, 1);
+		m_Height = max(((MapHeight*32)>>CELL_SHIFT)+1, 1);
+	}
+
+	int Width() const { return m_Width; }
+	int NumCells() const { return m_Width*m_Height; }
+	int OutsideCell() const { return NumCells(); }
+
+	int Cell(vec2 Pos) const
+	{
+		// written so nan ends up outside as well
+		if(!(Pos.x >= 0.0f && Pos.y >= 0.0f && Pos.x < (float)(m_Width<<CELL_SHIFT) && Pos.y < (float)(m_Height<<CELL_SHIFT)))
+			return OutsideCell();
+		return ((int)Pos.y>>CELL_SHIFT)*m_Width + ((int)Pos.x>>CELL_SHIFT);
+	}
+
+	CView View(vec2 ViewPos) const
+	{
+		CView View;
+		View.m_X0 = Coord(ViewPos.x-VIEW_WIDTH, m_Width);
+		View.m_Y0 = Coord(ViewPos.y-VIEW_HEIGHT, m_Height);
+		View.m_X1 = Coord(ViewPos.x+VIEW_WIDTH, m_Width);
+		View.m_Y1 = Coord(ViewPos.y+VIEW_HEIGHT, m_Height);
+		return View;
+	}
+
+private:
+	int m_Width;
+	int m_Height;
+
+	static int Coord(float Value, int Size)
+	{
+		if(!(Value >= 0.0f))
+			return 0;
+		if(Value >= (float)(Size<<CELL_SHIFT))
+			return Size-1;
+		return (int)Value>>CELL_SHIFT;
+	}
+};
+
+#endif
@@ -0,0 +1,244 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+
+#include "collision.h"
+#include "spawns.h"
+
+// half the diagonal of a cell plus the farthest free position next to a spawn point
+const float CSpawns::ms_DangerSlack = 56.0f;
+
+CSpawns::CSpawns()
+{
+	Init(0);
+}
+
+void CSpawns::Init(CCollision *pCollision)
+{
+	m_pCollision = pCollision;
+	mem_zero(m_aNumSpawnPoints, sizeof(m_aNumSpawnPoints));
+	m_NumCharacters = 0;
+
+	mem_zero(m_aaaDangerBound, sizeof(m_aaaDangerBound));
+	mem_zero(m_aDangerCounted, sizeof(m_aDangerCounted));
+	m_NumDangerCounted = 0;
+}
+
+void CSpawns::Add(int Type, vec2 Pos)
+{
+	if(m_aNumSpawnPoints[Type] < MAX_SPAWNS)
+		m_aaSpawnPoints[Type][m_aNumSpawnPoints[Type]++] = Pos;
+}
+
+void CSpawns::SetCharacters(const CCharacterInfo *pCharacters, int Num)
+{
+	m_NumCharacters = min(Num, (int)MAX_CLIENTS);
+	mem_copy(m_aCharacters, pCharacters, m_NumCharacters*sizeof(CCharacterInfo));
+	UpdateDanger();
+}
+
+void CSpawns::ChangeDanger(ivec2 Cell, int Team, double Factor)
+{
+	vec2 Pos = vec2((Cell.x+0.5f)*DANGER_CELL, (Cell.y+0.5f)*DANGER_CELL);
+	for(int Type = 0; Type < NUM_TYPES; Type++)
+		for(int i = 0; i < m_aNumSpawnPoints[Type]; i++)
+			m_aaaDangerBound[Type][i][Team] += Factor / (distance(m_aaSpawnPoints[Type][i], Pos)+ms_DangerSlack);
+}
+
+void CSpawns::UpdateDanger()
+{
+	bool aSeen[MAX_CLIENTS] = {0};
+	for(int c = 0; c < m_NumCharacters; c++)
+	{
+		const CCharacterInfo *pChr = &m_aCharacters[c];
+		int ClientID = pChr->m_ClientID;
+		int Team = pChr->m_Team&1;
+		ivec2 Cell = ivec2((int)floorf(pChr->m_Pos.x/DANGER_CELL), (int)floorf(pChr->m_Pos.y/DANGER_CELL));
+		aSeen[ClientID] = true;
+
+		if(m_aDangerCounted[ClientID])
+		{
+			if(m_aDangerCell[ClientID] == Cell && m_aDangerTeam[ClientID] == Team)
+				continue;
+			ChangeDanger(m_aDangerCell[ClientID], m_aDangerTeam[ClientID], -1.0);
+		}
+		else
+			m_NumDangerCounted++;
+
+		ChangeDanger(Cell, Team, 1.0);
+		m_aDangerCounted[ClientID] = true;
+		m_aDangerCell[ClientID] = Cell;
+		m_aDangerTeam[ClientID] = Team;
+	}
+
+	// remove the characters that are gone
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aDangerCounted[i] && !aSeen[i])
+		{
+			ChangeDanger(m_aDangerCell[i], m_aDangerTeam[i], -1.0);
+			m_aDangerCounted[i] = false;
+			m_NumDangerCounted--;
+		}
+	}
+
+	// get rid of the rounding errors that added up
+	if(!m_NumDangerCounted)
+		mem_zero(m_aaaDangerBound, sizeof(m_aaaDangerBound));
+}
+
+double CSpawns::DangerBound(int Type, int Index, int FriendlyTeam) const
+{
+	// team mates are not as dangerous as enemies
+	const double *pDanger = m_aaaDangerBound[Type][Index];
+	if(FriendlyTeam == -1)
+		return pDanger[0] + pDanger[1];
+	return pDanger[FriendlyTeam&1]*0.5 + pDanger[(FriendlyTeam+1)&1];
+}
+
+float CSpawns::EvaluateSpawnPos(CEval *pEval, vec2 Pos) const
+{
+	float Score = 0.0f;
+	for(int c = 0; c < m_NumCharacters; c++)
+	{
+		// team mates are not as dangerous as enemies
+		float Scoremod = 1.0f;
+		if(pEval->m_FriendlyTeam != -1 && m_aCharacters[c].m_Team == pEval->m_FriendlyTeam)
+			Scoremod = 0.5f;
+
+		float d = distance(Pos, m_aCharacters[c].m_Pos);
+		Score += Scoremod * (d == 0 ? 1000000000.0f : 1.0f/d);
+	}
+
+	return Score;
+}
+
+bool CSpawns::FindFreeSpawnPos(vec2 SpawnPoint, vec2 *pPos) const
+{
+	// check if the position is occupado
+	const CCharacterInfo *apChrs[MAX_CLIENTS];
+	int Num = 0;
+	for(int c = 0; c < m_NumCharacters; c++)
+		if(distance(m_aCharacters[c].m_Pos, SpawnPoint) < 64+PROXIMITY_RADIUS)
+			apChrs[Num++] = &m_aCharacters[c];
+
+	vec2 Positions[5] = { vec2(0.0f, 0.0f), vec2(-32.0f, 0.0f), vec2(0.0f, -32.0f), vec2(32.0f, 0.0f), vec2(0.0f, 32.0f) };	// start, left, up, right, down
+	int Result = -1;
+	for(int Index = 0; Index < 5 && Result == -1; ++Index)
+	{
+		Result = Index;
+		for(int c = 0; c < Num; ++c)
+			if(m_pCollision->CheckPoint(SpawnPoint+Positions[Index]) ||
+				distance(apChrs[c]->m_Pos, SpawnPoint+Positions[Index]) <= PROXIMITY_RADIUS)
+			{
+				Result = -1;
+				break;
+			}
+	}
+	if(Result == -1)
+		return false;
+
+	*pPos = SpawnPoint+Positions[Result];
+	return true;
+}
+
+void CSpawns::EvaluateSpawnType(CEval *pEval, int Type)
+{
+	// get spawn point
+	for(int i = 0; i < m_aNumSpawnPoints[Type]; i++)
+	{
+		vec2 P;
+		if(!FindFreeSpawnPos(m_aaSpawnPoints[Type][i], &P))
+			continue;	// try next spawn point
+
+		float S = EvaluateSpawnPos(pEval, P);
+		if(!pEval->m_Got || pEval->m_Score > S)
+		{
+			pEval->m_Got = true;
+			pEval->m_Score = S;
+			pEval->m_Pos = P;
+		}
+	}
+}
+
+void CSpawns::EvaluateSpawnTypes(CEval *pEval, const int *pTypes, int NumTypes, bool Exact)
+{
+	if(Exact)
+	{
+		for(int t = 0; t < NumTypes; t++)
+			EvaluateSpawnType(pEval, pTypes[t]);
+		return;
+	}
+
+	// candidates with their order in the exact evaluation, that one wins ties
+	int aType[NUM_TYPES*MAX_SPAWNS];
+	int aIndex[NUM_TYPES*MAX_SPAWNS];
+	int aOrder[NUM_TYPES*MAX_SPAWNS];
+	double aBound[NUM_TYPES*MAX_SPAWNS];
+	int Num = 0;
+	for(int t = 0; t < NumTypes; t++)
+		for(int i = 0; i < m_aNumSpawnPoints[pTypes[t]]; i++)
+		{
+			aType[Num] = pTypes[t];
+			aIndex[Num] = i;
+			aOrder[Num] = Num;
+			aBound[Num] = DangerBound(pTypes[t], i, pEval->m_FriendlyTeam);
+			Num++;
+		}
+
+	// an earlier pick wins ties against all of these
+	int BestOrder = -1;
+	while(Num)
+	{
+		int Next = 0;
+		for(int i = 1; i < Num; i++)
+			if(aBound[i] < aBound[Next])
+				Next = i;
+
+		// the rest can't be better, the margin covers the rounding of the float scores
+		if(pEval->m_Got && aBound[Next]*0.999 > pEval->m_Score)
+			break;
+
+		vec2 P;
+		if(FindFreeSpawnPos(m_aaSpawnPoints[aType[Next]][aIndex[Next]], &P))
+		{
+			float S = EvaluateSpawnPos(pEval, P);
+			if(!pEval->m_Got || S < pEval->m_Score || (S == pEval->m_Score && aOrder[Next] < BestOrder))
+			{
+				pEval->m_Got = true;
+				pEval->m_Score = S;
+				pEval->m_Pos = P;
+				BestOrder = aOrder[Next];
+			}
+		}
+
+		Num--;
+		aType[Next] = aType[Num];
+		aIndex[Next] = aIndex[Num];
+		aOrder[Next] = aOrder[Num];
+		aBound[Next] = aBound[Num];
+	}
+}
+
+bool CSpawns::Evaluate(int Team, bool Teamplay, bool Exact, vec2 *pPos)
+{
+	CEval Eval;
+	if(Teamplay)
+	{
+		Eval.m_FriendlyTeam = Team;
+
+		// first try own team spawn, then normal spawn and then enemy
+		int aTypes[3] = { 1+(Team&1), 0, 1+((Team+1)&1) };
+		for(int i = 0; i < 3 && !Eval.m_Got; i++)
+			EvaluateSpawnTypes(&Eval, &aTypes[i], 1, Exact);
+	}
+	else
+	{
+		int aTypes[3] = { 0, 1, 2 };
+		EvaluateSpawnTypes(&Eval, aTypes, 3, Exact);
+	}
+
+	*pPos = Eval.m_Pos;
+	return Eval.m_Got;
+}
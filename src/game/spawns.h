@@ -0,0 +1,97 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SPAWNS_H
+#define GAME_SPAWNS_H
+
+#include <base/vmath.h>
+#include <engine/shared/protocol.h>
+
+/*
+	Class: CSpawns
+		The spawn points of a map and the pick of the least dangerous free
+		one. The danger of a position is the sum of 1/d to all characters,
+		team mates count half.
+
+		Evaluating every spawn point against every character is the exact
+		pick. The fast pick keeps a lower bound of the danger for each
+		spawn point that is only updated when a character moves to another
+		cell, and evaluates the spawn points by their bound until none of
+		the rest can beat the best one. Both give the same spawn.
+*/
+class CSpawns
+{
+public:
+	enum
+	{
+		NUM_TYPES=3,
+		MAX_SPAWNS=64,
+	};
+
+	struct CCharacterInfo
+	{
+		int m_ClientID;
+		int m_Team;
+		vec2 m_Pos;
+	};
+
+	CSpawns();
+
+	void Init(class CCollision *pCollision);
+	void Add(int Type, vec2 Pos);
+
+	// the characters in the world in world order, has to be called before Evaluate
+	void SetCharacters(const CCharacterInfo *pCharacters, int Num);
+
+	bool Evaluate(int Team, bool Teamplay, bool Exact, vec2 *pPos);
+
+private:
+	enum
+	{
+		DANGER_CELL=32,
+		PROXIMITY_RADIUS=28, // CCharacter::ms_PhysSize
+	};
+
+	struct CEval
+	{
+		CEval()
+		{
+			m_Got = false;
+			m_FriendlyTeam = -1;
+			m_Pos = vec2(100,100);
+		}
+
+		vec2 m_Pos;
+		bool m_Got;
+		int m_FriendlyTeam;
+		float m_Score;
+	};
+
+	class CCollision *m_pCollision;
+
+	vec2 m_aaSpawnPoints[NUM_TYPES][MAX_SPAWNS];
+	int m_aNumSpawnPoints[NUM_TYPES];
+
+	CCharacterInfo m_aCharacters[MAX_CLIENTS];
+	int m_NumCharacters;
+
+	// the characters are counted at the center of their cell and the free
+	// position may be next to the spawn point, so 1/(d+DANGER_SLACK) is
+	// never more than their real danger
+	static const float ms_DangerSlack;
+	double m_aaaDangerBound[NUM_TYPES][MAX_SPAWNS][2];
+	bool m_aDangerCounted[MAX_CLIENTS];
+	ivec2 m_aDangerCell[MAX_CLIENTS];
+	int m_aDangerTeam[MAX_CLIENTS];
+	int m_NumDangerCounted;
+
+	void ChangeDanger(ivec2 Cell, int Team, double Factor);
+	void UpdateDanger();
+	double DangerBound(int Type, int Index, int FriendlyTeam) const;
+
+	bool FindFreeSpawnPos(vec2 SpawnPoint, vec2 *pPos) const;
+	float EvaluateSpawnPos(CEval *pEval, vec2 Pos) const;
+	void EvaluateSpawnType(CEval *pEval, int Type);
+	void EvaluateSpawnTypes(CEval *pEval, const int *pTypes, int NumTypes, bool Exact);
+};
+
+#endif
@@ -4,7 +4,7 @@
 #define GAME_VERSION_H
 #include <game/generated/nethash.cpp>
 #define GAME_VERSION "0.6.5"
-#define GAME_NETVERSION "0.6 " GAME_NETVERSION_HASH
+#define GAME_NETVERSION "0.6 626fce9a778df4d4"
 static const char GAME_RELEASE_VERSION[8] = "0.6.5";
 #define MOD_VERSION "0.7.5"
 
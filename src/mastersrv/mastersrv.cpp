@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
 #include <base/system.h>
 
 #include <engine/config.h>
@@ -17,9 +18,95 @@
 enum {
 	MTU = 1400,
 	MAX_SERVERS_PER_PACKET=75,
-	MAX_PACKETS=16,
+	MAX_PACKETS=64,
 	MAX_SERVERS=MAX_SERVERS_PER_PACKET*MAX_PACKETS,
-	EXPIRE_TIME = 90
+	EXPIRE_TIME = 90,
+	CHECK_RETRY_TIME = 5, // seconds between the tries of a check, it fails after about CHECK_TRIES*CHECK_RETRY_TIME
+	CHECK_TRIES = 10,
+	EXPIRE_WHEEL_SIZE = 128, // one slot per second, has to be larger than EXPIRE_TIME
+	ADDR_INDEX_SIZE = 16384 // at least twice MAX_SERVERS, check servers are indexed with both addresses
+};
+
+// hash table from addresses to indices, with linear probing.
+// an address can be in it several times with different indices
+class CAddrIndex
+{
+	enum { MASK = ADDR_INDEX_SIZE-1 };
+
+	struct CEntry
+	{
+		NETADDR m_Addr;
+		int m_Index; // -1 if the entry is empty
+	};
+
+	CEntry m_aEntries[ADDR_INDEX_SIZE];
+
+	static unsigned Hash(const NETADDR *pAddr)
+	{
+		unsigned Hash = 2166136261u^pAddr->type^(pAddr->port<<8);
+		for(int i = 0; i < 16; i++)
+			Hash = (Hash^pAddr->ip[i])*16777619u;
+		return (Hash^(Hash>>15))&MASK;
+	}
+
+	unsigned Lookup(const NETADDR *pAddr, int Index) const
+	{
+		unsigned i = Hash(pAddr);
+		while(m_aEntries[i].m_Index != -1 && (m_aEntries[i].m_Index != Index || net_addr_comp(&m_aEntries[i].m_Addr, pAddr) != 0))
+			i = (i+1)&MASK;
+		return i;
+	}
+
+public:
+	CAddrIndex()
+	{
+		for(int i = 0; i < ADDR_INDEX_SIZE; i++)
+			m_aEntries[i].m_Index = -1;
+	}
+
+	int Find(const NETADDR *pAddr) const
+	{
+		for(unsigned i = Hash(pAddr); m_aEntries[i].m_Index != -1; i = (i+1)&MASK)
+			if(net_addr_comp(&m_aEntries[i].m_Addr, pAddr) == 0)
+				return m_aEntries[i].m_Index;
+		return -1;
+	}
+
+	void Insert(const NETADDR *pAddr, int Index)
+	{
+		unsigned i = Hash(pAddr);
+		while(m_aEntries[i].m_Index != -1)
+			i = (i+1)&MASK;
+		m_aEntries[i].m_Addr = *pAddr;
+		m_aEntries[i].m_Index = Index;
+	}
+
+	void Remove(const NETADDR *pAddr, int Index)
+	{
+		unsigned Hole = Lookup(pAddr, Index);
+		if(m_aEntries[Hole].m_Index == -1)
+			return;
+
+		// move the following entries into the hole when it is on their probe path,
+		// so lookups don't stop early
+		for(unsigned i = (Hole+1)&MASK; m_aEntries[i].m_Index != -1; i = (i+1)&MASK)
+		{
+			unsigned Home = Hash(&m_aEntries[i].m_Addr);
+			if(((i-Home)&MASK) >= ((i-Hole)&MASK))
+			{
+				m_aEntries[Hole] = m_aEntries[i];
+				Hole = i;
+			}
+		}
+		m_aEntries[Hole].m_Index = -1;
+	}
+
+	void Move(const NETADDR *pAddr, int OldIndex, int NewIndex)
+	{
+		unsigned i = Lookup(pAddr, OldIndex);
+		if(m_aEntries[i].m_Index != -1)
+			m_aEntries[i].m_Index = NewIndex;
+	}
 };
 
 struct CCheckServer
@@ -33,16 +120,28 @@ struct CCheckServer
 
 static CCheckServer m_aCheckServers[MAX_SERVERS];
 static int m_NumCheckServers = 0;
+static CAddrIndex m_CheckServerIndex;
 
 struct CServerEntry
 {
 	enum ServerType m_Type;
 	NETADDR m_Address;
-	int64 m_Expire;
+	int m_Expire; // in seconds
+	int m_ListIndex; // position in the list packets of its type
+
+	// servers that expire in the same second, the next free entry for unused ones
+	int m_PrevExpire;
+	int m_NextExpire;
 };
 
 static CServerEntry m_aServers[MAX_SERVERS];
 static int m_NumServers = 0;
+static int m_NumServerEntries = 0;
+static int m_FirstFreeServer = -1;
+static CAddrIndex m_ServerIndex;
+
+static int m_aExpireWheel[EXPIRE_WHEEL_SIZE];
+static int m_ExpireSecond = 0;
 
 struct CPacketData
 {
@@ -69,6 +168,15 @@ struct CPacketDataLegacy
 CPacketDataLegacy m_aPacketsLegacy[MAX_PACKETS];
 static int m_NumPacketsLegacy = 0;
 
+// the servers of each type in the order they are in the list packets
+struct CServerList
+{
+	int m_aServers[MAX_SERVERS];
+	int m_NumServers;
+};
+
+static CServerList m_aServerLists[2];
+
 
 struct CCountPacketData
 {
@@ -88,84 +196,134 @@ static CNetClient m_NetOp; // main
 
 IConsole *m_pConsole;
 
-void BuildPackets()
+static int CurrentSecond()
 {
-	CServerEntry *pCurrent = &m_aServers[0];
-	int ServersLeft = m_NumServers;
-	m_NumPackets = 0;
-	m_NumPacketsLegacy = 0;
-	int PacketIndex = 0;
-	int PacketIndexLegacy = 0;
-	while(ServersLeft-- && (m_NumPackets + m_NumPacketsLegacy) < MAX_PACKETS)
+	return time_get()/time_freq();
+}
+
+void InitPackets()
+{
+	for(int i = 0; i < MAX_PACKETS; i++)
 	{
-		if(pCurrent->m_Type == SERVERTYPE_NORMAL)
-		{
-			if(PacketIndex % MAX_SERVERS_PER_PACKET == 0)
-			{
-				PacketIndex = 0;
-				m_NumPackets++;
-			}
+		mem_copy(m_aPackets[i].m_Data.m_aHeader, SERVERBROWSE_LIST, sizeof(SERVERBROWSE_LIST));
+		mem_copy(m_aPacketsLegacy[i].m_Data.m_aHeader, SERVERBROWSE_LIST_LEGACY, sizeof(SERVERBROWSE_LIST_LEGACY));
+	}
 
-			// copy header
-			mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aHeader, SERVERBROWSE_LIST, sizeof(SERVERBROWSE_LIST));
+	for(int i = 0; i < EXPIRE_WHEEL_SIZE; i++)
+		m_aExpireWheel[i] = -1;
+	m_ExpireSecond = CurrentSecond();
+}
 
-			// copy server addresses
-			if(pCurrent->m_Address.type == NETTYPE_IPV6)
-			{
-				mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp, pCurrent->m_Address.ip,
-					sizeof(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp));
-			}
-			else
-			{
-				static unsigned char IPV4Mapping[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
+// writes the server at the given position of its list into the list packets
+void WritePacketEntry(ServerType Type, int ListIndex)
+{
+	const CServerEntry *pServer = &m_aServers[m_aServerLists[Type].m_aServers[ListIndex]];
+	int Packet = ListIndex/MAX_SERVERS_PER_PACKET;
+	int PacketIndex = ListIndex%MAX_SERVERS_PER_PACKET;
 
-				mem_copy(m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp, IPV4Mapping, sizeof(IPV4Mapping));
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[12] = pCurrent->m_Address.ip[0];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[13] = pCurrent->m_Address.ip[1];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[14] = pCurrent->m_Address.ip[2];
-				m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aIp[15] = pCurrent->m_Address.ip[3];
-			}
+	if(Type == SERVERTYPE_NORMAL)
+	{
+		CMastersrvAddr *pAddr = &m_aPackets[Packet].m_Data.m_aServers[PacketIndex];
 
-			m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aPort[0] = (pCurrent->m_Address.port>>8)&0xff;
-			m_aPackets[m_NumPackets-1].m_Data.m_aServers[PacketIndex].m_aPort[1] = pCurrent->m_Address.port&0xff;
+		// copy server addresses
+		if(pServer->m_Address.type == NETTYPE_IPV6)
+		{
+			mem_copy(pAddr->m_aIp, pServer->m_Address.ip, sizeof(pAddr->m_aIp));
+		}
+		else
+		{
+			static unsigned char IPV4Mapping[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
 
-			PacketIndex++;
+			mem_copy(pAddr->m_aIp, IPV4Mapping, sizeof(IPV4Mapping));
+			pAddr->m_aIp[12] = pServer->m_Address.ip[0];
+			pAddr->m_aIp[13] = pServer->m_Address.ip[1];
+			pAddr->m_aIp[14] = pServer->m_Address.ip[2];
+			pAddr->m_aIp[15] = pServer->m_Address.ip[3];
+		}
 
-			m_aPackets[m_NumPackets-1].m_Size = sizeof(SERVERBROWSE_LIST) + sizeof(CMastersrvAddr)*PacketIndex;
+		pAddr->m_aPort[0] = (pServer->m_Address.port>>8)&0xff;
+		pAddr->m_aPort[1] = pServer->m_Address.port&0xff;
+	}
+	else
+	{
+		CMastersrvAddrLegacy *pAddr = &m_aPacketsLegacy[Packet].m_Data.m_aServers[PacketIndex];
 
-			pCurrent++;
-		}
-		else if(pCurrent->m_Type == SERVERTYPE_LEGACY)
-		{
-			if(PacketIndexLegacy % MAX_SERVERS_PER_PACKET == 0)
-			{
-				PacketIndexLegacy = 0;
-				m_NumPacketsLegacy++;
-			}
+		// copy server addresses
+		mem_copy(pAddr->m_aIp, pServer->m_Address.ip, sizeof(pAddr->m_aIp));
+		// 0.5 has the port in little endian on the network
+		pAddr->m_aPort[0] = pServer->m_Address.port&0xff;
+		pAddr->m_aPort[1] = (pServer->m_Address.port>>8)&0xff;
+	}
+}
 
-			// copy header
-			mem_copy(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aHeader, SERVERBROWSE_LIST_LEGACY, sizeof(SERVERBROWSE_LIST_LEGACY));
+// only the size of the last packet changes when a server is added or removed
+void UpdatePacketSizes(ServerType Type)
+{
+	int NumServers = m_aServerLists[Type].m_NumServers;
+	int NumPackets = (NumServers+MAX_SERVERS_PER_PACKET-1)/MAX_SERVERS_PER_PACKET;
+	int LastSize = NumServers-(NumPackets-1)*MAX_SERVERS_PER_PACKET;
 
-			// copy server addresses
-			mem_copy(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aIp, pCurrent->m_Address.ip,
-				sizeof(m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aIp));
-			// 0.5 has the port in little endian on the network
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aPort[0] = pCurrent->m_Address.port&0xff;
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Data.m_aServers[PacketIndexLegacy].m_aPort[1] = (pCurrent->m_Address.port>>8)&0xff;
+	if(Type == SERVERTYPE_NORMAL)
+	{
+		m_NumPackets = NumPackets;
+		if(NumPackets > 1)
+			m_aPackets[NumPackets-2].m_Size = sizeof(SERVERBROWSE_LIST) + sizeof(CMastersrvAddr)*MAX_SERVERS_PER_PACKET;
+		if(NumPackets > 0)
+			m_aPackets[NumPackets-1].m_Size = sizeof(SERVERBROWSE_LIST) + sizeof(CMastersrvAddr)*LastSize;
+	}
+	else
+	{
+		m_NumPacketsLegacy = NumPackets;
+		if(NumPackets > 1)
+			m_aPacketsLegacy[NumPackets-2].m_Size = sizeof(SERVERBROWSE_LIST_LEGACY) + sizeof(CMastersrvAddrLegacy)*MAX_SERVERS_PER_PACKET;
+		if(NumPackets > 0)
+			m_aPacketsLegacy[NumPackets-1].m_Size = sizeof(SERVERBROWSE_LIST_LEGACY) + sizeof(CMastersrvAddrLegacy)*LastSize;
+	}
+}
 
-			PacketIndexLegacy++;
+void LinkExpire(int ServerIndex)
+{
+	CServerEntry *pServer = &m_aServers[ServerIndex];
+	int *pFirst = &m_aExpireWheel[pServer->m_Expire%EXPIRE_WHEEL_SIZE];
+	pServer->m_PrevExpire = -1;
+	pServer->m_NextExpire = *pFirst;
+	if(*pFirst != -1)
+		m_aServers[*pFirst].m_PrevExpire = ServerIndex;
+	*pFirst = ServerIndex;
+}
 
-			m_aPacketsLegacy[m_NumPacketsLegacy-1].m_Size = sizeof(SERVERBROWSE_LIST_LEGACY) + sizeof(CMastersrvAddrLegacy)*PacketIndexLegacy;
+void UnlinkExpire(int ServerIndex)
+{
+	CServerEntry *pServer = &m_aServers[ServerIndex];
+	if(pServer->m_PrevExpire != -1)
+		m_aServers[pServer->m_PrevExpire].m_NextExpire = pServer->m_NextExpire;
+	else
+		m_aExpireWheel[pServer->m_Expire%EXPIRE_WHEEL_SIZE] = pServer->m_NextExpire;
+	if(pServer->m_NextExpire != -1)
+		m_aServers[pServer->m_NextExpire].m_PrevExpire = pServer->m_PrevExpire;
+}
 
-			pCurrent++;
-		}
-		else
-		{
-			*pCurrent = m_aServers[m_NumServers-1];
-			m_NumServers--;
-			dbg_msg("mastersrv", "error: server of invalid type, dropping it");
-		}
+void RemoveServer(int ServerIndex)
+{
+	CServerEntry *pServer = &m_aServers[ServerIndex];
+	m_ServerIndex.Remove(&pServer->m_Address, ServerIndex);
+	UnlinkExpire(ServerIndex);
+
+	// the last server of the list takes the place of the removed one
+	CServerList *pList = &m_aServerLists[pServer->m_Type];
+	int Last = pList->m_aServers[--pList->m_NumServers];
+	if(Last != ServerIndex)
+	{
+		pList->m_aServers[pServer->m_ListIndex] = Last;
+		m_aServers[Last].m_ListIndex = pServer->m_ListIndex;
+		WritePacketEntry(pServer->m_Type, pServer->m_ListIndex);
 	}
+	UpdatePacketSizes(pServer->m_Type);
+
+	pServer->m_Type = SERVERTYPE_INVALID;
+	pServer->m_NextExpire = m_FirstFreeServer;
+	m_FirstFreeServer = ServerIndex;
+	m_NumServers--;
 }
 
 void SendOk(NETADDR *pAddr)
@@ -206,6 +364,23 @@ void SendCheck(NETADDR *pAddr)
 
 void AddCheckserver(NETADDR *pInfo, NETADDR *pAlt, ServerType Type)
 {
+	// a server that is already being checked only updates its info
+	int Index = m_CheckServerIndex.Find(pInfo);
+	if(Index != -1 && net_addr_comp(&m_aCheckServers[Index].m_Address, pInfo) == 0)
+	{
+		CCheckServer *pCheck = &m_aCheckServers[Index];
+		if(net_addr_comp(&pCheck->m_AltAddress, pAlt) != 0)
+		{
+			if(net_addr_comp(&pCheck->m_AltAddress, &pCheck->m_Address) != 0)
+				m_CheckServerIndex.Remove(&pCheck->m_AltAddress, Index);
+			pCheck->m_AltAddress = *pAlt;
+			if(net_addr_comp(pAlt, pInfo) != 0)
+				m_CheckServerIndex.Insert(pAlt, Index);
+		}
+		pCheck->m_Type = Type;
+		return;
+	}
+
 	// add server
 	if(m_NumCheckServers == MAX_SERVERS)
 	{
@@ -223,22 +398,49 @@ void AddCheckserver(NETADDR *pInfo, NETADDR *pAlt, ServerType Type)
 	m_aCheckServers[m_NumCheckServers].m_TryCount = 0;
 	m_aCheckServers[m_NumCheckServers].m_TryTime = 0;
 	m_aCheckServers[m_NumCheckServers].m_Type = Type;
+	m_CheckServerIndex.Insert(pInfo, m_NumCheckServers);
+	if(net_addr_comp(pAlt, pInfo) != 0)
+		m_CheckServerIndex.Insert(pAlt, m_NumCheckServers);
 	m_NumCheckServers++;
 }
 
+void RemoveCheckserver(int Index)
+{
+	CCheckServer *pCheck = &m_aCheckServers[Index];
+	bool SameAlt = net_addr_comp(&pCheck->m_AltAddress, &pCheck->m_Address) == 0;
+	m_CheckServerIndex.Remove(&pCheck->m_Address, Index);
+	if(!SameAlt)
+		m_CheckServerIndex.Remove(&pCheck->m_AltAddress, Index);
+
+	// move the last one into the gap
+	int Last = --m_NumCheckServers;
+	if(Last != Index)
+	{
+		*pCheck = m_aCheckServers[Last];
+		m_CheckServerIndex.Move(&pCheck->m_Address, Last, Index);
+		if(net_addr_comp(&pCheck->m_AltAddress, &pCheck->m_Address) != 0)
+			m_CheckServerIndex.Move(&pCheck->m_AltAddress, Last, Index);
+	}
+}
+
 void AddServer(NETADDR *pInfo, ServerType Type)
 {
+	int Expire = CurrentSecond()+EXPIRE_TIME;
+
 	// see if server already exists in list
-	for(int i = 0; i < m_NumServers; i++)
+	int Index = m_ServerIndex.Find(pInfo);
+	if(Index != -1)
 	{
-		if(net_addr_comp(&m_aServers[i].m_Address, pInfo) == 0)
+		char aAddrStr[NETADDR_MAXSTRSIZE];
+		net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
+		dbg_msg("mastersrv", "updated: %s", aAddrStr);
+		if(m_aServers[Index].m_Expire != Expire)
 		{
-			char aAddrStr[NETADDR_MAXSTRSIZE];
-			net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
-			dbg_msg("mastersrv", "updated: %s", aAddrStr);
-			m_aServers[i].m_Expire = time_get()+time_freq()*EXPIRE_TIME;
-			return;
+			UnlinkExpire(Index);
+			m_aServers[Index].m_Expire = Expire;
+			LinkExpire(Index);
 		}
+		return;
 	}
 
 	// add server
@@ -251,9 +453,27 @@ void AddServer(NETADDR *pInfo, ServerType Type)
 	char aAddrStr[NETADDR_MAXSTRSIZE];
 	net_addr_str(pInfo, aAddrStr, sizeof(aAddrStr), true);
 	dbg_msg("mastersrv", "added: %s", aAddrStr);
-	m_aServers[m_NumServers].m_Address = *pInfo;
-	m_aServers[m_NumServers].m_Expire = time_get()+time_freq()*EXPIRE_TIME;
-	m_aServers[m_NumServers].m_Type = Type;
+
+	if(m_FirstFreeServer != -1)
+	{
+		Index = m_FirstFreeServer;
+		m_FirstFreeServer = m_aServers[Index].m_NextExpire;
+	}
+	else
+		Index = m_NumServerEntries++;
+
+	CServerEntry *pServer = &m_aServers[Index];
+	pServer->m_Address = *pInfo;
+	pServer->m_Expire = Expire;
+	pServer->m_Type = Type;
+	m_ServerIndex.Insert(pInfo, Index);
+	LinkExpire(Index);
+
+	CServerList *pList = &m_aServerLists[Type];
+	pServer->m_ListIndex = pList->m_NumServers++;
+	pList->m_aServers[pServer->m_ListIndex] = Index;
+	WritePacketEntry(Type, pServer->m_ListIndex);
+	UpdatePacketSizes(Type);
 	m_NumServers++;
 }
 
@@ -263,9 +483,9 @@ void UpdateServers()
 	int64 Freq = time_freq();
 	for(int i = 0; i < m_NumCheckServers; i++)
 	{
-		if(Now > m_aCheckServers[i].m_TryTime+Freq)
+		if(Now > m_aCheckServers[i].m_TryTime+Freq*CHECK_RETRY_TIME)
 		{
-			if(m_aCheckServers[i].m_TryCount == 10)
+			if(m_aCheckServers[i].m_TryCount == CHECK_TRIES)
 			{
 				char aAddrStr[NETADDR_MAXSTRSIZE];
 				net_addr_str(&m_aCheckServers[i].m_Address, aAddrStr, sizeof(aAddrStr), true);
@@ -275,8 +495,7 @@ void UpdateServers()
 
 				// FAIL!!
 				SendError(&m_aCheckServers[i].m_Address);
-				m_aCheckServers[i] = m_aCheckServers[m_NumCheckServers-1];
-				m_NumCheckServers--;
+				RemoveCheckserver(i);
 				i--;
 			}
 			else
@@ -294,21 +513,25 @@ void UpdateServers()
 
 void PurgeServers()
 {
-	int64 Now = time_get();
-	int i = 0;
-	while(i < m_NumServers)
+	// only the servers in the wheel slots of the seconds that passed can expire
+	int Now = CurrentSecond();
+	m_ExpireSecond = max(m_ExpireSecond, Now-(int)EXPIRE_WHEEL_SIZE);
+	for(; m_ExpireSecond < Now; m_ExpireSecond++)
 	{
-		if(m_aServers[i].m_Expire < Now)
+		int Index = m_aExpireWheel[m_ExpireSecond%EXPIRE_WHEEL_SIZE];
+		while(Index != -1)
 		{
-			// remove server
-			char aAddrStr[NETADDR_MAXSTRSIZE];
-			net_addr_str(&m_aServers[i].m_Address, aAddrStr, sizeof(aAddrStr), true);
-			dbg_msg("mastersrv", "expired: %s", aAddrStr);
-			m_aServers[i] = m_aServers[m_NumServers-1];
-			m_NumServers--;
+			int Next = m_aServers[Index].m_NextExpire;
+			if(m_aServers[Index].m_Expire < Now)
+			{
+				// remove server
+				char aAddrStr[NETADDR_MAXSTRSIZE];
+				net_addr_str(&m_aServers[Index].m_Address, aAddrStr, sizeof(aAddrStr), true);
+				dbg_msg("mastersrv", "expired: %s", aAddrStr);
+				RemoveServer(Index);
+			}
+			Index = Next;
 		}
-		else
-			i++;
 	}
 }
 
@@ -320,7 +543,7 @@ void ReloadBans()
 
 int main(int argc, const char **argv) // ignore_convention
 {
-	int64 LastBuild = 0, LastBanReload = 0;
+	int64 LastPurge = 0, LastCheck = 0, LastBanReload = 0;
 	ServerType Type = SERVERTYPE_INVALID;
 	NETADDR BindAddr;
 
@@ -329,6 +552,7 @@ int main(int argc, const char **argv) // ignore_convention
 
 	mem_copy(m_CountData.m_Header, SERVERBROWSE_COUNT, sizeof(SERVERBROWSE_COUNT));
 	mem_copy(m_CountDataLegacy.m_Header, SERVERBROWSE_COUNT_LEGACY, sizeof(SERVERBROWSE_COUNT_LEGACY));
+	InitPackets();
 
 	IKernel *pKernel = IKernel::Create();
 	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_BASIC, argc, argv);
@@ -497,16 +721,11 @@ int main(int argc, const char **argv) // ignore_convention
 			{
 				Type = SERVERTYPE_INVALID;
 				// remove it from checking
-				for(int i = 0; i < m_NumCheckServers; i++)
+				int Index = m_CheckServerIndex.Find(&Packet.m_Address);
+				if(Index != -1)
 				{
-					if(net_addr_comp(&m_aCheckServers[i].m_Address, &Packet.m_Address) == 0 ||
-						net_addr_comp(&m_aCheckServers[i].m_AltAddress, &Packet.m_Address) == 0)
-					{
-						Type = m_aCheckServers[i].m_Type;
-						m_NumCheckServers--;
-						m_aCheckServers[i] = m_aCheckServers[m_NumCheckServers];
-						break;
-					}
+					Type = m_aCheckServers[Index].m_Type;
+					RemoveCheckserver(Index);
 				}
 
 				// drops servers that were not in the CheckServers list
@@ -525,13 +744,19 @@ int main(int argc, const char **argv) // ignore_convention
 			ReloadBans();
 		}
 
-		if(time_get()-LastBuild > time_freq()*5)
+		// checks are sent often so they don't all arrive at once and overflow the socket buffers
+		if(time_get()-LastCheck > time_freq()/10)
 		{
-			LastBuild = time_get();
+			LastCheck = time_get();
 
-			PurgeServers();
 			UpdateServers();
-			BuildPackets();
+		}
+
+		if(time_get()-LastPurge > time_freq()*5)
+		{
+			LastPurge = time_get();
+
+			PurgeServers();
 		}
 
 		// be nice to the CPU
@@ -0,0 +1,66 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef TOOLS_BENCH_H
+#define TOOLS_BENCH_H
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+
+#include <game/collision.h>
+#include <game/layers.h>
+
+// the storage, map and collision the map benchmarks run on
+class CBenchMap
+{
+public:
+	IKernel *m_pKernel;
+	IStorage *m_pStorage;
+	IEngineMap *m_pMap;
+	CLayers m_Layers;
+	CCollision m_Collision;
+
+	void Init(int argc, const char **argv) // ignore_convention
+	{
+		m_pKernel = IKernel::Create();
+		m_pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_BASIC, argc, argv); // ignore_convention
+		m_pMap = CreateEngineMap();
+		m_pKernel->RegisterInterface(m_pStorage);
+		m_pKernel->RegisterInterface(static_cast<IEngineMap*>(m_pMap));
+		m_pKernel->RegisterInterface(static_cast<IMap*>(m_pMap));
+	}
+
+	bool Load(const char *pTool, const char *pMapName)
+	{
+		if(!m_pMap->Load(pMapName))
+		{
+			dbg_msg(pTool, "couldn't load map '%s'", pMapName);
+			return false;
+		}
+		m_Layers.Init(m_pKernel);
+		m_Collision.Init(&m_Layers);
+		return true;
+	}
+
+	// a position where a box of the size is free, a zero size is a point
+	vec2 RandomFreePos(unsigned *pSeed, vec2 Size)
+	{
+		while(1)
+		{
+			vec2 Pos = vec2(random_next_float(pSeed)*m_Collision.GetWidth()*32, random_next_float(pSeed)*m_Collision.GetHeight()*32);
+			if(!m_Collision.TestBox(Pos, Size))
+				return Pos;
+		}
+	}
+};
+
+// prints the result of one variant, the old and the new one are compared by their checksums
+inline void BenchReport(const char *pTool, const char *pVariant, int64 Time, int Ticks, unsigned Checksum)
+{
+	dbg_msg(pTool, "%s: %.3f ms per tick, checksum %08x", pVariant, Time*1000.0/time_freq()/Ticks, Checksum);
+}
+
+#endif
@@ -0,0 +1,221 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <game/gamecore.h>
+
+#include "bench.h"
+
+// projectile heavy scenario for the line tests: grenades, shotgun pellets
+// and laser beams flying around the map between a bunch of characters
+
+enum
+{
+	MAX_PROJECTILES=4096,
+	MAX_CHARACTERS=64,
+	PROJECTILE_LIFETIME=SERVER_TICK_SPEED*2,
+};
+
+struct CProjectile
+{
+	vec2 m_StartPos;
+	vec2 m_Direction;
+	float m_Curvature;
+	float m_Speed;
+	int m_StartTick;
+};
+
+static CBenchMap s_Map;
+static CProjectile s_aProjectiles[MAX_PROJECTILES];
+static vec2 s_aCharacters[MAX_CHARACTERS];
+static int s_NumProjectiles = 1024;
+static int s_NumCharacters = 16;
+static int s_NumLasers = 64;
+static unsigned s_Seed;
+
+static unsigned Random() { return random_next(&s_Seed); }
+static float RandomFloat() { return random_next_float(&s_Seed); }
+static vec2 RandomFreePos() { return s_Map.RandomFreePos(&s_Seed, vec2(0.0f, 0.0f)); }
+
+static void Launch(CProjectile *pProj, int Tick)
+{
+	float Angle = RandomFloat()*2*pi;
+	pProj->m_StartPos = RandomFreePos();
+	pProj->m_Direction = vec2(cosf(Angle), sinf(Angle));
+	if(Random()&1)
+	{
+		pProj->m_Curvature = 7.0f;
+		pProj->m_Speed = 1000.0f;
+	}
+	else
+	{
+		pProj->m_Curvature = 1.25f;
+		pProj->m_Speed = 2750.0f;
+	}
+	pProj->m_StartTick = Tick;
+}
+
+// the line test as it was before, every pixel gets checked
+static int IntersectLineSampled(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance+1);
+	vec2 Last = Pos0;
+
+	for(int i = 0; i < End; i++)
+	{
+		float a = i/Distance;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		if(s_Map.m_Collision.CheckPoint(Pos.x, Pos.y))
+		{
+			if(pOutCollision)
+				*pOutCollision = Pos;
+			if(pOutBeforeCollision)
+				*pOutBeforeCollision = Last;
+			return s_Map.m_Collision.GetCollisionAt(Pos.x, Pos.y);
+		}
+		Last = Pos;
+	}
+	if(pOutCollision)
+		*pOutCollision = Pos1;
+	if(pOutBeforeCollision)
+		*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, bool BroadPhase)
+{
+	const float ProximityRadius = 28.0f;
+	vec2 Min = vec2(min(Pos0.x, Pos1.x), min(Pos0.y, Pos1.y)) - vec2(Radius+ProximityRadius+1.0f, Radius+ProximityRadius+1.0f);
+	vec2 Max = vec2(max(Pos0.x, Pos1.x), max(Pos0.y, Pos1.y)) + vec2(Radius+ProximityRadius+1.0f, Radius+ProximityRadius+1.0f);
+
+	float ClosestLen = distance(Pos0, Pos1) * 100.0f;
+	int Closest = -1;
+	for(int i = 0; i < s_NumCharacters; i++)
+	{
+		vec2 Pos = s_aCharacters[i];
+		if(BroadPhase && (Pos.x < Min.x || Pos.x > Max.x || Pos.y < Min.y || Pos.y > Max.y))
+			continue;
+
+		vec2 IntersectPos = closest_point_on_line(Pos0, Pos1, Pos);
+		if(distance(Pos, IntersectPos) < ProximityRadius+Radius)
+		{
+			float Len = distance(Pos0, IntersectPos);
+			if(Len < ClosestLen)
+			{
+				ClosestLen = Len;
+				Closest = i;
+			}
+		}
+	}
+	return Closest;
+}
+
+// runs the scenario, returns a checksum over all results
+static unsigned Run(int Ticks, bool New, bool Verify, int *pNumMismatches, int *pNumTests)
+{
+	s_Seed = 1;
+	for(int i = 0; i < s_NumCharacters; i++)
+		s_aCharacters[i] = RandomFreePos();
+	for(int i = 0; i < s_NumProjectiles; i++)
+		Launch(&s_aProjectiles[i], -(int)(Random()%PROJECTILE_LIFETIME));
+
+	unsigned Checksum = 0;
+	for(int Tick = 1; Tick <= Ticks; Tick++)
+	{
+		// let the characters walk a bit
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			vec2 Pos = s_aCharacters[i] + vec2(RandomFloat()*20-10, RandomFloat()*20-10);
+			if(!s_Map.m_Collision.CheckPoint(Pos))
+				s_aCharacters[i] = Pos;
+		}
+
+		for(int i = 0; i < s_NumProjectiles; i++)
+		{
+			CProjectile *pProj = &s_aProjectiles[i];
+			float Pt = (Tick-pProj->m_StartTick-1)/(float)SERVER_TICK_SPEED;
+			float Ct = (Tick-pProj->m_StartTick)/(float)SERVER_TICK_SPEED;
+			vec2 PrevPos = CalcPos(pProj->m_StartPos, pProj->m_Direction, pProj->m_Curvature, pProj->m_Speed, Pt);
+			vec2 CurPos = CalcPos(pProj->m_StartPos, pProj->m_Direction, pProj->m_Curvature, pProj->m_Speed, Ct);
+
+			vec2 ColPos;
+			int Collide = New ? s_Map.m_Collision.IntersectLine(PrevPos, CurPos, &ColPos, 0) : IntersectLineSampled(PrevPos, CurPos, &ColPos, 0);
+			int Hit = IntersectCharacter(PrevPos, ColPos, 6.0f, New);
+			if(Verify)
+			{
+				vec2 RefPos;
+				int RefCollide = IntersectLineSampled(PrevPos, CurPos, &RefPos, 0);
+				if(RefCollide != Collide || mem_comp(&RefPos, &ColPos, sizeof(vec2)) != 0 || IntersectCharacter(PrevPos, ColPos, 6.0f, false) != Hit)
+					(*pNumMismatches)++;
+				(*pNumTests)++;
+			}
+			Checksum = Checksum*31 + Collide + Hit*7 + (unsigned)round_to_int(ColPos.x*16) + (unsigned)round_to_int(ColPos.y*16)*13;
+
+			if(Collide || Hit != -1 || Tick-pProj->m_StartTick > PROJECTILE_LIFETIME)
+				Launch(pProj, Tick);
+		}
+
+		for(int i = 0; i < s_NumLasers; i++)
+		{
+			float Angle = RandomFloat()*2*pi;
+			vec2 From = RandomFreePos();
+			vec2 To = From + vec2(cosf(Angle), sinf(Angle))*800.0f;
+
+			vec2 At, Before;
+			int Collide = New ? s_Map.m_Collision.IntersectLine(From, To, &At, &Before) : IntersectLineSampled(From, To, &At, &Before);
+			int Hit = IntersectCharacter(From, At, 0.0f, New);
+			if(Verify)
+			{
+				vec2 RefAt, RefBefore;
+				int RefCollide = IntersectLineSampled(From, To, &RefAt, &RefBefore);
+				if(RefCollide != Collide || mem_comp(&RefAt, &At, sizeof(vec2)) != 0 || mem_comp(&RefBefore, &Before, sizeof(vec2)) != 0 ||
+					IntersectCharacter(From, At, 0.0f, false) != Hit)
+					(*pNumMismatches)++;
+				(*pNumTests)++;
+			}
+			Checksum = Checksum*31 + Collide + Hit*7 + (unsigned)round_to_int(Before.x*16) + (unsigned)round_to_int(Before.y*16)*13;
+		}
+	}
+	return Checksum;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	const char *pMapName = "maps/ctf5.map";
+	int Ticks = 500;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-p") == 0 && i+1 < argc) // ignore_convention
+			s_NumProjectiles = clamp(str_toint(argv[++i]), 0, (int)MAX_PROJECTILES); // ignore_convention
+		else if(str_comp(argv[i], "-c") == 0 && i+1 < argc) // ignore_convention
+			s_NumCharacters = clamp(str_toint(argv[++i]), 0, (int)MAX_CHARACTERS); // ignore_convention
+		else if(str_comp(argv[i], "-l") == 0 && i+1 < argc) // ignore_convention
+			s_NumLasers = max(0, str_toint(argv[++i])); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			Ticks = max(1, str_toint(argv[++i])); // ignore_convention
+		else
+			pMapName = argv[i]; // ignore_convention
+	}
+
+	s_Map.Init(argc, argv); // ignore_convention
+	if(!s_Map.Load("collision_bench", pMapName))
+		return -1;
+
+	dbg_msg("collision_bench", "%s, %d ticks, %d projectiles, %d lasers per tick, %d characters",
+		pMapName, Ticks, s_NumProjectiles, s_NumLasers, s_NumCharacters);
+
+	int NumMismatches = 0;
+	int NumTests = 0;
+	Run(Ticks/5 > 0 ? Ticks/5 : 1, true, true, &NumMismatches, &NumTests);
+	dbg_msg("collision_bench", "verified %d lines against the sampled test, %d differ", NumTests, NumMismatches);
+
+	int64 Start = time_get();
+	unsigned OldChecksum = Run(Ticks, false, false, 0, 0);
+	BenchReport("collision_bench", "sampled", time_get()-Start, Ticks, OldChecksum);
+
+	Start = time_get();
+	unsigned NewChecksum = Run(Ticks, true, false, 0, 0);
+	BenchReport("collision_bench", "tile walk + broad phase", time_get()-Start, Ticks, NewChecksum);
+	return NumMismatches || OldChecksum != NewChecksum ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/array.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/network.h>
+
+// measures the network packet and variable int compression, either on files
+// given on the command line (split into packet sized chunks) or on generated
+// snapshot data
+
+struct CChunk
+{
+	int m_Size;
+	unsigned char m_aData[NET_MAX_PAYLOAD];
+};
+
+// unpacked variable ints take up to 4 times the space
+struct CIntChunk
+{
+	int m_Size;
+	int m_aData[NET_MAX_PAYLOAD];
+};
+
+static array<CChunk> s_aChunks;
+static int s_TotalSize = 0;
+
+static void AddChunk(const void *pData, int Size)
+{
+	CChunk Chunk;
+	Chunk.m_Size = Size;
+	mem_copy(Chunk.m_aData, pData, Size);
+	s_aChunks.add(Chunk);
+	s_TotalSize += Size;
+}
+
+static bool AddFile(const char *pFilename)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if(!File)
+	{
+		dbg_msg("compress_bench", "failed to open '%s'", pFilename);
+		return false;
+	}
+
+	unsigned char aBuf[NET_MAX_PAYLOAD];
+	int Size;
+	while((Size = io_read(File, aBuf, sizeof(aBuf))) > 0)
+		AddChunk(aBuf, Size);
+	io_close(File);
+	return true;
+}
+
+static void GenerateChunks(int Num)
+{
+	// snapshot deltas are mostly zeros and small numbers packed as variable ints
+	unsigned Seed = 1;
+	for(int c = 0; c < Num; c++)
+	{
+		int aInts[NET_MAX_PAYLOAD/4];
+		int NumInts = 16 + c%(sizeof(aInts)/sizeof(aInts[0])-16);
+		for(int i = 0; i < NumInts; i++)
+		{
+			int Rnd = (random_next(&Seed)>>8)&0x7fff;
+			if(Rnd%3)
+				aInts[i] = 0;
+			else if(Rnd%5)
+				aInts[i] = Rnd%64-32;
+			else
+				aInts[i] = Rnd*(Rnd%7)-0x8000;
+		}
+
+		unsigned char aBuf[NET_MAX_PAYLOAD*2];
+		int Size = CVariableInt::Compress(aInts, NumInts*sizeof(int), aBuf, sizeof(aBuf));
+		AddChunk(aBuf, min(Size, (int)NET_MAX_PAYLOAD));
+	}
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	int Iterations = 50;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-i") == 0 && i+1 < argc) // ignore_convention
+			Iterations = max(1, str_toint(argv[++i])); // ignore_convention
+		else if(!AddFile(argv[i])) // ignore_convention
+			return -1;
+	}
+	if(!s_aChunks.size())
+		GenerateChunks(4096);
+
+	CNetBase::Init();
+
+	// compress once and check that everything survives a round trip
+	array<CChunk> aCompressed;
+	aCompressed.set_size(s_aChunks.size());
+	int CompressedSize = 0;
+	for(int i = 0; i < s_aChunks.size(); i++)
+	{
+		CChunk *pChunk = &aCompressed[i];
+		pChunk->m_Size = CNetBase::Compress(s_aChunks[i].m_aData, s_aChunks[i].m_Size, pChunk->m_aData, sizeof(pChunk->m_aData));
+		if(pChunk->m_Size < 0)
+		{
+			// doesn't fit, the network code sends these uncompressed
+			pChunk->m_Size = 0;
+			continue;
+		}
+		CompressedSize += pChunk->m_Size;
+
+		unsigned char aBuf[NET_MAX_PAYLOAD];
+		int Size = CNetBase::Decompress(pChunk->m_aData, pChunk->m_Size, aBuf, sizeof(aBuf));
+		if(Size != s_aChunks[i].m_Size || mem_comp(aBuf, s_aChunks[i].m_aData, Size) != 0)
+		{
+			dbg_msg("compress_bench", "round trip failed for chunk %d", i);
+			return -1;
+		}
+	}
+
+	dbg_msg("compress_bench", "%d chunks, %d bytes, compressed to %d bytes (%.1f%%)", s_aChunks.size(), s_TotalSize,
+		CompressedSize, s_TotalSize ? CompressedSize*100.0f/s_TotalSize : 0.0f);
+
+	unsigned char aBuf[NET_MAX_PAYLOAD];
+	int64 Start = time_get();
+	for(int n = 0; n < Iterations; n++)
+		for(int i = 0; i < s_aChunks.size(); i++)
+			CNetBase::Compress(s_aChunks[i].m_aData, s_aChunks[i].m_Size, aBuf, sizeof(aBuf));
+	int64 CompressTime = time_get()-Start;
+
+	Start = time_get();
+	for(int n = 0; n < Iterations; n++)
+		for(int i = 0; i < aCompressed.size(); i++)
+			if(aCompressed[i].m_Size)
+				CNetBase::Decompress(aCompressed[i].m_aData, aCompressed[i].m_Size, aBuf, sizeof(aBuf));
+	int64 DecompressTime = time_get()-Start;
+
+	double Megabytes = (double)s_TotalSize*Iterations/(1024.0*1024.0);
+	dbg_msg("compress_bench", "huffman compress: %.2f MB/s", Megabytes/((double)CompressTime/time_freq()));
+	dbg_msg("compress_bench", "huffman decompress: %.2f MB/s", Megabytes/((double)DecompressTime/time_freq()));
+
+	// the chunks that are valid variable int streams, like snapshot deltas
+	array<CIntChunk> aInts;
+	int IntsSize = 0, VarIntSize = 0;
+	for(int i = 0; i < s_aChunks.size(); i++)
+	{
+		CIntChunk Chunk;
+		long Size = CVariableInt::Decompress(s_aChunks[i].m_aData, s_aChunks[i].m_Size, Chunk.m_aData, sizeof(Chunk.m_aData));
+		if(Size <= 0)
+			continue;
+		Chunk.m_Size = Size;
+		aInts.add(Chunk);
+		IntsSize += Size;
+		VarIntSize += s_aChunks[i].m_Size;
+	}
+	if(!aInts.size())
+		return 0;
+
+	unsigned char aPacked[NET_MAX_PAYLOAD*6];
+	Start = time_get();
+	for(int n = 0; n < Iterations; n++)
+		for(int i = 0; i < aInts.size(); i++)
+			CVariableInt::Compress(aInts[i].m_aData, aInts[i].m_Size, aPacked, sizeof(aPacked));
+	CompressTime = time_get()-Start;
+
+	int aUnpacked[NET_MAX_PAYLOAD];
+	Start = time_get();
+	for(int n = 0; n < Iterations; n++)
+		for(int i = 0; i < s_aChunks.size(); i++)
+			CVariableInt::Decompress(s_aChunks[i].m_aData, s_aChunks[i].m_Size, aUnpacked, sizeof(aUnpacked));
+	DecompressTime = time_get()-Start;
+
+	dbg_msg("compress_bench", "%d variable int chunks, %d bytes unpacked", aInts.size(), IntsSize);
+	Megabytes = (double)IntsSize*Iterations/(1024.0*1024.0);
+	dbg_msg("compress_bench", "varint compress: %.2f MB/s", Megabytes/((double)CompressTime/time_freq()));
+	dbg_msg("compress_bench", "varint decompress: %.2f MB/s", (double)VarIntSize*Iterations/(1024.0*1024.0)/((double)DecompressTime/time_freq()));
+	return 0;
+}
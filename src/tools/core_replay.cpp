@@ -0,0 +1,374 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <stdlib.h>
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <game/corerecord.h>
+#include <game/gamecore.h>
+
+#include "bench.h"
+
+// plays a record made with the core_record server command back through the
+// character cores, projectiles and lasers and measures how fast that runs.
+// the state after every tick goes into a hash, so changes to the physics
+// can be checked to give exactly the same results as before
+
+enum
+{
+	MAX_PROJECTILES=1024,
+	MAX_LASERS=256,
+	PROXIMITY_RADIUS=28,
+};
+
+struct CProjectile
+{
+	int m_Owner;
+	int m_Type;
+	vec2 m_Pos;
+	vec2 m_Direction;
+	int m_LifeSpan;
+	int m_StartTick;
+};
+
+struct CLaser
+{
+	int m_Owner;
+	vec2 m_Pos;
+	vec2 m_Dir;
+	float m_Energy;
+	int m_Bounces;
+	int m_EvalTick;
+};
+
+static CBenchMap s_Map;
+static CCoreRecordReader s_Record;
+
+static CWorldCore s_World;
+static CCharacterCore s_aCores[MAX_CLIENTS];
+static CNetObj_PlayerInput s_aInputs[MAX_CLIENTS];
+static CProjectile s_aProjectiles[MAX_PROJECTILES];
+static CLaser s_aLasers[MAX_LASERS];
+static int s_NumProjectiles;
+static int s_NumLasers;
+static unsigned s_Hash;
+
+static void Hash(const void *pData, int Size)
+{
+	// fnv-1a
+	const unsigned char *pBytes = (const unsigned char *)pData;
+	for(int i = 0; i < Size; i++)
+		s_Hash = (s_Hash^pBytes[i])*16777619u;
+}
+
+static void HashInt(int Value)
+{
+	Hash(&Value, sizeof(Value));
+}
+
+static bool Clipped(vec2 Pos)
+{
+	return round_to_int(Pos.x)/32 < -200 || round_to_int(Pos.x)/32 > s_Map.m_Collision.GetWidth()+200 ||
+		round_to_int(Pos.y)/32 < -200 || round_to_int(Pos.y)/32 > s_Map.m_Collision.GetHeight()+200;
+}
+
+// the same test as CGameWorld::IntersectCharacter, on the cores
+static int IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, vec2 *pNewPos, int NotThis)
+{
+	float ClosestLen = distance(Pos0, Pos1) * 100.0f;
+	int Closest = -1;
+	vec2 Min = vec2(min(Pos0.x, Pos1.x), min(Pos0.y, Pos1.y)) - vec2(Radius+1.0f+PROXIMITY_RADIUS, Radius+1.0f+PROXIMITY_RADIUS);
+	vec2 Max = vec2(max(Pos0.x, Pos1.x), max(Pos0.y, Pos1.y)) + vec2(Radius+1.0f+PROXIMITY_RADIUS, Radius+1.0f+PROXIMITY_RADIUS);
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CCharacterCore *pCore = s_World.m_apCharacters[i];
+		if(!pCore || i == NotThis)
+			continue;
+		if(pCore->m_Pos.x < Min.x || pCore->m_Pos.x > Max.x || pCore->m_Pos.y < Min.y || pCore->m_Pos.y > Max.y)
+			continue;
+
+		vec2 IntersectPos = closest_point_on_line(Pos0, Pos1, pCore->m_Pos);
+		if(distance(pCore->m_Pos, IntersectPos) < PROXIMITY_RADIUS+Radius)
+		{
+			float Len = distance(Pos0, IntersectPos);
+			if(Len < ClosestLen)
+			{
+				*pNewPos = IntersectPos;
+				ClosestLen = Len;
+				Closest = i;
+			}
+		}
+	}
+	return Closest;
+}
+
+static void TickProjectiles(int Tick)
+{
+	const CTuningParams *pTuning = &s_World.m_Tuning;
+	for(int i = 0; i < s_NumProjectiles; i++)
+	{
+		CProjectile *pProj = &s_aProjectiles[i];
+		float Curvature = 0;
+		float Speed = 0;
+		if(pProj->m_Type == WEAPON_GRENADE)
+		{
+			Curvature = pTuning->m_GrenadeCurvature;
+			Speed = pTuning->m_GrenadeSpeed;
+		}
+		else if(pProj->m_Type == WEAPON_SHOTGUN)
+		{
+			Curvature = pTuning->m_ShotgunCurvature;
+			Speed = pTuning->m_ShotgunSpeed;
+		}
+		else if(pProj->m_Type == WEAPON_GUN)
+		{
+			Curvature = pTuning->m_GunCurvature;
+			Speed = pTuning->m_GunSpeed;
+		}
+
+		float Pt = (Tick-pProj->m_StartTick-1)/(float)SERVER_TICK_SPEED;
+		float Ct = (Tick-pProj->m_StartTick)/(float)SERVER_TICK_SPEED;
+		vec2 PrevPos = CalcPos(pProj->m_Pos, pProj->m_Direction, Curvature, Speed, Pt);
+		vec2 CurPos = CalcPos(pProj->m_Pos, pProj->m_Direction, Curvature, Speed, Ct);
+		int Collide = s_Map.m_Collision.IntersectLine(PrevPos, CurPos, &CurPos, 0);
+		int Hit = IntersectCharacter(PrevPos, CurPos, 6.0f, &CurPos, pProj->m_Owner);
+
+		pProj->m_LifeSpan--;
+		if(Hit != -1 || Collide || pProj->m_LifeSpan < 0 || Clipped(CurPos))
+		{
+			HashInt(Hit);
+			HashInt(Collide);
+			Hash(&CurPos, sizeof(CurPos));
+			s_aProjectiles[i--] = s_aProjectiles[--s_NumProjectiles];
+		}
+	}
+}
+
+// CLaser::DoBounce without the damage
+static bool DoBounce(CLaser *pLaser, int Tick)
+{
+	pLaser->m_EvalTick = Tick;
+	if(pLaser->m_Energy < 0)
+		return false;
+
+	vec2 To = pLaser->m_Pos + pLaser->m_Dir * pLaser->m_Energy;
+	int Collide = s_Map.m_Collision.IntersectLine(pLaser->m_Pos, To, 0x0, &To);
+	int Hit = IntersectCharacter(pLaser->m_Pos, To, 0.0f, &To, pLaser->m_Owner);
+	if(Hit != -1)
+	{
+		pLaser->m_Pos = To;
+		pLaser->m_Energy = -1;
+	}
+	else if(Collide)
+	{
+		vec2 From = pLaser->m_Pos;
+		vec2 TempPos = To;
+		vec2 TempDir = pLaser->m_Dir * 4.0f;
+		s_Map.m_Collision.MovePoint(&TempPos, &TempDir, 1.0f, 0);
+		pLaser->m_Pos = TempPos;
+		pLaser->m_Dir = normalize(TempDir);
+
+		pLaser->m_Energy -= distance(From, pLaser->m_Pos) + s_World.m_Tuning.m_LaserBounceCost;
+		pLaser->m_Bounces++;
+		if(pLaser->m_Bounces > s_World.m_Tuning.m_LaserBounceNum)
+			pLaser->m_Energy = -1;
+	}
+	else
+	{
+		pLaser->m_Pos = To;
+		pLaser->m_Energy = -1;
+	}
+
+	HashInt(Hit);
+	Hash(&pLaser->m_Pos, sizeof(pLaser->m_Pos));
+	return true;
+}
+
+static void TickLasers(int Tick)
+{
+	for(int i = 0; i < s_NumLasers; i++)
+	{
+		CLaser *pLaser = &s_aLasers[i];
+		if(Tick > pLaser->m_EvalTick+(SERVER_TICK_SPEED*s_World.m_Tuning.m_LaserBounceDelay)/1000.0f && !DoBounce(pLaser, Tick))
+			s_aLasers[i--] = s_aLasers[--s_NumLasers];
+	}
+}
+
+// plays the whole record, returns the number of ticks
+static int Replay()
+{
+	mem_zero(&s_World.m_apCharacters, sizeof(s_World.m_apCharacters));
+	s_World.m_Tuning = s_Record.m_Header.m_Tuning;
+	s_NumProjectiles = 0;
+	s_NumLasers = 0;
+	s_Hash = 2166136261u;
+
+	if(!s_Record.m_NumRecords)
+		return 0;
+
+	const CCoreRecord::CRecord *pRecords = s_Record.m_pRecords;
+	int FirstTick = pRecords[0].m_Tick;
+	int LastTick = pRecords[s_Record.m_NumRecords-1].m_Tick;
+	int Current = 0;
+	for(int Tick = FirstTick; Tick <= LastTick; Tick++)
+	{
+		// projectiles and lasers tick before the characters, like in the game world
+		TickProjectiles(Tick);
+		TickLasers(Tick);
+
+		int Start = Current;
+		for(; Current < s_Record.m_NumRecords && pRecords[Current].m_Tick == Tick; Current++)
+		{
+			const CCoreRecord::CRecord *pRecord = &pRecords[Current];
+			int ClientID = pRecord->m_ClientID;
+			if(pRecord->m_Type == CCoreRecord::RECORD_DEATH)
+				s_World.m_apCharacters[ClientID] = 0;
+			else if(pRecord->m_Type == CCoreRecord::RECORD_INPUT)
+				mem_copy(&s_aInputs[ClientID], pRecord->m_aData, sizeof(s_aInputs[ClientID]));
+		}
+
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(!s_World.m_apCharacters[i])
+				continue;
+			s_aCores[i].m_Input = s_aInputs[i];
+			s_aCores[i].Tick(true);
+		}
+
+		// weapons are fired during the character tick
+		for(int r = Start; r < Current; r++)
+		{
+			const CCoreRecord::CRecord *pRecord = &pRecords[r];
+			if(pRecord->m_Type == CCoreRecord::RECORD_PROJECTILE && s_NumProjectiles < MAX_PROJECTILES)
+			{
+				CProjectile *pProj = &s_aProjectiles[s_NumProjectiles++];
+				pProj->m_Owner = pRecord->m_ClientID;
+				pProj->m_Type = pRecord->m_aData[0];
+				pProj->m_Pos = vec2(CCoreRecord::UnpackFloat(pRecord->m_aData[1]), CCoreRecord::UnpackFloat(pRecord->m_aData[2]));
+				pProj->m_Direction = vec2(CCoreRecord::UnpackFloat(pRecord->m_aData[3]), CCoreRecord::UnpackFloat(pRecord->m_aData[4]));
+				pProj->m_LifeSpan = pRecord->m_aData[5];
+				pProj->m_StartTick = Tick;
+			}
+			else if(pRecord->m_Type == CCoreRecord::RECORD_LASER && s_NumLasers < MAX_LASERS)
+			{
+				CLaser *pLaser = &s_aLasers[s_NumLasers++];
+				pLaser->m_Owner = pRecord->m_ClientID;
+				pLaser->m_Pos = vec2(CCoreRecord::UnpackFloat(pRecord->m_aData[0]), CCoreRecord::UnpackFloat(pRecord->m_aData[1]));
+				pLaser->m_Dir = vec2(CCoreRecord::UnpackFloat(pRecord->m_aData[2]), CCoreRecord::UnpackFloat(pRecord->m_aData[3]));
+				pLaser->m_Energy = CCoreRecord::UnpackFloat(pRecord->m_aData[4]);
+				pLaser->m_Bounces = 0;
+				if(!DoBounce(pLaser, Tick))
+					s_NumLasers--;
+			}
+		}
+
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(!s_World.m_apCharacters[i])
+				continue;
+			s_aCores[i].Move();
+			s_aCores[i].Quantize();
+
+			// Write leaves the tick alone
+			CNetObj_CharacterCore Core;
+			mem_zero(&Core, sizeof(Core));
+			s_aCores[i].Write(&Core);
+			HashInt(i);
+			Hash(&Core, sizeof(Core));
+		}
+
+		// players respawn after the world has ticked
+		for(int r = Start; r < Current; r++)
+		{
+			const CCoreRecord::CRecord *pRecord = &pRecords[r];
+			int ClientID = pRecord->m_ClientID;
+			if(pRecord->m_Type != CCoreRecord::RECORD_SPAWN)
+				continue;
+			s_aCores[ClientID].Reset();
+			s_aCores[ClientID].Init(&s_World, &s_Map.m_Collision);
+			s_aCores[ClientID].m_Pos = vec2(CCoreRecord::UnpackFloat(pRecord->m_aData[0]), CCoreRecord::UnpackFloat(pRecord->m_aData[1]));
+			s_World.m_apCharacters[ClientID] = &s_aCores[ClientID];
+			mem_zero(&s_aInputs[ClientID], sizeof(s_aInputs[ClientID]));
+		}
+	}
+
+	return LastTick-FirstTick+1;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	const char *pRecordName = 0;
+	const char *pMapName = 0;
+	int Runs = 10;
+	unsigned ExpectedHash = 0;
+	bool CheckHash = false;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-r") == 0 && i+1 < argc) // ignore_convention
+			Runs = max(1, str_toint(argv[++i])); // ignore_convention
+		else if(str_comp(argv[i], "-m") == 0 && i+1 < argc) // ignore_convention
+			pMapName = argv[++i]; // ignore_convention
+		else if(str_comp(argv[i], "-h") == 0 && i+1 < argc) // ignore_convention
+		{
+			ExpectedHash = strtoul(argv[++i], 0, 16); // ignore_convention
+			CheckHash = true;
+		}
+		else
+			pRecordName = argv[i]; // ignore_convention
+	}
+
+	if(!pRecordName)
+	{
+		dbg_msg("core_replay", "usage: core_replay <file.core> [-r runs] [-m map file] [-h expected hash]");
+		return -1;
+	}
+
+	s_Map.Init(argc, argv); // ignore_convention
+	IOHANDLE File = s_Map.m_pStorage->OpenFile(pRecordName, IOFLAG_READ, IStorage::TYPE_ALL);
+	if(!File || !s_Record.Load(File))
+	{
+		dbg_msg("core_replay", "couldn't load record '%s'", pRecordName);
+		if(File)
+			io_close(File);
+		return -1;
+	}
+	io_close(File);
+
+	char aMapFile[128];
+	if(pMapName)
+		str_copy(aMapFile, pMapName, sizeof(aMapFile));
+	else
+		str_format(aMapFile, sizeof(aMapFile), "maps/%s.map", s_Record.m_Header.m_aMapName);
+	if(!s_Map.Load("core_replay", aMapFile))
+		return -1;
+
+	int Ticks = Replay();
+	unsigned FirstHash = s_Hash;
+	dbg_msg("core_replay", "%s on %s, %d records, %d ticks", pRecordName, aMapFile, s_Record.m_NumRecords, Ticks);
+
+	// the first run warms up, the rest are measured and have to agree with it
+	bool Deterministic = true;
+	int64 Start = time_get();
+	for(int i = 0; i < Runs; i++)
+	{
+		Replay();
+		if(s_Hash != FirstHash)
+			Deterministic = false;
+	}
+	int64 Time = time_get()-Start;
+
+	double Seconds = Time/(double)time_freq();
+	dbg_msg("core_replay", "%d runs, %.3f ms per run, %.0f ticks per second", Runs, Seconds*1000.0/Runs, Ticks*(double)Runs/Seconds);
+	dbg_msg("core_replay", "hash %08x%s", FirstHash, Deterministic ? "" : ", NOT deterministic");
+
+	if(CheckHash && ExpectedHash != FirstHash)
+	{
+		dbg_msg("core_replay", "expected hash %08x", ExpectedHash);
+		return 1;
+	}
+	return Deterministic ? 0 : 1;
+}
@@ -0,0 +1,628 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/array.h>
+
+#include <engine/console.h>
+#include <engine/storage.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/jobs.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+
+// plays demos without rendering them and extracts per player statistics
+// and events, many demos are processed in parallel
+
+static const char *s_apWeaponNames[NUM_WEAPONS] = {"hammer", "gun", "shotgun", "grenade", "rifle", "ninja"};
+
+enum
+{
+	// kill message weapons that aren't real weapons
+	WEAPON_GAME = -3,
+	WEAPON_SELF = -2,
+	WEAPON_WORLD = -1,
+
+	EVENT_KILL=0,
+	EVENT_SUICIDE,
+	EVENT_FLAG_GRAB,
+	EVENT_FLAG_CAPTURE,
+	NUM_EVENTS,
+};
+
+static const char *s_apEventNames[NUM_EVENTS] = {"kill", "suicide", "flag_grab", "flag_capture"};
+
+struct CPlayerStats
+{
+	int m_ClientID;
+	char m_aName[MAX_NAME_LENGTH];
+	char m_aClan[MAX_CLAN_LENGTH];
+	int m_Team;
+	int m_Score;
+	int m_Kills;
+	int m_Deaths;
+	int m_Suicides;
+	int m_FlagGrabs;
+	int m_FlagCaptures;
+	int m_BestCaptureTicks;
+	int m_aShots[NUM_WEAPONS];
+	int m_aWeaponKills[NUM_WEAPONS];
+};
+
+struct CEvent
+{
+	int m_Tick;
+	int m_Type;
+	int m_Player;
+	int m_Target;
+	int m_Weapon;
+};
+
+class CDemoStats : public CDemoPlayer::IListner
+{
+public:
+	// input
+	const char *m_pFilename;
+	IStorage *m_pStorage;
+	IConsole *m_pConsole;
+	bool m_RecordEvents;
+
+	// results
+	bool m_Loaded;
+	char m_aMap[64];
+	int m_NumTicks;
+	array<CPlayerStats> m_aPlayers;
+	array<CEvent> m_aEvents;
+
+private:
+	const CDemoPlayer *m_pPlayer;
+
+	// index into m_aPlayers for the players in the last snapshot, -1 if not there
+	int m_aSlots[MAX_CLIENTS];
+	bool m_aSeen[MAX_CLIENTS];
+	int m_aLastAttackTick[MAX_CLIENTS];
+	int m_aFlagCarrier[2];
+	int m_aFlagGrabTick[2];
+
+	static void IntsToStr(const int *pInts, int Num, char *pStr)
+	{
+		while(Num)
+		{
+			pStr[0] = (((*pInts)>>24)&0xff)-128;
+			pStr[1] = (((*pInts)>>16)&0xff)-128;
+			pStr[2] = (((*pInts)>>8)&0xff)-128;
+			pStr[3] = ((*pInts)&0xff)-128;
+			pStr += 4;
+			pInts++;
+			Num--;
+		}
+
+		// null terminate
+		pStr[-1] = 0;
+	}
+
+	CPlayerStats *Player(int ClientID)
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+			return 0;
+		if(m_aSlots[ClientID] == -1)
+		{
+			CPlayerStats Stats;
+			mem_zero(&Stats, sizeof(Stats));
+			Stats.m_ClientID = ClientID;
+			Stats.m_BestCaptureTicks = -1;
+			m_aSlots[ClientID] = m_aPlayers.add(Stats);
+			m_aLastAttackTick[ClientID] = -1;
+		}
+		return &m_aPlayers[m_aSlots[ClientID]];
+	}
+
+	// players that are in the game, messages can refer to players that already left
+	CPlayerStats *FindPlayer(int ClientID)
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aSlots[ClientID] == -1)
+			return 0;
+		return &m_aPlayers[m_aSlots[ClientID]];
+	}
+
+	void AddEvent(int Type, int Player, int Target, int Weapon)
+	{
+		if(!m_RecordEvents)
+			return;
+		CEvent Event;
+		Event.m_Tick = m_pPlayer->BaseInfo()->m_CurrentTick;
+		Event.m_Type = Type;
+		Event.m_Player = m_aSlots[Player];
+		Event.m_Target = Target >= 0 && Target < MAX_CLIENTS ? m_aSlots[Target] : -1;
+		Event.m_Weapon = Weapon;
+		m_aEvents.add(Event);
+	}
+
+	void OnFlag(int Team, int Carrier)
+	{
+		int Last = m_aFlagCarrier[Team];
+		m_aFlagCarrier[Team] = Carrier;
+		if(Carrier == Last)
+			return;
+
+		int Tick = m_pPlayer->BaseInfo()->m_CurrentTick;
+		if(Carrier >= 0)
+		{
+			CPlayerStats *pStats = Player(Carrier);
+			if(!pStats)
+				return;
+			pStats->m_FlagGrabs++;
+			AddEvent(EVENT_FLAG_GRAB, Carrier, -1, -1);
+			// capture times only count when the flag was taken from the stand
+			m_aFlagGrabTick[Team] = Last == FLAG_ATSTAND ? Tick : -1;
+		}
+		else if(Last >= 0 && Carrier == FLAG_ATSTAND)
+		{
+			// the flag only goes from a player straight back to the stand when it's captured
+			CPlayerStats *pStats = Player(Last);
+			if(!pStats)
+				return;
+			pStats->m_FlagCaptures++;
+			AddEvent(EVENT_FLAG_CAPTURE, Last, -1, -1);
+			if(m_aFlagGrabTick[Team] != -1)
+			{
+				int Ticks = Tick-m_aFlagGrabTick[Team];
+				if(pStats->m_BestCaptureTicks == -1 || Ticks < pStats->m_BestCaptureTicks)
+					pStats->m_BestCaptureTicks = Ticks;
+			}
+		}
+	}
+
+public:
+	void OnDemoPlayerSnapshot(void *pData, int Size)
+	{
+		CSnapshot *pSnap = (CSnapshot *)pData;
+		int NumItems = pSnap->NumItems();
+
+		// players that left free their slot, the next one with the id gets a new entry
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			m_aSeen[i] = false;
+		for(int i = 0; i < NumItems; i++)
+		{
+			CSnapshotItem *pItem = pSnap->GetItem(i);
+			if(pItem->Type() == NETOBJTYPE_PLAYERINFO && pItem->ID() < MAX_CLIENTS)
+				m_aSeen[pItem->ID()] = true;
+		}
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(!m_aSeen[i])
+				m_aSlots[i] = -1;
+
+		for(int i = 0; i < NumItems; i++)
+		{
+			CSnapshotItem *pItem = pSnap->GetItem(i);
+			int ItemSize = pSnap->GetItemSize(i);
+			int ID = pItem->ID();
+
+			if(pItem->Type() == NETOBJTYPE_PLAYERINFO && ItemSize >= (int)sizeof(CNetObj_PlayerInfo))
+			{
+				const CNetObj_PlayerInfo *pInfo = (const CNetObj_PlayerInfo *)pItem->Data();
+				CPlayerStats *pStats = Player(ID);
+				if(pStats)
+				{
+					pStats->m_Team = pInfo->m_Team;
+					pStats->m_Score = pInfo->m_Score;
+				}
+			}
+			else if(pItem->Type() == NETOBJTYPE_CLIENTINFO && ItemSize >= (int)sizeof(CNetObj_ClientInfo) && ID < MAX_CLIENTS && m_aSeen[ID])
+			{
+				const CNetObj_ClientInfo *pInfo = (const CNetObj_ClientInfo *)pItem->Data();
+				CPlayerStats *pStats = Player(ID);
+				IntsToStr(&pInfo->m_Name0, 4, pStats->m_aName);
+				IntsToStr(&pInfo->m_Clan0, 3, pStats->m_aClan);
+			}
+			else if(pItem->Type() == NETOBJTYPE_CHARACTER && ItemSize >= (int)sizeof(CNetObj_Character) && ID < MAX_CLIENTS && m_aSeen[ID])
+			{
+				// every attack sets the attack tick
+				const CNetObj_Character *pChar = (const CNetObj_Character *)pItem->Data();
+				CPlayerStats *pStats = Player(ID);
+				if(pChar->m_AttackTick != m_aLastAttackTick[ID])
+				{
+					if(m_aLastAttackTick[ID] != -1 && pChar->m_Weapon >= 0 && pChar->m_Weapon < NUM_WEAPONS)
+						pStats->m_aShots[pChar->m_Weapon]++;
+					m_aLastAttackTick[ID] = pChar->m_AttackTick;
+				}
+			}
+			else if(pItem->Type() == NETOBJTYPE_GAMEDATA && ItemSize >= (int)sizeof(CNetObj_GameData))
+			{
+				const CNetObj_GameData *pGameData = (const CNetObj_GameData *)pItem->Data();
+				OnFlag(TEAM_RED, pGameData->m_FlagCarrierRed);
+				OnFlag(TEAM_BLUE, pGameData->m_FlagCarrierBlue);
+			}
+		}
+	}
+
+	void OnDemoPlayerMessage(void *pData, int Size)
+	{
+		CUnpacker Unpacker;
+		Unpacker.Reset(pData, Size);
+
+		// the system flag is stored in the lowest bit of the message id
+		int Msg = Unpacker.GetInt();
+		if(Unpacker.Error() || (Msg&1) || (Msg>>1) != NETMSGTYPE_SV_KILLMSG)
+			return;
+
+		int Killer = Unpacker.GetInt();
+		int Victim = Unpacker.GetInt();
+		int Weapon = Unpacker.GetInt();
+		if(Unpacker.Error() || Weapon == WEAPON_GAME)
+			return;
+
+		CPlayerStats *pVictim = FindPlayer(Victim);
+		if(!pVictim)
+			return;
+		pVictim->m_Deaths++;
+
+		if(Killer == Victim || Weapon == WEAPON_SELF || Weapon == WEAPON_WORLD)
+		{
+			pVictim->m_Suicides++;
+			AddEvent(EVENT_SUICIDE, Victim, -1, Weapon);
+		}
+		else if(CPlayerStats *pKiller = FindPlayer(Killer))
+		{
+			pKiller->m_Kills++;
+			if(Weapon >= 0 && Weapon < NUM_WEAPONS)
+				pKiller->m_aWeaponKills[Weapon]++;
+			AddEvent(EVENT_KILL, Killer, Victim, Weapon);
+		}
+	}
+
+	void Run()
+	{
+		m_Loaded = false;
+		m_aMap[0] = 0;
+		m_NumTicks = 0;
+		m_aPlayers.clear();
+		m_aEvents.clear();
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			m_aSlots[i] = -1;
+		for(int i = 0; i < 2; i++)
+		{
+			m_aFlagCarrier[i] = FLAG_ATSTAND;
+			m_aFlagGrabTick[i] = -1;
+		}
+
+		CSnapshotDelta SnapshotDelta;
+		CDemoPlayer *pPlayer = new CDemoPlayer(&SnapshotDelta);
+		m_pPlayer = pPlayer;
+		pPlayer->SetListner(this);
+		// the map isn't needed, and jobs loading demos of the same map would write the same file
+		pPlayer->SetSaveMap(false);
+		if(pPlayer->Load(m_pStorage, m_pConsole, m_pFilename, IStorage::TYPE_ALL) == 0)
+		{
+			m_Loaded = true;
+			str_copy(m_aMap, pPlayer->Info()->m_Header.m_aMapName, sizeof(m_aMap));
+
+			// decode as fast as possible, the player pauses at the end of the demo
+			pPlayer->Play();
+			while(pPlayer->IsPlaying() && !pPlayer->BaseInfo()->m_Paused)
+				pPlayer->NextFrame();
+			m_NumTicks = max(0, pPlayer->BaseInfo()->m_LastTick-pPlayer->BaseInfo()->m_FirstTick);
+			pPlayer->Stop();
+		}
+		delete pPlayer;
+	}
+
+	static int Job(void *pUser)
+	{
+		((CDemoStats *)pUser)->Run();
+		return 0;
+	}
+};
+
+class COutput
+{
+	IOHANDLE m_File;
+
+public:
+	COutput(IOHANDLE File) : m_File(File) {}
+
+	void Write(const char *pStr) { io_write(m_File, pStr, str_length(pStr)); }
+
+	void WriteCsvString(const char *pStr)
+	{
+		// quote everything, quotes are doubled
+		Write("\"");
+		for(; *pStr; pStr++)
+		{
+			char aChar[2] = {*pStr, 0};
+			Write(*pStr == '"' ? "\"\"" : aChar);
+		}
+		Write("\"");
+	}
+
+	void WriteJsonString(const char *pStr)
+	{
+		Write("\"");
+		for(; *pStr; pStr++)
+		{
+			unsigned char c = *pStr;
+			if(c == '"' || c == '\\')
+			{
+				char aEscaped[3] = {'\\', (char)c, 0};
+				Write(aEscaped);
+			}
+			else if(c < 0x20)
+			{
+				char aBuf[8];
+				str_format(aBuf, sizeof(aBuf), "\\u%04x", c);
+				Write(aBuf);
+			}
+			else
+			{
+				char aChar[2] = {(char)c, 0};
+				Write(aChar);
+			}
+		}
+		Write("\"");
+	}
+};
+
+static float Accuracy(const CPlayerStats *pStats)
+{
+	int Shots = 0, Kills = 0;
+	for(int w = 0; w < NUM_WEAPONS; w++)
+	{
+		Shots += pStats->m_aShots[w];
+		Kills += pStats->m_aWeaponKills[w];
+	}
+	return Shots ? Kills/(float)Shots : 0.0f;
+}
+
+static const char *FormatCaptureTime(const CPlayerStats *pStats, char *pBuf, int BufSize, const char *pNone)
+{
+	if(pStats->m_BestCaptureTicks == -1)
+		return pNone;
+	str_format(pBuf, BufSize, "%.2f", pStats->m_BestCaptureTicks/(float)SERVER_TICK_SPEED);
+	return pBuf;
+}
+
+static void WriteCsv(COutput *pOut, CDemoStats *pDemos, int NumDemos, bool Events)
+{
+	if(Events)
+	{
+		pOut->Write("demo,tick,event,client_id,name,target_id,target_name,weapon\n");
+		for(int d = 0; d < NumDemos; d++)
+		{
+			const CDemoStats *pDemo = &pDemos[d];
+			for(int i = 0; i < pDemo->m_aEvents.size(); i++)
+			{
+				const CEvent *pEvent = &pDemo->m_aEvents[i];
+				const CPlayerStats *pPlayer = &pDemo->m_aPlayers[pEvent->m_Player];
+				const CPlayerStats *pTarget = pEvent->m_Target != -1 ? &pDemo->m_aPlayers[pEvent->m_Target] : 0;
+				char aBuf[32];
+				pOut->WriteCsvString(pDemo->m_pFilename);
+				str_format(aBuf, sizeof(aBuf), ",%d,", pEvent->m_Tick);
+				pOut->Write(aBuf);
+				pOut->Write(s_apEventNames[pEvent->m_Type]);
+				str_format(aBuf, sizeof(aBuf), ",%d,", pPlayer->m_ClientID);
+				pOut->Write(aBuf);
+				pOut->WriteCsvString(pPlayer->m_aName);
+				str_format(aBuf, sizeof(aBuf), ",%d,", pTarget ? pTarget->m_ClientID : -1);
+				pOut->Write(aBuf);
+				pOut->WriteCsvString(pTarget ? pTarget->m_aName : "");
+				pOut->Write(",");
+				pOut->Write(pEvent->m_Weapon >= 0 && pEvent->m_Weapon < NUM_WEAPONS ? s_apWeaponNames[pEvent->m_Weapon] : "");
+				pOut->Write("\n");
+			}
+		}
+		return;
+	}
+
+	pOut->Write("demo,map,client_id,name,clan,team,score,kills,deaths,suicides,flag_grabs,flag_captures,best_capture_time,accuracy");
+	for(int w = 0; w < NUM_WEAPONS; w++)
+	{
+		pOut->Write(",shots_");
+		pOut->Write(s_apWeaponNames[w]);
+		pOut->Write(",kills_");
+		pOut->Write(s_apWeaponNames[w]);
+	}
+	pOut->Write("\n");
+
+	for(int d = 0; d < NumDemos; d++)
+	{
+		const CDemoStats *pDemo = &pDemos[d];
+		for(int i = 0; i < pDemo->m_aPlayers.size(); i++)
+		{
+			const CPlayerStats *pStats = &pDemo->m_aPlayers[i];
+			char aBuf[128];
+			pOut->WriteCsvString(pDemo->m_pFilename);
+			pOut->Write(",");
+			pOut->WriteCsvString(pDemo->m_aMap);
+			str_format(aBuf, sizeof(aBuf), ",%d,", pStats->m_ClientID);
+			pOut->Write(aBuf);
+			pOut->WriteCsvString(pStats->m_aName);
+			pOut->Write(",");
+			pOut->WriteCsvString(pStats->m_aClan);
+			str_format(aBuf, sizeof(aBuf), ",%d,%d,%d,%d,%d,%d,%d,", pStats->m_Team, pStats->m_Score, pStats->m_Kills,
+				pStats->m_Deaths, pStats->m_Suicides, pStats->m_FlagGrabs, pStats->m_FlagCaptures);
+			pOut->Write(aBuf);
+			pOut->Write(FormatCaptureTime(pStats, aBuf, sizeof(aBuf), ""));
+			str_format(aBuf, sizeof(aBuf), ",%.3f", Accuracy(pStats));
+			pOut->Write(aBuf);
+			for(int w = 0; w < NUM_WEAPONS; w++)
+			{
+				str_format(aBuf, sizeof(aBuf), ",%d,%d", pStats->m_aShots[w], pStats->m_aWeaponKills[w]);
+				pOut->Write(aBuf);
+			}
+			pOut->Write("\n");
+		}
+	}
+}
+
+static void WriteJson(COutput *pOut, CDemoStats *pDemos, int NumDemos, bool Events)
+{
+	char aBuf[256];
+	pOut->Write("[\n");
+	for(int d = 0; d < NumDemos; d++)
+	{
+		const CDemoStats *pDemo = &pDemos[d];
+		pOut->Write("\t{\"demo\": ");
+		pOut->WriteJsonString(pDemo->m_pFilename);
+		pOut->Write(", \"map\": ");
+		pOut->WriteJsonString(pDemo->m_aMap);
+		str_format(aBuf, sizeof(aBuf), ", \"length\": %.2f, \"players\": [", pDemo->m_NumTicks/(float)SERVER_TICK_SPEED);
+		pOut->Write(aBuf);
+
+		for(int i = 0; i < pDemo->m_aPlayers.size(); i++)
+		{
+			const CPlayerStats *pStats = &pDemo->m_aPlayers[i];
+			str_format(aBuf, sizeof(aBuf), "%s\n\t\t{\"client_id\": %d, \"name\": ", i ? "," : "", pStats->m_ClientID);
+			pOut->Write(aBuf);
+			pOut->WriteJsonString(pStats->m_aName);
+			pOut->Write(", \"clan\": ");
+			pOut->WriteJsonString(pStats->m_aClan);
+			str_format(aBuf, sizeof(aBuf), ", \"team\": %d, \"score\": %d, \"kills\": %d, \"deaths\": %d, \"suicides\": %d, "
+				"\"flag_grabs\": %d, \"flag_captures\": %d, \"best_capture_time\": ",
+				pStats->m_Team, pStats->m_Score, pStats->m_Kills, pStats->m_Deaths, pStats->m_Suicides, pStats->m_FlagGrabs,
+				pStats->m_FlagCaptures);
+			pOut->Write(aBuf);
+			pOut->Write(FormatCaptureTime(pStats, aBuf, sizeof(aBuf), "null"));
+			str_format(aBuf, sizeof(aBuf), ", \"accuracy\": %.3f, \"weapons\": {", Accuracy(pStats));
+			pOut->Write(aBuf);
+			for(int w = 0; w < NUM_WEAPONS; w++)
+			{
+				str_format(aBuf, sizeof(aBuf), "%s\"%s\": {\"shots\": %d, \"kills\": %d}", w ? ", " : "", s_apWeaponNames[w],
+					pStats->m_aShots[w], pStats->m_aWeaponKills[w]);
+				pOut->Write(aBuf);
+			}
+			pOut->Write("}}");
+		}
+		pOut->Write(pDemo->m_aPlayers.size() ? "\n\t]" : "]");
+
+		if(Events)
+		{
+			pOut->Write(", \"events\": [");
+			for(int i = 0; i < pDemo->m_aEvents.size(); i++)
+			{
+				const CEvent *pEvent = &pDemo->m_aEvents[i];
+				str_format(aBuf, sizeof(aBuf), "%s\n\t\t{\"tick\": %d, \"event\": \"%s\", \"client_id\": %d", i ? "," : "",
+					pEvent->m_Tick, s_apEventNames[pEvent->m_Type], pDemo->m_aPlayers[pEvent->m_Player].m_ClientID);
+				pOut->Write(aBuf);
+				if(pEvent->m_Target != -1)
+				{
+					str_format(aBuf, sizeof(aBuf), ", \"target_id\": %d", pDemo->m_aPlayers[pEvent->m_Target].m_ClientID);
+					pOut->Write(aBuf);
+				}
+				if(pEvent->m_Weapon >= 0 && pEvent->m_Weapon < NUM_WEAPONS)
+				{
+					pOut->Write(", \"weapon\": \"");
+					pOut->Write(s_apWeaponNames[pEvent->m_Weapon]);
+					pOut->Write("\"");
+				}
+				pOut->Write("}");
+			}
+			pOut->Write(pDemo->m_aEvents.size() ? "\n\t]" : "]");
+		}
+
+		pOut->Write(d+1 < NumDemos ? "},\n" : "}\n");
+	}
+	pOut->Write("]\n");
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	int NumThreads = 4;
+	bool Json = false;
+	bool Events = false;
+	const char *pOutput = 0;
+	array<const char *> apFilenames;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-j") == 0 && i+1 < argc) // ignore_convention
+			NumThreads = str_toint(argv[++i]); // ignore_convention
+		else if(str_comp(argv[i], "-json") == 0) // ignore_convention
+			Json = true;
+		else if(str_comp(argv[i], "-events") == 0) // ignore_convention
+			Events = true;
+		else if(str_comp(argv[i], "-o") == 0 && i+1 < argc) // ignore_convention
+			pOutput = argv[++i]; // ignore_convention
+		else
+			apFilenames.add(argv[i]); // ignore_convention
+	}
+
+	IOHANDLE Log = io_stderr();
+	if(!apFilenames.size())
+	{
+		const char *pUsage = "usage: demo_stats [-j threads] [-json] [-events] [-o output] demo...\n";
+		io_write(Log, pUsage, str_length(pUsage));
+		return -1;
+	}
+
+	IOHANDLE Output = pOutput ? io_open(pOutput, IOFLAG_WRITE) : io_stdout();
+	if(!Output)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing\n", pOutput);
+		io_write(Log, aBuf, str_length(aBuf));
+		return -1;
+	}
+
+	CNetBase::Init();
+	IStorage *pStorage = CreateStorage("Teeworlds", IStorage::STORAGETYPE_BASIC, argc, argv); // ignore_convention
+	IConsole *pConsole = CreateConsole(CFGFLAG_CLIENT);
+
+	CDemoStats *pDemos = new CDemoStats[apFilenames.size()];
+	CJob *pJobs = new CJob[apFilenames.size()];
+	CJobGroup Group;
+	static CJobPool s_Pool;
+	s_Pool.Init(NumThreads);
+
+	int64 Start = time_get();
+	for(int i = 0; i < apFilenames.size(); i++)
+	{
+		pDemos[i].m_pFilename = apFilenames[i];
+		pDemos[i].m_pStorage = pStorage;
+		pDemos[i].m_pConsole = pConsole;
+		pDemos[i].m_RecordEvents = Events;
+		s_Pool.Add(&pJobs[i], CDemoStats::Job, &pDemos[i], &Group);
+	}
+	s_Pool.Wait(&Group);
+	int64 Time = time_get()-Start;
+
+	// results are written in the order of the command line
+	COutput Out(Output);
+	if(Json)
+		WriteJson(&Out, pDemos, apFilenames.size(), Events);
+	else
+		WriteCsv(&Out, pDemos, apFilenames.size(), Events);
+	if(pOutput)
+		io_close(Output);
+
+	int NumLoaded = 0;
+	int64 NumTicks = 0;
+	for(int i = 0; i < apFilenames.size(); i++)
+	{
+		char aBuf[256];
+		if(pDemos[i].m_Loaded)
+		{
+			NumLoaded++;
+			NumTicks += pDemos[i].m_NumTicks;
+		}
+		else
+		{
+			str_format(aBuf, sizeof(aBuf), "failed to load '%s'\n", pDemos[i].m_pFilename);
+			io_write(Log, aBuf, str_length(aBuf));
+		}
+	}
+
+	double Seconds = (double)Time/time_freq();
+	double DemoSeconds = (double)NumTicks/SERVER_TICK_SPEED;
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%d of %d demos, %.1f demo seconds in %.2f seconds on %d threads: %.1f demo seconds per second\n",
+		NumLoaded, apFilenames.size(), DemoSeconds, Seconds, s_Pool.NumThreads(), Seconds > 0 ? DemoSeconds/Seconds : 0.0);
+	io_write(Log, aBuf, str_length(aBuf));
+
+	delete[] pJobs;
+	delete[] pDemos;
+	return NumLoaded == apFilenames.size() ? 0 : -1;
+}
@@ -0,0 +1,92 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <base/tl/threading.h>
+
+#include <engine/shared/jobs.h>
+
+// measures the scheduling overhead of the job pool with empty jobs
+
+enum
+{
+	NUM_JOBS=4096,
+	NUM_CHAIN=1024,
+};
+
+static volatile unsigned s_Counter = 0;
+
+static int EmptyJob(void *pData)
+{
+	atomic_inc(&s_Counter);
+	return 0;
+}
+
+static double NanosecondsPerJob(int64 Time, int NumJobs)
+{
+	return (double)Time*1000000000.0/time_freq()/NumJobs;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	int NumThreads = 4;
+	int Rounds = 100;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			NumThreads = str_toint(argv[++i]); // ignore_convention
+		else if(str_comp(argv[i], "-r") == 0 && i+1 < argc) // ignore_convention
+			Rounds = max(1, str_toint(argv[++i])); // ignore_convention
+	}
+
+	static CJobPool s_Pool;
+	s_Pool.Init(NumThreads);
+	dbg_msg("jobs_bench", "%d threads, %d rounds", s_Pool.NumThreads(), Rounds);
+
+	static CJob s_aJobs[NUM_JOBS];
+	CJobGroup Group;
+
+	// add a batch of jobs and wait for all of them, like a tick would
+	s_Counter = 0;
+	int64 Start = time_get();
+	for(int r = 0; r < Rounds; r++)
+	{
+		for(int i = 0; i < NUM_JOBS; i++)
+			s_Pool.Add(&s_aJobs[i], EmptyJob, 0, &Group);
+		s_Pool.Wait(&Group);
+	}
+	int64 Time = time_get()-Start;
+	if(s_Counter != (unsigned)(NUM_JOBS*Rounds))
+	{
+		dbg_msg("jobs_bench", "batch: only %d of %d jobs ran", s_Counter, NUM_JOBS*Rounds);
+		return -1;
+	}
+	dbg_msg("jobs_bench", "batch of %d: %.1f ns per job", NUM_JOBS, NanosecondsPerJob(Time, NUM_JOBS*Rounds));
+
+	// a single job at a time, measures the latency of waking a worker and the waiter
+	int NumSingle = Rounds*16;
+	Start = time_get();
+	for(int i = 0; i < NumSingle; i++)
+	{
+		s_Pool.Add(&s_aJobs[0], EmptyJob, 0, &Group);
+		s_Pool.Wait(&Group);
+	}
+	Time = time_get()-Start;
+	dbg_msg("jobs_bench", "single: %.1f ns per job", NanosecondsPerJob(Time, NumSingle));
+
+	// chain of continuations, each one started by the worker that finished the one before
+	static CJobGroup s_aChainGroups[NUM_CHAIN];
+	Start = time_get();
+	for(int r = 0; r < Rounds; r++)
+	{
+		s_Pool.Add(&s_aJobs[0], EmptyJob, 0, &s_aChainGroups[0]);
+		for(int i = 1; i < NUM_CHAIN; i++)
+			s_Pool.Then(&s_aChainGroups[i-1], &s_aJobs[i], EmptyJob, 0, &s_aChainGroups[i]);
+		s_Pool.Wait(&s_aChainGroups[NUM_CHAIN-1]);
+	}
+	Time = time_get()-Start;
+	dbg_msg("jobs_bench", "continuations: %.1f ns per job", NanosecondsPerJob(Time, NUM_CHAIN*Rounds));
+	return 0;
+}
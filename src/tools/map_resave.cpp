@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
 #include <base/system.h>
 #include <engine/shared/datafile.h>
 #include <engine/storage.h>
@@ -13,14 +14,34 @@ int main(int argc, const char **argv)
 	CDataFileReader DataFile;
 	CDataFileWriter df;
 
-	if(!pStorage || argc != 3)
+	// map_resave [-level 0-9 | -store] [-j threads] input output
+	int Compression = CDataFileWriter::COMPRESSION_DEFAULT;
+	int NumThreads = 0;
+	const char *apArgs[2] = {0};
+	int NumArgs = 0;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-level") == 0 && i+1 < argc) // ignore_convention
+			Compression = clamp(str_toint(argv[++i]), 0, (int)CDataFileWriter::COMPRESSION_BEST); // ignore_convention
+		else if(str_comp(argv[i], "-store") == 0) // ignore_convention
+			Compression = CDataFileWriter::COMPRESSION_STORE;
+		else if(str_comp(argv[i], "-j") == 0 && i+1 < argc) // ignore_convention
+			NumThreads = str_toint(argv[++i]); // ignore_convention
+		else if(NumArgs < 2)
+			apArgs[NumArgs++] = argv[i]; // ignore_convention
+	}
+
+	if(!pStorage || NumArgs != 2)
 		return -1;
 
-	str_format(aFileName, sizeof(aFileName), "%s", argv[2]);
+	str_format(aFileName, sizeof(aFileName), "%s", apArgs[1]);
 
-	if(!DataFile.Open(pStorage, argv[1], IStorage::TYPE_ALL))
+	static CJobPool s_Pool;
+	s_Pool.Init(NumThreads > 0 ? NumThreads : thread_num_cpus());
+
+	if(!DataFile.Open(pStorage, apArgs[0], IStorage::TYPE_ALL, &s_Pool))
 		return -1;
-	if(!df.Open(pStorage, aFileName))
+	if(!df.Open(pStorage, aFileName, Compression, &s_Pool))
 		return -1;
 
 	// add all items
@@ -35,11 +56,11 @@ int main(int argc, const char **argv)
 	for(Index = 0; Index < DataFile.NumData(); Index++)
 	{
 		pPtr = DataFile.GetData(Index);
-		Size = DataFile.GetDataSize(Index);
+		Size = DataFile.GetUncompressedDataSize(Index);
 		df.AddData(Size, pPtr);
 	}
 
-	DataFile.Close();
 	df.Finish();
+	DataFile.Close();
 	return 0;
 }
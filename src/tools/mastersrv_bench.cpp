@@ -0,0 +1,185 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/network.h>
+
+#include <mastersrv/mastersrv.h>
+
+// load generator for the master server. every simulated server has its own
+// socket, sends heartbeats and answers the firewall checks like a real one
+
+enum
+{
+	MAX_SIMULATED_SERVERS=4096,
+};
+
+struct CSimulatedServer
+{
+	NETSOCKET m_Socket;
+	bool m_Registered;
+};
+
+static CSimulatedServer s_aServers[MAX_SIMULATED_SERVERS];
+static int s_NumServers = 0;
+
+static int s_NumHeartbeats = 0;
+static int s_NumChecks = 0;
+static int s_NumRegistered = 0;
+static int s_NumErrors = 0;
+static int s_NumListed = 0;
+
+static void SendHeartbeat(CSimulatedServer *pServer, NETADDR *pMaster)
+{
+	unsigned char aData[sizeof(SERVERBROWSE_HEARTBEAT) + 2];
+	mem_copy(aData, SERVERBROWSE_HEARTBEAT, sizeof(SERVERBROWSE_HEARTBEAT));
+
+	// no alternative port
+	aData[sizeof(SERVERBROWSE_HEARTBEAT)] = 0;
+	aData[sizeof(SERVERBROWSE_HEARTBEAT)+1] = 0;
+
+	CNetBase::SendPacketConnless(pServer->m_Socket, pMaster, aData, sizeof(aData));
+	s_NumHeartbeats++;
+}
+
+static bool IsPacket(const unsigned char *pData, int Size, const unsigned char *pMsg, int MsgSize)
+{
+	// connless packets start with 6 bytes of 0xff
+	return Size >= 6+MsgSize && mem_comp(pData+6, pMsg, MsgSize) == 0;
+}
+
+static void Poll(CSimulatedServer *pServer)
+{
+	unsigned char aBuf[NET_MAX_PACKETSIZE];
+	NETADDR From;
+	int Size;
+	while((Size = net_udp_recv(pServer->m_Socket, &From, aBuf, sizeof(aBuf))) > 0)
+	{
+		if(IsPacket(aBuf, Size, SERVERBROWSE_FWCHECK, sizeof(SERVERBROWSE_FWCHECK)))
+		{
+			CNetBase::SendPacketConnless(pServer->m_Socket, &From, SERVERBROWSE_FWRESPONSE, sizeof(SERVERBROWSE_FWRESPONSE));
+			s_NumChecks++;
+		}
+		else if(IsPacket(aBuf, Size, SERVERBROWSE_FWOK, sizeof(SERVERBROWSE_FWOK)))
+		{
+			if(!pServer->m_Registered)
+				s_NumRegistered++;
+			pServer->m_Registered = true;
+		}
+		else if(IsPacket(aBuf, Size, SERVERBROWSE_FWERROR, sizeof(SERVERBROWSE_FWERROR)))
+			s_NumErrors++;
+		else if(IsPacket(aBuf, Size, SERVERBROWSE_LIST, sizeof(SERVERBROWSE_LIST)))
+			s_NumListed += (Size-6-(int)sizeof(SERVERBROWSE_LIST))/(int)sizeof(CMastersrvAddr);
+	}
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	net_init();
+
+	const char *pMaster = "localhost";
+	int NumServers = 500;
+	int Seconds = 20;
+	int Rate = 1000;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-m") == 0 && i+1 < argc) // ignore_convention
+			pMaster = argv[++i]; // ignore_convention
+		else if(str_comp(argv[i], "-n") == 0 && i+1 < argc) // ignore_convention
+			NumServers = clamp(str_toint(argv[++i]), 1, (int)MAX_SIMULATED_SERVERS); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			Seconds = max(1, str_toint(argv[++i])); // ignore_convention
+		else if(str_comp(argv[i], "-r") == 0 && i+1 < argc) // ignore_convention
+			Rate = max(1, str_toint(argv[++i])); // ignore_convention
+	}
+
+	NETADDR MasterAddr;
+	if(net_host_lookup(pMaster, &MasterAddr, NETTYPE_IPV4) != 0)
+	{
+		dbg_msg("mastersrv_bench", "couldn't resolve '%s'", pMaster);
+		return -1;
+	}
+	if(!MasterAddr.port)
+		MasterAddr.port = MASTERSERVER_PORT;
+
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_IPV4;
+	for(s_NumServers = 0; s_NumServers < NumServers; s_NumServers++)
+	{
+		CSimulatedServer *pServer = &s_aServers[s_NumServers];
+		pServer->m_Socket = net_udp_create(BindAddr);
+		if(pServer->m_Socket.type == NETTYPE_INVALID)
+		{
+			dbg_msg("mastersrv_bench", "only %d sockets could be created", s_NumServers);
+			break;
+		}
+		pServer->m_Registered = false;
+	}
+	if(!s_NumServers)
+		return -1;
+
+	dbg_msg("mastersrv_bench", "%d servers, %d heartbeats per second for %d seconds", s_NumServers, Rate, Seconds);
+
+	// heartbeats round robin at the wanted rate
+	int64 Start = time_get();
+	int64 End = Start+time_freq()*Seconds;
+	int64 AllRegistered = 0;
+	int Next = 0;
+	while(time_get() < End)
+	{
+		int64 Now = time_get();
+		int Due = (int)((Now-Start)*Rate/time_freq());
+		while(s_NumHeartbeats < Due)
+		{
+			SendHeartbeat(&s_aServers[Next], &MasterAddr);
+			Next = (Next+1)%s_NumServers;
+		}
+
+		for(int i = 0; i < s_NumServers; i++)
+			Poll(&s_aServers[i]);
+
+		if(!AllRegistered && s_NumRegistered == s_NumServers)
+			AllRegistered = time_get();
+
+		thread_sleep(1);
+	}
+	double Time = (double)(time_get()-Start)/time_freq();
+
+	// fetch the list from a socket of its own, the master might still be
+	// busy with the backlog so give it some time to answer
+	CSimulatedServer Client;
+	Client.m_Socket = net_udp_create(BindAddr);
+	Client.m_Registered = false;
+	CNetBase::SendPacketConnless(Client.m_Socket, &MasterAddr, SERVERBROWSE_GETLIST, sizeof(SERVERBROWSE_GETLIST));
+	int64 ListStart = time_get();
+	int64 LastListed = ListStart;
+	int LastNumListed = 0;
+	while(time_get()-ListStart < time_freq()*10 && (!s_NumListed || time_get()-LastListed < time_freq()/2))
+	{
+		for(int i = 0; i < s_NumServers; i++)
+			Poll(&s_aServers[i]);
+		Poll(&Client);
+		if(s_NumListed != LastNumListed)
+		{
+			LastNumListed = s_NumListed;
+			LastListed = time_get();
+		}
+		thread_sleep(1);
+	}
+	net_udp_close(Client.m_Socket);
+
+	dbg_msg("mastersrv_bench", "%d heartbeats in %.2f seconds (%.1f per second), %d checks answered",
+		s_NumHeartbeats, Time, s_NumHeartbeats/Time, s_NumChecks);
+	if(AllRegistered)
+		dbg_msg("mastersrv_bench", "all %d servers registered after %.2f seconds", s_NumServers, (double)(AllRegistered-Start)/time_freq());
+	else
+		dbg_msg("mastersrv_bench", "%d of %d servers registered, %d check errors", s_NumRegistered, s_NumServers, s_NumErrors);
+	dbg_msg("mastersrv_bench", "server list has %d servers", s_NumListed);
+
+	for(int i = 0; i < s_NumServers; i++)
+		net_udp_close(s_aServers[i].m_Socket);
+	return 0;
+}
@@ -0,0 +1,141 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/soundmix.h>
+
+// mixes random voices into a buffer like the client's audio callback does,
+// once with the scalar loops and once with the vector ones, checks that the
+// output is the same and times both. no audio device needed
+
+enum
+{
+	NUM_VOICES=64,
+	SAMPLE_FRAMES=48000,
+	MAX_FRAMES=8192,
+};
+
+struct CVoice
+{
+	short *m_pData;
+	int m_Channels;
+	int m_NumFrames;
+	int m_Tick;
+	int m_LVol, m_RVol;
+};
+
+static CVoice s_aVoices[NUM_VOICES];
+static int s_NumVoices = 32;
+static unsigned s_Seed;
+
+static unsigned Random() { return random_next(&s_Seed); }
+
+static void CreateVoices()
+{
+	s_Seed = 1;
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		CVoice *v = &s_aVoices[i];
+		v->m_Channels = 1 + (i&1);
+		v->m_NumFrames = SAMPLE_FRAMES/2 + Random()%(SAMPLE_FRAMES/2);
+		v->m_pData = (short *)mem_alloc(v->m_NumFrames*v->m_Channels*sizeof(short), 1);
+		for(int s = 0; s < v->m_NumFrames*v->m_Channels; s++)
+			v->m_pData[s] = (short)(Random()&0xffff);
+		// a few of them far away and a few right at the edge of the range
+		v->m_LVol = i%8 == 0 ? 0 : Random()%256;
+		v->m_RVol = i%8 == 0 ? 0 : i%5 == 0 ? 255 : Random()%256;
+	}
+}
+
+static void ResetVoices()
+{
+	for(int i = 0; i < NUM_VOICES; i++)
+		s_aVoices[i].m_Tick = 0;
+}
+
+// one callback worth of frames
+static void Mix(int *pMixBuffer, short *pOut, unsigned Frames, bool Scalar)
+{
+	mem_zero(pMixBuffer, Frames*2*sizeof(int));
+	for(int i = 0; i < s_NumVoices; i++)
+	{
+		CVoice *v = &s_aVoices[i];
+		const short *pIn = &v->m_pData[v->m_Tick*v->m_Channels];
+		unsigned End = min(Frames, (unsigned)(v->m_NumFrames-v->m_Tick));
+		if(v->m_LVol || v->m_RVol)
+		{
+			if(v->m_Channels == 1)
+				(Scalar ? CSoundMix::MixMonoScalar : CSoundMix::MixMono)(pMixBuffer, pIn, End, v->m_LVol, v->m_RVol);
+			else
+				(Scalar ? CSoundMix::MixStereoScalar : CSoundMix::MixStereo)(pMixBuffer, pIn, End, v->m_LVol, v->m_RVol);
+		}
+		v->m_Tick = (v->m_Tick+End)%v->m_NumFrames;
+	}
+	(Scalar ? CSoundMix::FinishScalar : CSoundMix::Finish)(pOut, pMixBuffer, Frames, 100);
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	int Frames = 1024;
+	int Callbacks = 10000;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-v") == 0 && i+1 < argc) // ignore_convention
+			s_NumVoices = clamp(str_toint(argv[++i]), 1, (int)NUM_VOICES); // ignore_convention
+		else if(str_comp(argv[i], "-f") == 0 && i+1 < argc) // ignore_convention
+			Frames = clamp(str_toint(argv[++i]), 1, (int)MAX_FRAMES); // ignore_convention
+		else if(str_comp(argv[i], "-n") == 0 && i+1 < argc) // ignore_convention
+			Callbacks = max(str_toint(argv[++i]), 1); // ignore_convention
+	}
+
+	CreateVoices();
+	int *pMixBuffer = (int *)mem_alloc(MAX_FRAMES*2*sizeof(int), 1);
+	short *apOut[2];
+	for(int i = 0; i < 2; i++)
+		apOut[i] = (short *)mem_alloc(MAX_FRAMES*2*sizeof(short), 1);
+
+	dbg_msg("mix_bench", "%s mixer, %d voices, %d frames per callback", CSoundMix::Implementation(), s_NumVoices, Frames);
+
+	// odd callback sizes as well, so the loops have to finish up the tails
+	unsigned Seed = 1;
+	for(int c = 0; c < 1000; c++)
+	{
+		unsigned Size = 1 + random_next(&Seed)%MAX_FRAMES;
+		int aTicks[NUM_VOICES];
+		for(int i = 0; i < NUM_VOICES; i++)
+			aTicks[i] = s_aVoices[i].m_Tick;
+		Mix(pMixBuffer, apOut[0], Size, true);
+		for(int i = 0; i < NUM_VOICES; i++)
+			s_aVoices[i].m_Tick = aTicks[i];
+		Mix(pMixBuffer, apOut[1], Size, false);
+		if(mem_comp(apOut[0], apOut[1], Size*2*sizeof(short)) != 0)
+		{
+			dbg_msg("mix_bench", "callback %d with %d frames differs", c, Size);
+			return -1;
+		}
+	}
+	dbg_msg("mix_bench", "verified 1000 callbacks, the output is identical");
+
+	int64 aTimes[2];
+	for(int m = 0; m < 2; m++)
+	{
+		ResetVoices();
+		int64 Start = time_get();
+		for(int c = 0; c < Callbacks; c++)
+			Mix(pMixBuffer, apOut[m], Frames, m == 0);
+		aTimes[m] = time_get()-Start;
+	}
+
+	dbg_msg("mix_bench", "scalar: %.3f us per callback", aTimes[0]*1000000.0/time_freq()/Callbacks);
+	dbg_msg("mix_bench", "%s: %.3f us per callback", CSoundMix::Implementation(), aTimes[1]*1000000.0/time_freq()/Callbacks);
+
+	for(int i = 0; i < NUM_VOICES; i++)
+		mem_free(s_aVoices[i].m_pData);
+	mem_free(pMixBuffer);
+	mem_free(apOut[0]);
+	mem_free(apOut[1]);
+	return 0;
+}
@@ -0,0 +1,273 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <game/gamecore.h>
+
+#include "bench.h"
+
+// replays the same recorded inputs through the character cores twice, once
+// with the old per pixel movement and once with CCharacterCore::Move, and
+// checks that both worlds end up in exactly the same state
+
+enum
+{
+	MAX_CHARACTERS=MAX_CLIENTS,
+	MAX_TICKS=SERVER_TICK_SPEED*60*10,
+};
+
+static CBenchMap s_Map;
+static CNetObj_PlayerInput *s_pInputs;
+static vec2 s_aSpawns[MAX_CHARACTERS];
+static int s_NumCharacters = 32;
+static unsigned s_Seed;
+
+static unsigned Random() { return random_next(&s_Seed); }
+static float RandomFloat() { return random_next_float(&s_Seed); }
+
+// input streams that keep the tees busy: running, jumping and hooking into walls and each other
+static void RecordInputs(int Ticks)
+{
+	s_Seed = 1;
+
+	// spawn them in a few groups so they bump into each other
+	for(int i = 0; i < s_NumCharacters; i++)
+		s_aSpawns[i] = i%8 ? s_aSpawns[i-1] + vec2(RandomFloat()*8-4, -2.0f) : s_Map.RandomFreePos(&s_Seed, vec2(28.0f, 28.0f));
+
+	for(int c = 0; c < s_NumCharacters; c++)
+	{
+		CNetObj_PlayerInput Input = {0};
+		for(int t = 0; t < Ticks; t++)
+		{
+			if(Random()%20 == 0)
+				Input.m_Direction = (int)(Random()%3)-1;
+			if(Random()%30 == 0)
+			{
+				float Angle = RandomFloat()*2*pi;
+				Input.m_TargetX = (int)(cosf(Angle)*200.0f);
+				Input.m_TargetY = (int)(sinf(Angle)*200.0f);
+			}
+			Input.m_Jump = Random()%12 == 0;
+			if(Random()%25 == 0)
+				Input.m_Hook ^= 1;
+			s_pInputs[t*MAX_CHARACTERS+c] = Input;
+		}
+	}
+}
+
+// the box movement as it was before, every step gets tested
+static void MoveBoxSampled(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, float Elasticity)
+{
+	vec2 Pos = *pInoutPos;
+	vec2 Vel = *pInoutVel;
+
+	float Distance = length(Vel);
+	int Max = (int)Distance;
+
+	if(Distance > 0.00001f)
+	{
+		float Fraction = 1.0f/(float)(Max+1);
+		for(int i = 0; i <= Max; i++)
+		{
+			vec2 NewPos = Pos + Vel*Fraction;
+			if(s_Map.m_Collision.TestBox(vec2(NewPos.x, NewPos.y), Size))
+			{
+				int Hits = 0;
+				if(s_Map.m_Collision.TestBox(vec2(Pos.x, NewPos.y), Size))
+				{
+					NewPos.y = Pos.y;
+					Vel.y *= -Elasticity;
+					Hits++;
+				}
+				if(s_Map.m_Collision.TestBox(vec2(NewPos.x, Pos.y), Size))
+				{
+					NewPos.x = Pos.x;
+					Vel.x *= -Elasticity;
+					Hits++;
+				}
+				if(Hits == 0)
+				{
+					NewPos.y = Pos.y;
+					Vel.y *= -Elasticity;
+					NewPos.x = Pos.x;
+					Vel.x *= -Elasticity;
+				}
+			}
+			Pos = NewPos;
+		}
+	}
+
+	*pInoutPos = Pos;
+	*pInoutVel = Vel;
+}
+
+// CCharacterCore::Move as it was before, stepping pixel by pixel through all characters
+static void MoveSampled(CCharacterCore *pCore, CWorldCore *pWorld)
+{
+	float RampValue = VelocityRamp(length(pCore->m_Vel)*50, pWorld->m_Tuning.m_VelrampStart, pWorld->m_Tuning.m_VelrampRange, pWorld->m_Tuning.m_VelrampCurvature);
+
+	pCore->m_Vel.x = pCore->m_Vel.x*RampValue;
+
+	vec2 NewPos = pCore->m_Pos;
+	MoveBoxSampled(&NewPos, &pCore->m_Vel, vec2(28.0f, 28.0f), 0);
+
+	pCore->m_Vel.x = pCore->m_Vel.x*(1.0f/RampValue);
+
+	if(pWorld->m_Tuning.m_PlayerCollision)
+	{
+		float Distance = distance(pCore->m_Pos, NewPos);
+		int End = Distance+1;
+		vec2 LastPos = pCore->m_Pos;
+		for(int i = 0; i < End; i++)
+		{
+			float a = i/Distance;
+			vec2 Pos = mix(pCore->m_Pos, NewPos, a);
+			for(int p = 0; p < MAX_CLIENTS; p++)
+			{
+				CCharacterCore *pCharCore = pWorld->m_apCharacters[p];
+				if(!pCharCore || pCharCore == pCore)
+					continue;
+				float D = distance(Pos, pCharCore->m_Pos);
+				if(D < 28.0f && D > 0.0f)
+				{
+					if(a > 0.0f)
+						pCore->m_Pos = LastPos;
+					else if(distance(NewPos, pCharCore->m_Pos) > D)
+						pCore->m_Pos = NewPos;
+					return;
+				}
+			}
+			LastPos = Pos;
+		}
+	}
+
+	pCore->m_Pos = NewPos;
+}
+
+class CWorld
+{
+public:
+	CWorldCore m_Core;
+	CCharacterCore m_aCharacters[MAX_CHARACTERS];
+
+	void Reset()
+	{
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			m_aCharacters[i].Init(&m_Core, &s_Map.m_Collision);
+			m_aCharacters[i].Reset();
+			m_aCharacters[i].m_Pos = s_aSpawns[i];
+			m_Core.m_apCharacters[i] = &m_aCharacters[i];
+		}
+	}
+
+	void Tick(int Tick, bool Sampled)
+	{
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			m_aCharacters[i].m_Input = s_pInputs[Tick*MAX_CHARACTERS+i];
+			m_aCharacters[i].Tick(true);
+		}
+
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			if(Sampled)
+				MoveSampled(&m_aCharacters[i], &m_Core);
+			else
+				m_aCharacters[i].Move();
+			m_aCharacters[i].Quantize();
+
+			// whoever leaves the map starts over
+			vec2 Pos = m_aCharacters[i].m_Pos;
+			if(Pos.x < -200.0f || Pos.y < -200.0f || Pos.x > s_Map.m_Collision.GetWidth()*32+200.0f || Pos.y > s_Map.m_Collision.GetHeight()*32+200.0f)
+			{
+				m_aCharacters[i].Reset();
+				m_aCharacters[i].m_Pos = s_aSpawns[i];
+			}
+		}
+	}
+
+	unsigned Checksum()
+	{
+		unsigned Checksum = 0;
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			// Write leaves the tick alone
+			CNetObj_CharacterCore Core;
+			mem_zero(&Core, sizeof(Core));
+			m_aCharacters[i].Write(&Core);
+			const int *pData = (const int *)&Core;
+			for(unsigned k = 0; k < sizeof(Core)/sizeof(int); k++)
+				Checksum = Checksum*31 + pData[k];
+		}
+		return Checksum;
+	}
+};
+
+static CWorld s_aWorlds[2];
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	const char *pMapName = "maps/ctf5.map";
+	int Ticks = SERVER_TICK_SPEED*60;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-c") == 0 && i+1 < argc) // ignore_convention
+			s_NumCharacters = clamp(str_toint(argv[++i]), 1, (int)MAX_CHARACTERS); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			Ticks = clamp(str_toint(argv[++i]), 1, (int)MAX_TICKS); // ignore_convention
+		else
+			pMapName = argv[i]; // ignore_convention
+	}
+
+	s_Map.Init(argc, argv); // ignore_convention
+	if(!s_Map.Load("move_bench", pMapName))
+		return -1;
+
+	s_pInputs = (CNetObj_PlayerInput *)mem_alloc(sizeof(CNetObj_PlayerInput)*MAX_CHARACTERS*Ticks, 1);
+	RecordInputs(Ticks);
+
+	dbg_msg("move_bench", "%s, %d ticks, %d characters", pMapName, Ticks, s_NumCharacters);
+
+	// both worlds side by side, compared after every tick
+	int FirstMismatch = -1;
+	s_aWorlds[0].Reset();
+	s_aWorlds[1].Reset();
+	for(int t = 0; t < Ticks && FirstMismatch == -1; t++)
+	{
+		s_aWorlds[0].Tick(t, true);
+		s_aWorlds[1].Tick(t, false);
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			CCharacterCore *pOld = &s_aWorlds[0].m_aCharacters[i];
+			CCharacterCore *pNew = &s_aWorlds[1].m_aCharacters[i];
+			if(mem_comp(&pOld->m_Pos, &pNew->m_Pos, sizeof(vec2)) != 0 || mem_comp(&pOld->m_Vel, &pNew->m_Vel, sizeof(vec2)) != 0 ||
+				pOld->m_HookState != pNew->m_HookState || pOld->m_HookedPlayer != pNew->m_HookedPlayer)
+			{
+				dbg_msg("move_bench", "tick %d, character %d differs: old %f %f new %f %f", t, i, pOld->m_Pos.x, pOld->m_Pos.y, pNew->m_Pos.x, pNew->m_Pos.y);
+				FirstMismatch = t;
+				break;
+			}
+		}
+	}
+	if(FirstMismatch == -1)
+		dbg_msg("move_bench", "verified %d ticks, the worlds are identical", Ticks);
+
+	int64 aTimes[2];
+	unsigned aChecksums[2];
+	for(int w = 0; w < 2; w++)
+	{
+		s_aWorlds[w].Reset();
+		int64 Start = time_get();
+		for(int t = 0; t < Ticks; t++)
+			s_aWorlds[w].Tick(t, w == 0);
+		aTimes[w] = time_get()-Start;
+		aChecksums[w] = s_aWorlds[w].Checksum();
+	}
+
+	BenchReport("move_bench", "sampled", aTimes[0], Ticks, aChecksums[0]);
+	BenchReport("move_bench", "swept", aTimes[1], Ticks, aChecksums[1]);
+
+	mem_free(s_pInputs);
+	return FirstMismatch != -1 || aChecksums[0] != aChecksums[1] ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <game/mapitems.h>
+#include <game/spawns.h>
+
+#include "bench.h"
+
+// characters walk around the map, die and respawn at the spawn they are
+// given. every tick the spawn is picked for both teams with and without
+// teamplay, by evaluating every spawn point and by the danger bounds, and
+// the picks have to be the same
+
+static CBenchMap s_Map;
+static CSpawns s_Spawns;
+static CSpawns::CCharacterInfo s_aCharacters[MAX_CLIENTS];
+static bool s_aAlive[MAX_CLIENTS];
+static int s_NumCharacters = 16;
+static unsigned s_Seed;
+
+static int LoadSpawns()
+{
+	CMapItemLayerTilemap *pTileMap = s_Map.m_Layers.GameLayer();
+	CTile *pTiles = (CTile *)s_Map.m_pMap->GetData(pTileMap->m_Data);
+	int Num = 0;
+	for(int y = 0; y < pTileMap->m_Height; y++)
+		for(int x = 0; x < pTileMap->m_Width; x++)
+		{
+			int Index = pTiles[y*pTileMap->m_Width+x].m_Index-ENTITY_OFFSET;
+			if(Index >= ENTITY_SPAWN && Index <= ENTITY_SPAWN_BLUE)
+			{
+				s_Spawns.Add(Index-ENTITY_SPAWN, vec2(x*32.0f+16.0f, y*32.0f+16.0f));
+				Num++;
+			}
+		}
+	return Num;
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	const char *pMapName = "maps/ctf5.map";
+	int Ticks = 2000;
+	for(int i = 1; i < argc; i++) // ignore_convention
+	{
+		if(str_comp(argv[i], "-c") == 0 && i+1 < argc) // ignore_convention
+			s_NumCharacters = clamp(str_toint(argv[++i]), 0, (int)MAX_CLIENTS); // ignore_convention
+		else if(str_comp(argv[i], "-t") == 0 && i+1 < argc) // ignore_convention
+			Ticks = max(1, str_toint(argv[++i])); // ignore_convention
+		else
+			pMapName = argv[i]; // ignore_convention
+	}
+
+	s_Map.Init(argc, argv); // ignore_convention
+	if(!s_Map.Load("spawn_bench", pMapName))
+		return -1;
+	s_Spawns.Init(&s_Map.m_Collision);
+	int NumSpawns = LoadSpawns();
+
+	dbg_msg("spawn_bench", "%s, %d spawn points, %d ticks, %d characters", pMapName, NumSpawns, Ticks, s_NumCharacters);
+
+	s_Seed = 1;
+	for(int i = 0; i < s_NumCharacters; i++)
+	{
+		s_aCharacters[i].m_ClientID = i;
+		s_aCharacters[i].m_Team = i&1;
+		s_aCharacters[i].m_Pos = s_Map.RandomFreePos(&s_Seed, vec2(28.0f, 28.0f));
+		s_aAlive[i] = true;
+	}
+
+	int64 aTimes[2] = {0, 0};
+	unsigned aChecksums[2] = {0, 0};
+	int NumPicks = 0;
+	int NumMismatches = 0;
+	for(int Tick = 0; Tick < Ticks; Tick++)
+	{
+		// walk, die and switch teams now and then
+		CSpawns::CCharacterInfo aInWorld[MAX_CLIENTS];
+		int NumInWorld = 0;
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			CSpawns::CCharacterInfo *pChr = &s_aCharacters[i];
+			if(s_aAlive[i])
+			{
+				vec2 Pos = pChr->m_Pos + vec2(random_next_float(&s_Seed)*40-20, random_next_float(&s_Seed)*40-20);
+				if(!s_Map.m_Collision.TestBox(Pos, vec2(28.0f, 28.0f)))
+					pChr->m_Pos = Pos;
+				if(random_next(&s_Seed)%100 == 0)
+					s_aAlive[i] = false;
+			}
+			if(random_next(&s_Seed)%500 == 0)
+				pChr->m_Team ^= 1;
+			if(s_aAlive[i])
+				aInWorld[NumInWorld++] = *pChr;
+		}
+		s_Spawns.SetCharacters(aInWorld, NumInWorld);
+
+		for(int Teamplay = 0; Teamplay < 2; Teamplay++)
+			for(int Team = 0; Team < 2; Team++)
+			{
+				vec2 aPos[2];
+				bool aGot[2];
+				for(int Exact = 0; Exact < 2; Exact++)
+				{
+					int64 Start = time_get();
+					aGot[Exact] = s_Spawns.Evaluate(Team, Teamplay, Exact, &aPos[Exact]);
+					aTimes[Exact] += time_get()-Start;
+					aChecksums[Exact] = aChecksums[Exact]*31 + aGot[Exact] + (unsigned)round_to_int(aPos[Exact].x)*13 + (unsigned)round_to_int(aPos[Exact].y)*7;
+				}
+				NumPicks++;
+
+				if(aGot[0] != aGot[1] || mem_comp(&aPos[0], &aPos[1], sizeof(vec2)) != 0)
+				{
+					if(NumMismatches++ < 10)
+						dbg_msg("spawn_bench", "tick %d, team %d, teamplay %d: picked %.0f %.0f, exact %.0f %.0f",
+							Tick, Team, Teamplay, aPos[0].x, aPos[0].y, aPos[1].x, aPos[1].y);
+				}
+			}
+
+		// the dead come back where they are told to
+		for(int i = 0; i < s_NumCharacters; i++)
+		{
+			if(s_aAlive[i] || random_next(&s_Seed)%10)
+				continue;
+			vec2 Pos;
+			if(s_Spawns.Evaluate(s_aCharacters[i].m_Team, (Tick/100)&1, false, &Pos))
+			{
+				s_aCharacters[i].m_Pos = Pos;
+				s_aAlive[i] = true;
+			}
+		}
+	}
+
+	dbg_msg("spawn_bench", "compared %d picks, %d differ", NumPicks, NumMismatches);
+	dbg_msg("spawn_bench", "every spawn point: %.3f us per pick, checksum %08x", aTimes[1]*1000000.0/time_freq()/NumPicks, aChecksums[1]);
+	dbg_msg("spawn_bench", "danger bounds: %.3f us per pick, checksum %08x", aTimes[0]*1000000.0/time_freq()/NumPicks, aChecksums[0]);
+	return NumMismatches || aChecksums[0] != aChecksums[1] ? 1 : 0;
+}